@@ -0,0 +1,396 @@
+/* Микробенчмарк поиска корней полиномов (Polynomial::roots()).
+ *
+ * Для каждого набора коэффициентов выводятся: степень, время одного решения (нс),
+ * число выделений памяти на одно решение, число найденных корней и ожидаемое число различных вещественных корней.
+ * Время и выделения памяти учитывают и создание полинома, как это происходит в Worker::getPhases().
+ *
+ * Режим калибровки (--calibrate): для каждой степени все методы поиска корней (см. RootSolver)
+ * сравниваются по скорости на уравнениях, возникающих в Worker::getPhases() для сетки значений Альфа1 и Бета1,
+ * и на модельных полиномах. Метод считается пригодным, если он ошибается (пропускает корни, находит лишние
+ * или находит их с погрешностью больше 1e-4) не чаще метода, выбранного по умолчанию.
+ * Выводится самый быстрый пригодный метод для каждой степени.
+ *
+ * Запуск: rootsbenchmark [--calibrate] [минимальное время замера одного набора в мс, по умолчанию 200]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+#include "polynomial.h"
+#include "rootsolvers.h"
+
+
+/* П О Д С Ч Ё Т   В Ы Д Е Л Е Н И Й   П А М Я Т И */
+
+static std::atomic<unsigned long long> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+
+/* Н А Б О Р Ы   К О Э Ф Ф И Ц И Е Н Т О В */
+
+struct Case
+{
+    std::string name;
+    std::vector<double> coeffs;     // Коэффициенты по возрастанию степени
+    int expected;                   // Ожидаемое число различных вещественных корней (-1, если неизвестно)
+    std::vector<double> roots;      // Точные корни (если известны)
+};
+
+// Число различных значений в векторе
+static int distinct(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    return std::unique(values.begin(), values.end()) - values.begin();
+}
+
+// Полином с заданными корнями (коэффициент при старшей степени равен 1)
+static std::vector<double> fromRoots(const std::vector<double> &roots)
+{
+    std::vector<double> c {1.0};
+    for (double r : roots)
+    {
+        std::vector<double> next(c.size() + 1, 0.0);
+        for (std::size_t i = 0; i < c.size(); ++i)
+        {
+            next[i + 1] += c[i];
+            next[i] -= r * c[i];
+        }
+        c = next;
+    }
+    return c;
+}
+
+static Polynomial make(const std::vector<double> &c)
+{
+    Polynomial p(c.size() - 1);
+    for (std::size_t i = 0; i < c.size(); ++i)
+        p[i] = c[i];
+    return p;
+}
+
+// Коэффициенты модельного потенциала (порядок как в Coefficients::c: a[0..3], b[0..1], d[0..2])
+struct Potential
+{
+    double a[4], b[2], d[3];
+};
+
+// Уравнения состояния, решаемые в Worker::getPhases()
+static void addPhaseEquations(std::vector<Case> &cases, const std::string &name, const Potential &k)
+{
+    // Фазы 2 и 3
+    cases.push_back({name + " phases 2/3",
+                     {2 * k.a[0], 3 * k.b[0], 4 * k.a[1], 5 * k.d[0], 6 * (k.a[2] + k.b[1]), 7 * k.d[1], 8 * (k.a[3] + k.d[2])}, -1, {}});
+    // Фаза 4
+    Polynomial B({k.d[0], 2 * k.d[1]});
+    Polynomial C({k.a[0], 2 * k.a[1], 3 * k.a[2], 4 * k.a[3]});
+    Polynomial F({k.b[0], k.d[0], k.d[1]});
+    Polynomial equation;
+    if (k.d[2] == 0.0)
+    {
+        if (k.b[1] == 0.0)
+            equation = F;
+        else
+            equation = B * F - C * Polynomial({2 * k.b[1]});
+    }
+    else
+    {
+        Polynomial A({k.d[2]});
+        Polynomial D = B * B - 4 * A * C;
+        Polynomial E({2 * k.b[1], 2 * k.d[2]});
+        Polynomial G = B * E - 2 * A * F;
+        equation = E * E * D - G * G;
+    }
+    std::vector<double> c;
+    for (std::size_t i = 0; i <= equation.degree(); ++i)
+        c.push_back(equation[i]);
+    cases.push_back({name + " phase 4", c, -1, {}});
+}
+
+static std::vector<Case> createCases()
+{
+    std::vector<Case> cases;
+    for (std::size_t n = 1; n <= 8; ++n)
+    {
+        std::vector<double> separated, clustered, multiple;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            separated.push_back(2.0 * i - n + 1.0);
+            clustered.push_back(1.0 + 1e-3 * i);
+            // Двукратные корни: 1, 1, -2, -2, ...
+            multiple.push_back((i / 2) % 2 ? -2.0 : 1.0);
+        }
+        std::string degree = std::to_string(n);
+        cases.push_back({"separated deg " + degree, fromRoots(separated), distinct(separated), separated});
+        if (n > 1)
+        {
+            cases.push_back({"clustered deg " + degree, fromRoots(clustered), distinct(clustered), clustered});
+            cases.push_back({"multiple deg " + degree, fromRoots(multiple), distinct(multiple), multiple});
+        }
+    }
+    // Случай без вещественных корней: (x^2 + 1)^3
+    cases.push_back({"no real roots deg 6", {1, 0, 3, 0, 3, 0, 1}, 0, {}});
+
+    // Реальные наборы коэффициентов (точки диаграмм с различными ветвями getPhases())
+    addPhaseEquations(cases, "default a1=-5 b1=3",      {{-5, 1, 1, 0}, {3, 1}, {1, 0, 0}});
+    addPhaseEquations(cases, "d3!=0 a1=-2 b1=-1",       {{-2, -1, 1, 0.2}, {-1, 0.5}, {1, -0.3, 0.4}});
+    addPhaseEquations(cases, "d3!=0 a1=0.5 b1=4",       {{0.5, -2, 1, 0.5}, {4, 0.3}, {0.5, 0.2, 0.1}});
+    addPhaseEquations(cases, "d3=0 b2=0 a1=-1 b1=2",    {{-1, -1, 1, 0}, {2, 0}, {1, 0.5, 0}});
+    // Вспомогательное кубическое уравнение для параметра порядка фазы 4: 4x^3 - 3*I1*x - I2 = 0
+    cases.push_back({"phase 4 order parameter", {-0.7, -3 * 1.3, 0.0, 4.0}, 3, {}});
+    return cases;
+}
+
+
+/* К А Л И Б Р О В К А */
+
+
+const RootSolver allSolvers[] {RootSolver::Analytic, RootSolver::Sturm, RootSolver::Descartes,
+                               RootSolver::Aberth, RootSolver::Companion};
+
+/* Эталонные корни: поиск перемен знака на мелкой сетке и деление пополам в long double.
+ * Кратные корни чётной кратности так не обнаруживаются, поэтому для модельных полиномов
+ * используются точные корни.
+ */
+static std::vector<double> referenceRoots(const Case &item)
+{
+    std::vector<double> res;
+    if (!item.roots.empty() || item.expected == 0)
+    {
+        res = item.roots;
+        std::sort(res.begin(), res.end());
+        res.erase(std::unique(res.begin(), res.end()), res.end());
+        return res;
+    }
+    const std::vector<double> &c = item.coeffs;
+    auto value = [&c](long double x) {
+        long double res = c.back();
+        for (std::size_t i = c.size() - 1; i--; )
+            res = res * x + c[i];
+        return res;
+    };
+    std::size_t n = c.size() - 1;
+    long double bound = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        bound = std::max(bound, std::pow(std::abs(static_cast<long double>(c[i]) / c[n]), 1.0L / (n - i)));
+    bound = 2 * bound + 1;
+    const unsigned steps = 20000;
+    long double l = -bound, fl = value(l);
+    for (unsigned i = 1; i <= steps; ++i)
+    {
+        long double r = -bound + 2 * bound * i / steps, fr = value(r);
+        if (fl == 0)
+            res.push_back(l);
+        else if ((fl < 0) != (fr < 0) && fr != 0)
+        {
+            long double a = l, b = r, fa = fl;
+            for (int k = 0; k < 80; ++k)
+            {
+                long double m = (a + b) / 2, fm = value(m);
+                if ((fm < 0) == (fa < 0))
+                {
+                    a = m;
+                    fa = fm;
+                }
+                else
+                    b = m;
+            }
+            res.push_back((a + b) / 2);
+        }
+        l = r;
+        fl = fr;
+    }
+    return res;
+}
+
+// Проверяет, совпадают ли найденные корни с эталонными
+static bool isAccurate(std::vector<double> roots, const std::vector<double> &reference)
+{
+    std::sort(roots.begin(), roots.end());
+    if (roots.size() != reference.size())
+        return false;
+    for (std::size_t i = 0; i < roots.size(); ++i)
+        if (std::abs(roots[i] - reference[i]) > 1e-4 * std::max(1.0, std::abs(reference[i])))
+            return false;
+    return true;
+}
+
+// Уравнения getPhases() на сетке значений Альфа1 и Бета1 для нескольких наборов коэффициентов
+static std::vector<Case> createCalibrationCases()
+{
+    const Potential potentials[] {
+        {{0, 1, 1, 0}, {0, 1}, {1, 0, 0}},
+        {{0, -1, 1, 0.2}, {0, 0.5}, {1, -0.3, 0.4}},
+        {{0, -2, 1, 0.5}, {0, 0.3}, {0.5, 0.2, 0.1}},
+        {{0, -1, 1, 0}, {0, 0}, {1, 0.5, 0}},
+        {{0, -3, 0.5, 0.3}, {0, 2}, {0.5, 0.5, 0.05}},
+    };
+    std::vector<Case> cases = createCases();
+    for (const Potential &item : potentials)
+        for (int i = 0; i < 12; ++i)
+            for (int j = 0; j < 12; ++j)
+            {
+                Potential k = item;
+                k.a[0] = -10 + 20.0 * i / 11;
+                k.b[0] = -10 + 20.0 * j / 11;
+                addPhaseEquations(cases, "", k);
+            }
+    return cases;
+}
+
+static int calibrate(double minTime)
+{
+    // Уравнения, сгруппированные по степени (после отбрасывания нулевых старших коэффициентов)
+    std::map<std::size_t, std::vector<Case>> groups;
+    for (Case &item : createCalibrationCases())
+    {
+        // Так же, как в Polynomial::roots(), отбрасываются пренебрежимо малые старшие коэффициенты
+        while (item.coeffs.size() > 1 && std::abs(item.coeffs.back()) < 1e-10)
+            item.coeffs.pop_back();
+        std::size_t degree = item.coeffs.size() - 1;
+        if (degree)
+            groups[degree].push_back(item);
+    }
+
+    std::string table;
+    std::printf("%6s %7s %-10s %12s %10s\n", "degree", "samples", "solver", "ns/solve", "failures");
+    for (const auto &group : groups)
+    {
+        std::size_t degree = group.first;
+        const std::vector<Case> &cases = group.second;
+        std::vector<std::vector<double>> reference;
+        for (const Case &item : cases)
+            reference.push_back(referenceRoots(item));
+
+        RootSolver defaultSolver = Polynomial::solver(degree);
+        std::map<RootSolver, unsigned> failures;
+        std::map<RootSolver, double> time;
+        for (RootSolver solver : allSolvers)
+        {
+            if (solver == RootSolver::Analytic && degree > 4)
+                continue;
+            unsigned failed = 0;
+            for (std::size_t i = 0; i < cases.size(); ++i)
+                if (!isAccurate(make(cases[i].coeffs).roots(solver), reference[i]))
+                    ++failed;
+            volatile std::size_t sink = 0;
+            unsigned long long iterations = 1;
+            double elapsed;
+            for (;;)
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (unsigned long long k = 0; k < iterations; ++k)
+                    for (const Case &item : cases)
+                    {
+                        Polynomial p = make(item.coeffs);
+                        sink = sink + p.roots(solver).size();
+                    }
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                if (elapsed >= minTime)
+                    break;
+                iterations *= 2;
+            }
+            failures[solver] = failed;
+            time[solver] = 1e9 * elapsed / iterations / cases.size();
+            std::printf("%6zu %7zu %-10s %12.1f %10u\n", degree, cases.size(), rootSolverName(solver), time[solver], failed);
+        }
+
+        // Самый быстрый метод, ошибающийся не чаще метода по умолчанию
+        RootSolver best = defaultSolver;
+        for (const auto &item : time)
+            if (failures[item.first] <= failures[defaultSolver] && item.second < time[best])
+                best = item.first;
+        std::printf("%6zu  selected: %s (default: %s)\n", degree, rootSolverName(best), rootSolverName(defaultSolver));
+        table += " " + std::to_string(degree) + "=" + rootSolverName(best);
+    }
+    std::printf("\nsolvers:%s\n", table.c_str());
+    return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    bool calibration = argc > 1 && !std::strcmp(argv[1], "--calibrate");
+    if (calibration)
+    {
+        --argc;
+        ++argv;
+    }
+    const double minTime = (argc > 1 ? std::atof(argv[1]) : 200.0) / 1000.0;
+    if (calibration)
+        return calibrate(minTime);
+    std::vector<Case> cases = createCases();
+
+    std::printf("%-36s %6s %12s %12s %6s %9s\n", "case", "degree", "ns/solve", "allocs/solve", "roots", "expected");
+    for (const Case &item : cases)
+    {
+        // Прогрев и определение числа корней
+        Polynomial probe = make(item.coeffs);
+        std::size_t rootsCount = probe.roots().size();
+        std::size_t degree = probe.degree();
+
+        // Замер: число повторов удваивается, пока время не превысит minTime
+        volatile std::size_t sink = 0;
+        unsigned long long iterations = 16;
+        double elapsed;
+        unsigned long long allocs;
+        for (;;)
+        {
+            allocs = allocations;
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned long long i = 0; i < iterations; ++i)
+            {
+                Polynomial p = make(item.coeffs);
+                sink = sink + p.roots().size();
+            }
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            allocs = allocations - allocs;
+            if (elapsed >= minTime)
+                break;
+            iterations *= 2;
+        }
+        std::string expected = item.expected < 0 ? "-" : std::to_string(item.expected);
+        std::printf("%-36s %6zu %12.1f %12.2f %6zu %9s\n", item.name.c_str(), degree, 1e9 * elapsed / iterations,
+                    static_cast<double>(allocs) / iterations, rootsCount, expected.c_str());
+    }
+    return 0;
+}
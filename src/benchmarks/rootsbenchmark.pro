@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Микробенчмарк поиска корней Polynomial::roots()
+#
+#-------------------------------------------------
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle qt
+
+TARGET = rootsbenchmark
+
+INCLUDEPATH += ..
+
+SOURCES += rootsbenchmark.cpp \
+    ../polynomial.cpp \
+    ../solvercontext.cpp \
+    ../rootsolvers.cpp
+
+HEADERS += ../polynomial.h \
+    ../solvercontext.h \
+    ../rootsolvers.h
@@ -0,0 +1,418 @@
+/* Сквозной бенчмарк расчёта диаграммы без графического интерфейса.
+ *
+ * Для фиксированного каталога наборов коэффициентов (все ветви Worker::getPhases(), разное число фаз,
+ * несколько размеров сетки) выполняется Worker::calculate() и измеряются время, скорость (точек/с),
+ * пиковый объём памяти и число точек, повторно рассчитанных с повышенной точностью.
+ * Каждый случай выполняется в отдельном процессе (копии бенчмарка), поэтому пиковый объём памяти
+ * процесса относится к одному случаю, а не к максимуму по всем предыдущим.
+ * Полученная диаграмма сверяется с эталоном (golden.txt):
+ * для каждого случая хранится контрольная сумма карты фаз (тип наиболее устойчивой фазы,
+ * набор устойчивых фаз, изосимметрийные модификации, линии переходов) и число точек каждого класса.
+ *
+ * Параметры:
+ *   --baseline FILE        сравнить скорость с сохранённой базовой линией (JSON)
+ *   --write-baseline FILE  записать результаты как базовую линию
+ *   --threshold PERCENT    допустимое замедление относительно базовой линии (по умолчанию 10)
+ *   --golden FILE          файл эталонов (по умолчанию golden.txt в каталоге бенчмарка)
+ *   --write-golden         перезаписать эталоны текущими результатами
+ *   --filter TEXT          выполнять только случаи, в названии которых есть TEXT
+ *   --processes N          распределённый расчёт в N вычислительных процессах (см. TileFarm)
+ *   --crash-after N        вычислительные процессы аварийно завершаются после N заданий
+ *                          (проверка повторной выдачи заданий; результаты должны совпасть с эталоном)
+ *   --single-case NAME     (внутренний режим) выполнить один случай и вывести результат для основного процесса
+ *
+ * Код возврата: 0 - успех, 1 - расхождение с эталоном, 2 - регрессия производительности.
+ */
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QPoint>
+#include <QSize>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "worker.h"
+#include "tilefarm.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifndef BENCHMARK_DIR
+#define BENCHMARK_DIR "."
+#endif
+
+
+// Случай: набор коэффициентов, диапазоны Альфа1 и Бета1 и размер сетки
+struct Case
+{
+    std::string name;
+    double c[9];            // Порядок как в Coefficients::c (значения Альфа1 и Бета1 не используются)
+    double alpha[2];        // Диапазон Альфа1
+    double beta[2];         // Диапазон Бета1
+    int size;               // Размер квадратной сетки
+};
+
+// Результат выполнения случая
+struct Result
+{
+    double wallTime;
+    double pointsPerSecond;
+    double solverCallsPerSecond;
+    unsigned long long refinedPoints;
+    long peakMemoryKb;
+    std::string golden;     // Контрольная сумма и распределение точек по классам
+};
+
+
+static std::vector<Case> createCases()
+{
+    struct Set
+    {
+        std::string name;
+        double c[9];
+        double range;
+    };
+    const Set sets[] {
+        // d[2] != 0: уравнение для фазы 4 степени 5
+        {"d3", {0, -1, 1, 0.2, 0, 0.5, 1, -0.3, 0.4}, 10},
+        // d[2] = 0, b[1] != 0 (значения по умолчанию в главном окне)
+        {"b2", {0, 1, 1, 0, 0, 1, 1, 0, 0}, 10},
+        // d[2] = 0, b[1] = 0
+        {"plain", {0, -1, 1, 0, 0, 0, 1, 0.5, 0}, 10},
+        // Много сосуществующих фаз, в т.ч. изосимметрийных
+        {"many-phases", {0, -2, 1, 0.5, 0, 0.3, 0.5, 0.2, 0}, 5},
+        // Фазы 2/3 описываются уравнением 6-й степени, фаза 4 отсутствует почти везде
+        {"deg6", {0, -3, 0.5, 0.3, 0, 2, 0.5, 0.5, 0.05}, 8},
+    };
+    std::vector<Case> cases;
+    for (const Set &set : sets)
+        for (int size : {100, 250})
+        {
+            Case item;
+            item.name = set.name + "-" + std::to_string(size);
+            std::copy(std::begin(set.c), std::end(set.c), std::begin(item.c));
+            item.alpha[0] = item.beta[0] = -set.range;
+            item.alpha[1] = item.beta[1] = set.range;
+            item.size = size;
+            cases.push_back(item);
+        }
+    // Размер диаграммы в главном окне
+    Case item = cases[2];
+    item.name = "b2-500";
+    item.size = 500;
+    cases.push_back(item);
+    /* Граница устойчивости фазы 4 проходит через узлы сетки (точка 105, 129 - вырожденный минимум):
+     * проверяется повторный расчёт плохо обусловленных точек
+     */
+    item.name = "boundary-200";
+    item.c[7] = 0.5;
+    item.size = 200;
+    cases.push_back(item);
+    return cases;
+}
+
+
+static long peakMemoryKb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return static_cast<long>(pmc.PeakWorkingSetSize / 1024);
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#endif
+}
+
+
+// Контрольная сумма карты фаз (FNV-1a) и число точек каждого класса
+static std::string describe(const Worker &worker, int size)
+{
+    unsigned long long hash = 1469598103934665603ull;
+    std::map<unsigned, unsigned> classes;
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+        {
+            QPoint p(i, j);
+            unsigned value = worker.getStablestPhaseType(p);
+            for (unsigned k = 1; k <= 4; ++k)
+                value |= worker.isPhaseStable(p, k) << (2 + k);
+            for (unsigned k = 2; k <= 4; ++k)
+                value |= (worker.getIsosymmetricCount(p, k) > 1) << (5 + k);
+            value |= worker.isTransition(p) << 10;
+            hash = (hash ^ value) * 1099511628211ull;
+            ++classes[value];
+        }
+    std::ostringstream s;
+    s << std::hex << hash << std::dec;
+    for (const auto &item : classes)
+        s << ' ' << item.first << ':' << item.second;
+    return s.str();
+}
+
+
+static Result run(const Case &item, unsigned processes, int crashAfter)
+{
+    Worker worker(QSize(item.size, item.size));
+    worker.setProcessCount(processes);
+    if (crashAfter >= 0)
+        worker.setTileWorkerCommand(QCoreApplication::applicationFilePath(),
+                                    QStringList() << "--tile-worker" << "--crash-after" << QString::number(crashAfter));
+    Coefficients c;
+    std::copy(std::begin(item.c), std::end(item.c), std::begin(c.c));
+    c.a[0] = item.alpha[0];
+    c.b[0] = item.beta[0];
+    worker.setParameters(c, (item.beta[1] - item.beta[0]) / item.size, (item.alpha[1] - item.alpha[0]) / item.size);
+
+    auto start = std::chrono::steady_clock::now();
+    worker.calculate();
+    Result res;
+    res.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    RunMetrics metrics = worker.getMetrics();
+    res.pointsPerSecond = static_cast<double>(item.size) * item.size / res.wallTime;
+    res.solverCallsPerSecond = metrics.solverCalls / res.wallTime;
+    res.refinedPoints = metrics.refinedPoints;
+    res.peakMemoryKb = peakMemoryKb();
+    res.golden = describe(worker, item.size);
+    return res;
+}
+
+
+// Результат случая в виде строки для основного процесса: числовые поля, затем эталонная строка до конца строки
+static void printResult(const Result &res)
+{
+    std::printf("%.17g %.17g %.17g %llu %ld %s\n", res.wallTime, res.pointsPerSecond, res.solverCallsPerSecond,
+                res.refinedPoints, res.peakMemoryKb, res.golden.c_str());
+}
+
+/* Выполняет случай в отдельном процессе (режим --single-case). В случае ошибки процесса
+ * эталонная строка результата содержит описание ошибки, и сверка с эталоном не проходит.
+ */
+static Result runIsolated(const Case &item, unsigned processes, int crashAfter)
+{
+    QProcess process;
+    process.start(QCoreApplication::applicationFilePath(),
+                  QStringList() << "--single-case" << QString::fromStdString(item.name)
+                                << "--processes" << QString::number(processes)
+                                << "--crash-after" << QString::number(crashAfter));
+    Result res {};
+    if (!process.waitForFinished(-1) || process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+    {
+        res.golden = "case process failed";
+        return res;
+    }
+    std::istringstream stream(process.readAllStandardOutput().toStdString());
+    if (!(stream >> res.wallTime >> res.pointsPerSecond >> res.solverCallsPerSecond >> res.refinedPoints >> res.peakMemoryKb))
+    {
+        res.golden = "case process failed";
+        return res;
+    }
+    stream >> std::ws;
+    std::getline(stream, res.golden);
+    return res;
+}
+
+
+/* Ч Т Е Н И Е   И   З А П И С Ь   Ф А Й Л О В */
+
+
+// Эталоны: по строке на случай, "имя контрольная_сумма класс:число ..."
+static std::map<std::string, std::string> readGolden(const std::string &fileName)
+{
+    std::map<std::string, std::string> res;
+    std::ifstream stream(fileName);
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        auto pos = line.find(' ');
+        if (!line.empty() && line[0] != '#' && pos != std::string::npos)
+            res[line.substr(0, pos)] = line.substr(pos + 1);
+    }
+    return res;
+}
+
+static bool writeGolden(const std::string &fileName, const std::vector<Case> &cases, const std::vector<Result> &results)
+{
+    std::ofstream stream(fileName);
+    stream << "# Эталонные результаты workerbenchmark: имя, контрольная сумма карты фаз, класс:число точек\n";
+    for (std::size_t i = 0; i < cases.size(); ++i)
+        stream << cases[i].name << ' ' << results[i].golden << '\n';
+    return static_cast<bool>(stream);
+}
+
+/* Базовая линия: JSON вида {"cases": [{"name": "...", "wallTime": ..., "pointsPerSecond": ..., ...}, ...]}.
+ * Файл записывается этой же программой, поэтому при чтении достаточно найти объект случая по имени
+ * и числовое поле по ключу.
+ */
+static bool readBaselineValue(const std::string &json, const std::string &name, const std::string &key, double &value)
+{
+    auto pos = json.find("\"name\": \"" + name + "\"");
+    if (pos == std::string::npos)
+        return false;
+    auto end = json.find('}', pos);
+    auto field = json.find("\"" + key + "\": ", pos);
+    if (field == std::string::npos || field > end)
+        return false;
+    value = std::atof(json.c_str() + field + key.size() + 4);
+    return true;
+}
+
+static bool writeBaseline(const std::string &fileName, const std::vector<Case> &cases, const std::vector<Result> &results)
+{
+    std::ofstream stream(fileName);
+    stream << "{\n    \"cases\": [\n";
+    for (std::size_t i = 0; i < cases.size(); ++i)
+    {
+        stream << "        {\"name\": \"" << cases[i].name << "\", "
+               << "\"wallTime\": " << results[i].wallTime << ", "
+               << "\"pointsPerSecond\": " << results[i].pointsPerSecond << ", "
+               << "\"solverCallsPerSecond\": " << results[i].solverCallsPerSecond << ", "
+               << "\"refinedPoints\": " << results[i].refinedPoints << ", "
+               << "\"peakMemoryKb\": " << results[i].peakMemoryKb << "}"
+               << (i + 1 < cases.size() ? ",\n" : "\n");
+    }
+    stream << "    ]\n}\n";
+    return static_cast<bool>(stream);
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication application(argc, argv);
+    // Режим вычислительного процесса распределённого расчёта
+    if (application.arguments().contains("--tile-worker"))
+        return TileFarm::serve(application.arguments());
+
+    std::string baseline, newBaseline, filter, singleCase;
+    std::string goldenFile = std::string(BENCHMARK_DIR) + "/golden.txt";
+    double threshold = 10.0;
+    bool updateGolden = false;
+    unsigned processes = 0;
+    int crashAfter = -1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--baseline" && hasValue)
+            baseline = argv[++i];
+        else if (arg == "--write-baseline" && hasValue)
+            newBaseline = argv[++i];
+        else if (arg == "--threshold" && hasValue)
+            threshold = std::atof(argv[++i]);
+        else if (arg == "--golden" && hasValue)
+            goldenFile = argv[++i];
+        else if (arg == "--write-golden")
+            updateGolden = true;
+        else if (arg == "--filter" && hasValue)
+            filter = argv[++i];
+        else if (arg == "--processes" && hasValue)
+            processes = std::atoi(argv[++i]);
+        else if (arg == "--crash-after" && hasValue)
+            crashAfter = std::atoi(argv[++i]);
+        else if (arg == "--single-case" && hasValue)
+            singleCase = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 3;
+        }
+    }
+
+    // Режим отдельного процесса случая
+    if (!singleCase.empty())
+    {
+        for (const Case &item : createCases())
+            if (item.name == singleCase)
+            {
+                printResult(run(item, processes, crashAfter));
+                return 0;
+            }
+        std::fprintf(stderr, "Unknown case: %s\n", singleCase.c_str());
+        return 3;
+    }
+
+    std::vector<Case> cases;
+    for (const Case &item : createCases())
+        if (filter.empty() || item.name.find(filter) != std::string::npos)
+            cases.push_back(item);
+
+    std::map<std::string, std::string> golden = readGolden(goldenFile);
+    std::string baselineJson;
+    if (!baseline.empty())
+    {
+        std::ifstream stream(baseline);
+        std::stringstream s;
+        s << stream.rdbuf();
+        baselineJson = s.str();
+        if (baselineJson.empty())
+            std::fprintf(stderr, "Cannot read baseline %s\n", baseline.c_str());
+    }
+
+    int status = 0;
+    std::vector<Result> results;
+    std::printf("%-16s %10s %12s %14s %8s %10s  %s\n", "case", "time, s", "points/s", "solver calls/s", "refined", "peak, KB", "check");
+    for (const Case &item : cases)
+    {
+        Result res = runIsolated(item, processes, crashAfter);
+        results.push_back(res);
+
+        // Сверка с эталоном
+        std::string check;
+        auto pos = golden.find(item.name);
+        if (updateGolden)
+            check = "golden updated";
+        else if (pos == golden.end())
+            check = "no golden";
+        else if (pos->second == res.golden)
+            check = "ok";
+        else
+        {
+            check = "MISMATCH";
+            status = 1;
+        }
+
+        // Сравнение с базовой линией
+        double base;
+        if (!baselineJson.empty() && readBaselineValue(baselineJson, item.name, "pointsPerSecond", base) && base > 0)
+        {
+            double change = 100.0 * (res.pointsPerSecond / base - 1.0);
+            char buf[64];
+            std::snprintf(buf, sizeof(buf), ", %+.1f%% vs baseline", change);
+            check += buf;
+            if (change < -threshold)
+            {
+                check += " REGRESSION";
+                if (!status)
+                    status = 2;
+            }
+        }
+
+        std::printf("%-16s %10.3f %12.0f %14.0f %8llu %10ld  %s\n", item.name.c_str(), res.wallTime, res.pointsPerSecond,
+                    res.solverCallsPerSecond, res.refinedPoints, res.peakMemoryKb, check.c_str());
+        if (check.find("MISMATCH") != std::string::npos && pos != golden.end())
+            std::printf("    expected: %s\n    actual:   %s\n", pos->second.c_str(), res.golden.c_str());
+    }
+
+    if (updateGolden && (!filter.empty() || !writeGolden(goldenFile, cases, results)))
+    {
+        std::fprintf(stderr, "Golden file is written only for the full catalogue\n");
+        return 3;
+    }
+    if (!newBaseline.empty() && !writeBaseline(newBaseline, cases, results))
+    {
+        std::fprintf(stderr, "Cannot write baseline %s\n", newBaseline.c_str());
+        return 3;
+    }
+    return status;
+}
@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Сквозной бенчмарк расчёта диаграммы (Worker::calculate)
+# с контролем регрессий производительности и эталонными результатами
+#
+#-------------------------------------------------
+
+QT = core
+
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+TARGET = workerbenchmark
+
+# Каталог с эталонными результатами (golden.txt)
+DEFINES += BENCHMARK_DIR=\\\"$$PWD\\\"
+
+SOURCES += workerbenchmark.cpp \
+    ../worker.cpp \
+    ../tilefarm.cpp
+
+HEADERS += ../worker.h \
+    ../tilefarm.h
+
+include(../phasecore.pri)
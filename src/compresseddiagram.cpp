@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include "compresseddiagram.h"
+
+using std::size_t;
+using std::uint32_t;
+
+
+/* Д В О И Ч Н Ы Й   Ф О Р М А Т
+ * Все числа записываются в порядке байтов платформы:
+ * width, height (uint32); startX, startY, dX, dY (double);
+ * размер пула (uint32) и фазы пула (type - uint32, phi, n[0], n[1] - double);
+ * для каждого столбца: число серий (uint32) и серии (start, length, phases, count - uint32, stablest - int32),
+ * число точных записей (uint32) и записи (row - uint32, точка),
+ * число точек переходов (uint32) и их номера (uint32).
+ * Точка: x, y (double), transition (uint8), stablest (int32), число фаз (uint32) и фазы.
+ */
+
+namespace
+{
+
+template <typename T>
+void put(std::ostream &stream, const T &value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool get(std::istream &stream, T &value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void putPhase(std::ostream &stream, const PhaseInfo &phase)
+{
+    put<uint32_t>(stream, phase.type);
+    put(stream, phase.phi);
+    put(stream, phase.n[0]);
+    put(stream, phase.n[1]);
+}
+
+// Размеры записей в файле (для проверки числа записей по размеру остатка файла)
+const std::uint64_t phaseSize = 4 + 3 * 8, runSize = 5 * 4, pointSize = 2 * 8 + 1 + 4 + 4;
+
+// Тип фазы должен быть от 1 до 4 (по нему выбираются цвета и биты наборов фаз)
+bool getPhase(std::istream &stream, PhaseInfo &phase)
+{
+    uint32_t type;
+    bool ok = get(stream, type) && get(stream, phase.phi) && get(stream, phase.n[0]) && get(stream, phase.n[1]);
+    phase.type = type;
+    return ok && type >= 1 && type <= 4;
+}
+
+void putPoint(std::ostream &stream, const DiagramPoint &point)
+{
+    put(stream, point.x);
+    put(stream, point.y);
+    put<std::uint8_t>(stream, point.transition);
+    put<std::int32_t>(stream, point.stablest);
+    put<uint32_t>(stream, point.phases.size());
+    for (const PhaseInfo &phase : point.phases)
+        putPhase(stream, phase);
+}
+
+// Читает точку; limit - размер остатка файла (ограничивает число фаз до выделения памяти)
+bool getPoint(std::istream &stream, DiagramPoint &point, std::uint64_t limit)
+{
+    std::uint8_t transition;
+    std::int32_t stablest;
+    uint32_t count;
+    if (!(get(stream, point.x) && get(stream, point.y) && get(stream, transition) && get(stream, stablest) && get(stream, count)))
+        return false;
+    if (count > limit / phaseSize || stablest < -1 || stablest >= static_cast<std::int64_t>(count))
+        return false;
+    point.transition = transition;
+    point.stablest = stablest;
+    point.phases.resize(count);
+    for (PhaseInfo &phase : point.phases)
+        if (!getPhase(stream, phase))
+            return false;
+    return true;
+}
+
+// Число байтов от текущей позиции до конца потока (если поток не поддерживает позиционирование - без ограничения)
+std::uint64_t remaining(std::istream &stream)
+{
+    std::istream::pos_type position = stream.tellg();
+    if (position == std::istream::pos_type(-1))
+        return UINT64_MAX;
+    stream.seekg(0, std::ios::end);
+    std::istream::pos_type end = stream.tellg();
+    stream.seekg(position);
+    return end == std::istream::pos_type(-1) || end < position ? UINT64_MAX : static_cast<std::uint64_t>(end - position);
+}
+
+}
+
+
+bool CompressedDiagram::PhaseClass::operator==(const PhaseClass &other) const
+{
+    return stablest == other.stablest && types == other.types;
+}
+
+
+CompressedDiagram::CompressedDiagram()
+    : width(0), height(0), startX(0.0), startY(0.0), dX(0.0), dY(0.0), cursorColumn(0), cursorRun(0), scratch()
+{
+
+}
+
+
+CompressedDiagram::PhaseClass CompressedDiagram::getClass(const DiagramPoint &point)
+{
+    PhaseClass c;
+    c.stablest = point.stablest;
+    for (const PhaseInfo &phase : point.phases)
+        c.types.push_back(phase.type);
+    return c;
+}
+
+
+void CompressedDiagram::reset(size_t w, size_t h, double x0, double y0, double stepX, double stepY)
+{
+    width = w;
+    height = h;
+    startX = x0;
+    startY = y0;
+    dX = stepX;
+    dY = stepY;
+    pool.clear();
+    columns.clear();
+    exact.clear();
+    transitions.clear();
+    columns.reserve(width);
+    exact.reserve(width);
+    transitions.reserve(width);
+    cursorColumn = cursorRun = 0;
+}
+
+
+void CompressedDiagram::appendColumn(const std::vector<DiagramPoint> &column)
+{
+    columns.emplace_back();
+    exact.emplace_back();
+    transitions.emplace_back();
+    std::vector<Run> &runs = columns.back();
+
+    // Разбиение столбца на серии
+    PhaseClass current;
+    for (size_t j = 0; j < column.size(); ++j)
+    {
+        const DiagramPoint &point = column[j];
+        PhaseClass c = getClass(point);
+        if (runs.empty() || !(c == current))
+        {
+            Run run;
+            run.start = j;
+            run.length = 0;
+            run.phases = pool.size();
+            run.count = point.phases.size();
+            run.stablest = point.stablest;
+            pool.insert(pool.end(), point.phases.cbegin(), point.phases.cend());
+            runs.push_back(run);
+            current = c;
+        }
+        ++runs.back().length;
+        if (point.transition)
+            transitions.back().push_back(j);
+    }
+
+    // Точные записи для первых и последних точек серий
+    for (const Run &run : runs)
+    {
+        exact.back().push_back({run.start, column[run.start]});
+        if (run.length > 1)
+            exact.back().push_back({run.start + run.length - 1, column[run.start + run.length - 1]});
+    }
+}
+
+
+void CompressedDiagram::setTransitions(size_t x, std::vector<uint32_t> rows)
+{
+    transitions[x].swap(rows);
+    // Точные записи хранят точки целиком, признак перехода в них обновляется отдельно
+    for (ExactPoint &item : exact[x])
+        item.point.transition = std::binary_search(transitions[x].cbegin(), transitions[x].cend(), item.row);
+}
+
+
+size_t CompressedDiagram::columnsCount() const
+{
+    return columns.size();
+}
+
+
+size_t CompressedDiagram::rowsCount() const
+{
+    return height;
+}
+
+
+size_t CompressedDiagram::findRun(size_t x, size_t y) const
+{
+    const std::vector<Run> &runs = columns[x];
+    // При последовательном обходе нужная серия - текущая или следующая
+    if (cursorColumn == x && cursorRun < runs.size())
+    {
+        for (size_t k = cursorRun; k < runs.size() && k <= cursorRun + 1; ++k)
+            if (y >= runs[k].start && y < runs[k].start + runs[k].length)
+                return cursorRun = k;
+    }
+    // Иначе двоичный поиск
+    auto pos = std::upper_bound(runs.cbegin(), runs.cend(), y, [](size_t row, const Run &run) {return row < run.start;});
+    cursorColumn = x;
+    cursorRun = pos - runs.cbegin() - 1;
+    return cursorRun;
+}
+
+
+const DiagramPoint &CompressedDiagram::at(size_t x, size_t y) const
+{
+    // Точная запись
+    const std::vector<ExactPoint> &vec = exact[x];
+    auto pos = std::lower_bound(vec.cbegin(), vec.cend(), y, [](const ExactPoint &item, size_t row) {return item.row < row;});
+    if (pos != vec.cend() && pos->row == y)
+        return pos->point;
+
+    // Восстановление точки по серии
+    const Run &run = columns[x][findRun(x, y)];
+    scratch.x = startX + x * dX;
+    scratch.y = startY + (height - 1 - y) * dY;
+    scratch.stablest = run.stablest;
+    scratch.transition = std::binary_search(transitions[x].cbegin(), transitions[x].cend(), static_cast<uint32_t>(y));
+    scratch.phases.assign(pool.cbegin() + run.phases, pool.cbegin() + run.phases + run.count);
+    return scratch;
+}
+
+
+void CompressedDiagram::column(size_t x, std::vector<DiagramPoint> &result) const
+{
+    result.resize(height);
+    auto exactPos = exact[x].cbegin();
+    auto transitionPos = transitions[x].cbegin();
+    for (const Run &run : columns[x])
+        for (size_t y = run.start; y < run.start + run.length; ++y)
+        {
+            DiagramPoint &point = result[y];
+            if (exactPos != exact[x].cend() && exactPos->row == y)
+            {
+                point = (exactPos++)->point;
+                continue;
+            }
+            point.x = startX + x * dX;
+            point.y = startY + (height - 1 - y) * dY;
+            point.stablest = run.stablest;
+            while (transitionPos != transitions[x].cend() && *transitionPos < y)
+                ++transitionPos;
+            point.transition = transitionPos != transitions[x].cend() && *transitionPos == y;
+            point.phases.assign(pool.cbegin() + run.phases, pool.cbegin() + run.phases + run.count);
+        }
+}
+
+
+size_t CompressedDiagram::memoryUsage() const
+{
+    size_t res = pool.size() * sizeof(PhaseInfo);
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        res += columns[i].size() * sizeof(Run) + transitions[i].size() * sizeof(uint32_t);
+        for (const ExactPoint &item : exact[i])
+            res += sizeof(ExactPoint) + item.point.phases.size() * sizeof(PhaseInfo);
+    }
+    return res;
+}
+
+
+bool CompressedDiagram::write(std::ostream &stream) const
+{
+    put<uint32_t>(stream, width);
+    put<uint32_t>(stream, height);
+    put(stream, startX);
+    put(stream, startY);
+    put(stream, dX);
+    put(stream, dY);
+    put<uint32_t>(stream, pool.size());
+    for (const PhaseInfo &phase : pool)
+        putPhase(stream, phase);
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        put<uint32_t>(stream, columns[i].size());
+        for (const Run &run : columns[i])
+        {
+            put(stream, run.start);
+            put(stream, run.length);
+            put(stream, run.phases);
+            put(stream, run.count);
+            put<std::int32_t>(stream, run.stablest);
+        }
+        put<uint32_t>(stream, exact[i].size());
+        for (const ExactPoint &item : exact[i])
+        {
+            put(stream, item.row);
+            putPoint(stream, item.point);
+        }
+        put<uint32_t>(stream, transitions[i].size());
+        for (uint32_t row : transitions[i])
+            put(stream, row);
+    }
+    return static_cast<bool>(stream);
+}
+
+
+/* Чтение с проверкой всех индексов и количеств: повреждённый файл не должен приводить к выходу за границы
+ * массивов или попыткам выделить память по случайным числам. Количества записей ограничиваются высотой
+ * столбца и размером остатка файла до выделения памяти; серии столбца должны идти подряд и покрывать
+ * ровно height точек, номера точных записей и точек переходов - возрастать и быть меньше height.
+ */
+bool CompressedDiagram::read(std::istream &stream)
+{
+    uint32_t w, h, count;
+    double x0, y0, stepX, stepY;
+    if (!(get(stream, w) && get(stream, h) && get(stream, x0) && get(stream, y0) && get(stream, stepX) && get(stream, stepY)))
+        return false;
+    const std::uint64_t limit = remaining(stream);
+    // Каждый столбец занимает не менее трёх счётчиков
+    if (w > limit / 12)
+        return false;
+    reset(w, h, x0, y0, stepX, stepY);
+    if (!get(stream, count) || count > limit / phaseSize)
+        return false;
+    pool.resize(count);
+    for (PhaseInfo &phase : pool)
+        if (!getPhase(stream, phase))
+            return false;
+    for (size_t i = 0; i < width; ++i)
+    {
+        columns.emplace_back();
+        exact.emplace_back();
+        transitions.emplace_back();
+        if (!get(stream, count) || count > height || count > limit / runSize)
+            return false;
+        columns[i].resize(count);
+        std::uint64_t next = 0;     // Первая точка, не покрытая предыдущими сериями
+        for (Run &run : columns[i])
+        {
+            std::int32_t stablest;
+            if (!(get(stream, run.start) && get(stream, run.length) && get(stream, run.phases) && get(stream, run.count) && get(stream, stablest)))
+                return false;
+            run.stablest = stablest;
+            if (run.start != next || !run.length || next + run.length > height ||
+                static_cast<std::uint64_t>(run.phases) + run.count > pool.size() ||
+                stablest < -1 || stablest >= static_cast<std::int64_t>(run.count))
+                return false;
+            next += run.length;
+        }
+        if (next != height)
+            return false;
+        if (!get(stream, count) || count > height || count > limit / pointSize)
+            return false;
+        exact[i].resize(count);
+        for (size_t k = 0; k < exact[i].size(); ++k)
+        {
+            ExactPoint &item = exact[i][k];
+            if (!(get(stream, item.row) && getPoint(stream, item.point, limit)) ||
+                item.row >= height || (k && item.row <= exact[i][k - 1].row))
+                return false;
+        }
+        if (!get(stream, count) || count > height || count > limit / sizeof(uint32_t))
+            return false;
+        transitions[i].resize(count);
+        for (size_t k = 0; k < transitions[i].size(); ++k)
+            if (!get(stream, transitions[i][k]) || transitions[i][k] >= height ||
+                (k && transitions[i][k] <= transitions[i][k - 1]))
+                return false;
+    }
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef COMPRESSEDDIAGRAM_H
+#define COMPRESSEDDIAGRAM_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "diagrampoint.h"
+
+/* Сжатое представление фазовой диаграммы.
+ * Диаграмма кусочно-постоянна, поэтому каждый столбец хранится как последовательность серий (run-length encoding)
+ * точек с одинаковым классом (набором типов устойчивых фаз и индексом наиболее устойчивой фазы).
+ * Для каждой серии хранится ссылка на общий пул с информацией о фазах её первой точки,
+ * точные данные сохраняются только для точек на границах серий.
+ * Точки линий фазовых переходов первого рода хранятся отдельным списком по столбцам.
+ */
+
+class CompressedDiagram
+{
+private:
+    // Класс точки: типы устойчивых фаз (в порядке их следования в векторе phases) и индекс наиболее устойчивой
+    struct PhaseClass
+    {
+        std::vector<unsigned> types;
+        std::ptrdiff_t stablest;
+        bool operator==(const PhaseClass &other) const;
+    };
+    // Серия точек одного класса
+    struct Run
+    {
+        std::uint32_t start;        // Номер первой точки серии в столбце
+        std::uint32_t length;       // Длина серии
+        std::uint32_t phases;       // Индекс первой фазы серии в пуле pool
+        std::uint32_t count;        // Количество фаз
+        std::ptrdiff_t stablest;    // Индекс наиболее устойчивой фазы
+    };
+    // Точная запись о точке на границе серии
+    struct ExactPoint
+    {
+        std::uint32_t row;
+        DiagramPoint point;
+    };
+    std::size_t width, height;                          // Размеры диаграммы
+    double startX, startY, dX, dY;                      // Координаты точки (0, height - 1) и шаги по Бета1 и Альфа1
+    std::vector<PhaseInfo> pool;                        // Общий пул информации о фазах
+    std::vector<std::vector<Run>> columns;              // Серии по столбцам
+    std::vector<std::vector<ExactPoint>> exact;         // Точные записи по столбцам (упорядочены по row)
+    std::vector<std::vector<std::uint32_t>> transitions;// Точки линий фазовых переходов по столбцам (упорядочены)
+    // Потоковый декодер: позиция последнего обращения, позволяющая обходить столбец без поиска
+    mutable std::size_t cursorColumn, cursorRun;
+    // Буфер для восстановленной точки
+    mutable DiagramPoint scratch;
+    // Возвращает класс точки
+    static PhaseClass getClass(const DiagramPoint &point);
+    // Возвращает индекс серии, содержащей точку (x, y)
+    std::size_t findRun(std::size_t x, std::size_t y) const;
+public:
+    CompressedDiagram();
+    /* Подготовка к заполнению диаграммы размером w x h.
+     * x0 и y0 - значения Бета1 и Альфа1 в левой нижней точке, stepX и stepY - шаги по ним.
+     */
+    void reset(std::size_t w, std::size_t h, double x0, double y0, double stepX, double stepY);
+    // Сжимает и добавляет очередной столбец диаграммы (столбцы добавляются по порядку)
+    void appendColumn(const std::vector<DiagramPoint> &column);
+    /* Заменяет точки линий фазовых переходов первого рода в добавленном столбце x (rows упорядочены по возрастанию).
+     * Разные столбцы можно обновлять из нескольких потоков одновременно.
+     */
+    void setTransitions(std::size_t x, std::vector<std::uint32_t> rows);
+    // Возвращает количество добавленных столбцов и количество точек в столбце
+    std::size_t columnsCount() const;
+    std::size_t rowsCount() const;
+    /* Возвращает информацию о точке (x, y).
+     * Для точек внутри серий фазы восстанавливаются по первой точке серии, координаты вычисляются точно.
+     * Ссылка действительна до следующего вызова. Последовательный обход столбца не требует поиска.
+     */
+    const DiagramPoint &at(std::size_t x, std::size_t y) const;
+    /* Восстанавливает столбец x целиком в result.
+     * В отличие от at() не использует общий буфер, поэтому может вызываться из нескольких потоков одновременно.
+     */
+    void column(std::size_t x, std::vector<DiagramPoint> &result) const;
+    // Возвращает объём памяти, занимаемый сжатыми данными (в байтах, приблизительно)
+    std::size_t memoryUsage() const;
+    // Запись в поток и чтение из потока (формат двоичный, см. реализацию)
+    bool write(std::ostream &stream) const;
+    bool read(std::istream &stream);
+};
+
+#endif // COMPRESSEDDIAGRAM_H
@@ -0,0 +1,321 @@
+#include <QPoint>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "curvetracer.h"
+#include "phaseequations.h"
+
+
+namespace
+{
+    constexpr double eps = std::numeric_limits<double>::epsilon();
+}
+
+
+CurveTracer::CurveTracer(const Worker &diagram, double tolerance)
+    : source(diagram), coeffs(diagram.getCoefficients()), size(diagram.getSize()), tolerance(tolerance), seeds(0), steps(0)
+{
+    QPointF s = diagram.getSteps();
+    dX = s.x();
+    dY = s.y();
+}
+
+
+CurveTracer::~CurveTracer()
+{
+
+}
+
+
+CurveTracer::Pixel CurveTracer::pixel(const State &z) const
+{
+    return {(z[1] - coeffs.b[0]) / dX, (z[0] - coeffs.a[0]) / dY};
+}
+
+
+QPointF CurveTracer::toDiagram(Pixel p) const
+{
+    return QPointF(coeffs.b[0] + p.u * dX, coeffs.a[0] + p.v * dY);
+}
+
+
+bool CurveTracer::tangent(const State &z, Pixel previous, Pixel &direction, State &derivative) const
+{
+    const std::size_t n = z.size();
+    std::vector<double> f(n), jacobian(n * n);
+    evaluate(z, f, jacobian);
+    // Уравнения линии сохраняются, смещение вдоль previous - единичное
+    double *row = &jacobian[(n - 1) * n];
+    std::fill(row, row + n, 0.0);
+    row[0] = previous.v / dY;
+    row[1] = previous.u / dX;
+    derivative.assign(n, 0.0);
+    derivative[n - 1] = 1.0;
+    if (!solveLinear(jacobian, derivative, n))
+        return false;
+    double u = derivative[1] / dX, v = derivative[0] / dY, norm = std::hypot(u, v);
+    if (!(norm > 0) || !std::isfinite(norm))
+        return false;
+    direction = {u / norm, v / norm};
+    for (double &value : derivative)
+        value /= norm;
+    return true;
+}
+
+
+bool CurveTracer::correct(State &z, Pixel target, Pixel direction, double reach) const
+{
+    const std::size_t n = z.size();
+    std::vector<double> f(n), jacobian(n * n), scale(n);
+    double previous = std::numeric_limits<double>::infinity();
+    for (unsigned it = 0; it < maxIterations; ++it)
+    {
+        evaluate(z, f, jacobian);
+        Pixel p = pixel(z);
+        double *row = &jacobian[(n - 1) * n];
+        std::fill(row, row + n, 0.0);
+        row[0] = direction.v / dY;
+        row[1] = direction.u / dX;
+        f[n - 1] = direction.u * (p.u - target.u) + direction.v * (p.v - target.v);
+        for (double &value : f)
+            value = -value;
+        if (!solveLinear(jacobian, f, n))
+            return false;
+        /* Шаг ограничивается долей |N| каждой фазы (как и в MulticriticalLocator::solve()),
+         * масштабы для критерия сходимости: Альфа1 и Бета1 - шаг сетки, N - |N| фазы (N[1]^2 - |N|^2)
+         */
+        scale[0] = std::abs(dY);
+        scale[1] = std::abs(dX);
+        for (std::size_t k = 0; k < types.size(); ++k)
+        {
+            double x = z[2 + 2 * k], y = z[3 + 2 * k];
+            double r = std::max(types[k] == 4 ? std::sqrt(x * x + std::abs(y)) : std::hypot(x, y), eps);
+            scale[2 + 2 * k] = r;
+            scale[3 + 2 * k] = types[k] == 4 ? r * r : r;
+        }
+        double limit = 1.0;
+        for (std::size_t k = 2; k < n; ++k)
+            limit = std::max(limit, std::abs(f[k]) / (maxOrderStep * scale[k]));
+        double norm = 0.0;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            z[k] += f[k] / limit;
+            norm = std::max(norm, std::abs(f[k] / limit) / scale[k]);
+        }
+        p = pixel(z);
+        if (std::hypot(p.u - target.u, p.v - target.v) > reach)
+            return false;
+        if (norm <= 4 * eps || (norm >= previous && previous <= 1e-10))
+            return true;
+        previous = norm;
+    }
+    return false;
+}
+
+
+TracedLine::End CurveTracer::follow(State z, Pixel direction, std::vector<QPointF> &points)
+{
+    const Pixel start = pixel(z);
+    State derivative;
+    if (!tangent(z, direction, direction, derivative))
+        return TracedLine::Stopped;
+    // Шаг и его верхняя граница (уменьшается, когда следующая вершина не проходит проверку)
+    double h = 1.0, cap = maxStep, length = 0.0;
+    const std::size_t n = z.size();
+    State next(n), middle(n);
+    for (std::size_t count = 0; count < maxVertices; )
+    {
+        if (h < minStep)
+            return TracedLine::Stopped;
+        Pixel p = pixel(z);
+        // Предиктор по касательной и корректор
+        for (std::size_t k = 0; k < n; ++k)
+            next[k] = z[k] + h * derivative[k];
+        if (!correct(next, {p.u + h * direction.u, p.v + h * direction.v}, direction, h))
+        {
+            h /= 2;
+            continue;
+        }
+        // Отклонение линии от хорды в её середине
+        Pixel q = pixel(next);
+        double chord = std::hypot(q.u - p.u, q.v - p.v);
+        if (!(chord > 0))
+        {
+            h /= 2;
+            continue;
+        }
+        Pixel along {(q.u - p.u) / chord, (q.v - p.v) / chord}, centre {(p.u + q.u) / 2, (p.v + q.v) / 2};
+        for (std::size_t k = 0; k < n; ++k)
+            middle[k] = (z[k] + next[k]) / 2;
+        if (!correct(middle, centre, along, h))
+        {
+            h /= 2;
+            continue;
+        }
+        Pixel m = pixel(middle);
+        double deviation = std::hypot(m.u - centre.u, m.v - centre.v);
+        if (deviation > tolerance)
+        {
+            h *= std::max(0.25, 0.9 * std::sqrt(tolerance / deviation));
+            continue;
+        }
+        // Проверка вершины: точка, где нарушается условие, определяется с точностью до допуска
+        TracedLine::End reason;
+        if (!isValid(next, reason))
+        {
+            if (h <= tolerance)
+                return reason;
+            cap = h / 2;
+            h = cap;
+            continue;
+        }
+
+        // Вершина принята
+        ++steps;
+        ++count;
+        length += chord;
+        double w = size.width() - 1, hh = size.height() - 1;
+        if (q.u < 0 || q.v < 0 || q.u > w || q.v > hh)
+        {
+            // Последний отрезок обрезается границей диаграммы
+            double s = 1.0;
+            if (q.u < 0)
+                s = std::min(s, p.u / (p.u - q.u));
+            if (q.u > w)
+                s = std::min(s, (w - p.u) / (q.u - p.u));
+            if (q.v < 0)
+                s = std::min(s, p.v / (p.v - q.v));
+            if (q.v > hh)
+                s = std::min(s, (hh - p.v) / (q.v - p.v));
+            points.push_back(toDiagram({p.u + s * (q.u - p.u), p.v + s * (q.v - p.v)}));
+            return TracedLine::Boundary;
+        }
+        points.push_back(toDiagram(q));
+        // Замыкание: линия вернулась к начальной точке
+        if (length > 2 * maxStep && std::hypot(q.u - start.u, q.v - start.v) <= std::max(h, 2 * tolerance))
+        {
+            points.push_back(toDiagram(start));
+            return TracedLine::Closed;
+        }
+        z = next;
+        if (!tangent(z, along, direction, derivative))
+            return TracedLine::Stopped;
+        h = std::min(cap, h * std::min(2.0, 0.9 * std::sqrt(tolerance / std::max(deviation, eps))));
+    }
+    return TracedLine::Stopped;
+}
+
+
+void CurveTracer::forEachEdge(const std::function<void(int, int, bool, const DiagramPoint&, const DiagramPoint&)> &visit)
+{
+    seeds = steps = 0;
+    const int width = size.width(), height = size.height();
+    covered.assign(static_cast<std::size_t>(width) * height, 0);
+    if (width < 1 || height < 1)
+        return;
+    // Два соседних столбца
+    std::vector<DiagramPoint> left, right;
+    source.getColumn(0, right);
+    for (int i = 0; i < width; ++i)
+    {
+        left.swap(right);
+        if (i + 1 < width)
+            source.getColumn(i + 1, right);
+        for (int j = 0; j < height; ++j)
+        {
+            if (i + 1 < width)
+                visit(i, j, false, left[j], right[j]);
+            if (j + 1 < height)
+                visit(i, j, true, left[j], left[j + 1]);
+        }
+    }
+}
+
+
+CurveTracer::State CurveTracer::initial(int i, int j, bool vertical, const std::vector<PhaseInfo> &phases)
+{
+    State z(2 + 2 * phases.size());
+    types.resize(phases.size());
+    signs.resize(phases.size());
+    // Середина отрезка; строка j = 0 - наибольшее Альфа1
+    z[0] = coeffs.a[0] + (size.height() - 1 - j - (vertical ? 0.5 : 0.0)) * dY;
+    z[1] = coeffs.b[0] + (i + (vertical ? 0.0 : 0.5)) * dX;
+    for (std::size_t p = 0; p < phases.size(); ++p)
+    {
+        types[p] = phases[p].type;
+        signs[p] = phases[p].n[1];
+        phaseVariables(phases[p], z[2 + 2 * p], z[3 + 2 * p]);
+    }
+    return z;
+}
+
+
+bool CurveTracer::traceLine(bool vertical, State z, TracedLine &line)
+{
+    // Начальная точка на отрезке сетки: фиксируется координата поперёк отрезка
+    Pixel centre = pixel(z), across = vertical ? Pixel {1.0, 0.0} : Pixel {0.0, 1.0};
+    TracedLine::End reason;
+    if (!correct(z, centre, across, 1.0) || !isValid(z, reason))
+        return false;
+    // Направление: из двух начальных вариантов (по Бета1 и по Альфа1) - ближайший к касательной
+    Pixel direction, other;
+    State derivative;
+    bool ok = tangent(z, {1.0, 0.0}, direction, derivative);
+    if (tangent(z, {0.0, 1.0}, other, derivative) && (!ok || std::abs(other.v) > std::abs(direction.u)))
+        direction = other;
+    else if (!ok)
+        return false;
+    ++seeds;
+    line.points.assign(1, toDiagram(pixel(z)));
+    line.ends[1] = follow(z, direction, line.points);
+    if (line.ends[1] == TracedLine::Closed)
+        line.ends[0] = TracedLine::Closed;
+    else
+    {
+        std::vector<QPointF> back;
+        line.ends[0] = follow(z, {-direction.u, -direction.v}, back);
+        line.points.insert(line.points.begin(), back.rbegin(), back.rend());
+    }
+    return true;
+}
+
+
+void CurveTracer::cover(const std::vector<QPointF> &points, unsigned char mask)
+{
+    // Точки отрезков берутся с шагом в четверть шага сетки, отмечаются отрезки сетки в окрестности одного шага
+    auto mark = [this, mask](double u, double row)
+    {
+        int i0 = static_cast<int>(std::floor(u)), j0 = static_cast<int>(std::floor(row));
+        for (int i = i0 - 1; i <= i0 + 2; ++i)
+            for (int j = j0 - 1; j <= j0 + 2; ++j)
+                if (i >= 0 && j >= 0 && i < size.width() && j < size.height())
+                    covered[static_cast<std::size_t>(i) * size.height() + j] |= mask;
+    };
+    for (std::size_t k = 0; k + 1 < points.size(); ++k)
+    {
+        double u0 = (points[k].x() - coeffs.b[0]) / dX, u1 = (points[k + 1].x() - coeffs.b[0]) / dX;
+        double r0 = size.height() - 1 - (points[k].y() - coeffs.a[0]) / dY;
+        double r1 = size.height() - 1 - (points[k + 1].y() - coeffs.a[0]) / dY;
+        std::size_t n = static_cast<std::size_t>(std::ceil(4 * std::hypot(u1 - u0, r1 - r0))) + 1;
+        for (std::size_t s = 0; s <= n; ++s)
+            mark(u0 + (u1 - u0) * s / n, r0 + (r1 - r0) * s / n);
+    }
+}
+
+
+bool CurveTracer::isCovered(int i, int j, unsigned char mask) const
+{
+    return covered[static_cast<std::size_t>(i) * size.height() + j] & mask;
+}
+
+
+std::size_t CurveTracer::seedsCount() const
+{
+    return seeds;
+}
+
+
+std::size_t CurveTracer::stepsCount() const
+{
+    return steps;
+}
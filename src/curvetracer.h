@@ -0,0 +1,117 @@
+#ifndef CURVETRACER_H
+#define CURVETRACER_H
+
+#include <QPointF>
+#include <QSize>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "worker.h"
+
+
+// Линия на плоскости диаграммы, построенная CurveTracer
+struct TracedLine
+{
+    // Причина окончания линии
+    enum End
+    {
+        Boundary,       // Граница диаграммы
+        StabilityLimit, // Одна из фаз теряет устойчивость (конец линии перехода)
+        TriplePoint,    // Устойчивее становится третья фаза
+        Degenerate,     // Фаза вырождается (точка возврата спинодали, слияние с другой фазой)
+        Closed,         // Линия замкнута
+        Stopped         // Продолжение не удалось (вырождение системы, слишком малый шаг)
+    };
+    std::vector<QPointF> points;    // Вершины ломаной (x - Бета1, y - Альфа1)
+    End ends[2];                    // Причины окончания линии в первой и последней вершинах
+};
+
+
+/* ---------------------------------------------------------------------------- *
+ * CurveTracer - базовый класс построения линий на плоскости диаграммы,         *
+ * заданных уравнениями для Альфа1, Бета1 и параметров порядка нескольких фаз   *
+ * ---------------------------------------------------------------------------- *
+ *
+ * Состояние на линии - Альфа1, Бета1 и переменные фаз types (см. phaseequations.h), всего n неизвестных;
+ * линия задаётся n - 1 уравнениями (evaluate() производного класса). Линия продолжается методом
+ * продолжения по параметру (предиктор-корректор): касательная - решение системы из якобиана линии
+ * и условия единичного смещения вдоль предыдущего направления на плоскости, корректор - метод Ньютона
+ * для уравнений линии и условия псевдодлины дуги (проекция смещения на касательную равна шагу).
+ * Длины дуги и шаги измеряются в шагах сетки. Шаг адаптивный: отклонение линии от хорды в середине
+ * каждого отрезка ломаной (находится тем же корректором) не превышает заданного допуска, иначе шаг уменьшается.
+ * Каждая вершина проверяется isValid() производного класса; если вершина не проходит проверку, шаг делится
+ * пополам, пока не станет меньше допуска: линия заканчивается там, где нарушается условие, с погрешностью
+ * не больше допуска. На границе диаграммы последний отрезок обрезается.
+ * Начальные точки берутся на отрезках сетки; отрезки, которые уже пересекла построенная линия,
+ * отмечаются, чтобы одна линия не строилась несколько раз.
+ */
+
+class CurveTracer
+{
+public:
+    // tolerance - допустимое отклонение ломаной от линии (в шагах сетки)
+    CurveTracer(const Worker &diagram, double tolerance);
+    virtual ~CurveTracer();
+    // Возвращают число использованных начальных точек и число принятых шагов последнего построения
+    std::size_t seedsCount() const;
+    std::size_t stepsCount() const;
+protected:
+    // Состояние на линии: Альфа1, Бета1 и переменные фаз types
+    typedef std::vector<double> State;
+    const Worker &source;
+    Coefficients coeffs;
+    double dX, dY;
+    QSize size;
+    double tolerance;
+    std::vector<unsigned> types;    // Типы фаз, переменные которых входят в состояние
+    std::vector<double> signs;      // Знаки N[1] фаз (для фазы 4)
+    std::size_t seeds, steps;
+
+    // Невязки и якобиан уравнений линии (строки 0..n - 2 матрицы n x n)
+    virtual void evaluate(const State &z, std::vector<double> &f, std::vector<double> &jacobian) const = 0;
+    // Проверяет вершину линии (reason - причина окончания линии, если вершина не прошла проверку)
+    virtual bool isValid(const State &z, TracedLine::End &reason) = 0;
+
+    /* Обходит отрезки сетки от (i, j) к (i + 1, j) (vertical = false) и к (i, j + 1) (vertical = true)
+     * с точками first и second на концах; начинает новое построение (сбрасывает счётчики и отметки)
+     */
+    void forEachEdge(const std::function<void(int i, int j, bool vertical, const DiagramPoint &first,
+                                              const DiagramPoint &second)> &visit);
+    // Начальное состояние в середине отрезка сетки по параметрам порядка фаз phases (задаёт types и signs)
+    State initial(int i, int j, bool vertical, const std::vector<PhaseInfo> &phases);
+    /* Уточняет начальное состояние z (из initial()) на отрезке сетки и строит линию в обе стороны от него;
+     * false - линия не найдена
+     */
+    bool traceLine(bool vertical, State z, TracedLine &line);
+    // Отметки пройденных отрезков сетки (mask - набор битов, например, для разных видов линий)
+    void cover(const std::vector<QPointF> &points, unsigned char mask);
+    bool isCovered(int i, int j, unsigned char mask) const;
+private:
+    // Максимальный и минимальный шаг (в шагах сетки)
+    static constexpr double maxStep = 4.0;
+    static constexpr double minStep = 1e-6;
+    // Максимальное число итераций корректора и максимальный шаг Ньютона по параметру порядка (в долях |N|)
+    static constexpr unsigned maxIterations = 30;
+    static constexpr double maxOrderStep = 0.25;
+    // Максимальное число вершин линии (в каждую сторону от начальной точки)
+    static constexpr std::size_t maxVertices = 100000;
+    // Точка в столбцах/строках сетки (u - по Бета1, v - по Альфа1, вверх)
+    struct Pixel
+    {
+        double u, v;
+    };
+    std::vector<unsigned char> covered;
+
+    Pixel pixel(const State &z) const;
+    QPointF toDiagram(Pixel p) const;
+    /* Касательная к линии в точке z: единичное направление на плоскости (direction, в ту же сторону, что и previous)
+     * и производная состояния по длине дуги вдоль него
+     */
+    bool tangent(const State &z, Pixel previous, Pixel &direction, State &derivative) const;
+    // Корректор: точка линии z, для которой проекция z - target на direction равна нулю, не дальше reach от target
+    bool correct(State &z, Pixel target, Pixel direction, double reach) const;
+    // Продолжает линию из z в направлении direction; вершины добавляются в points, возвращается причина окончания
+    TracedLine::End follow(State z, Pixel direction, std::vector<QPointF> &points);
+};
+
+#endif // CURVETRACER_H
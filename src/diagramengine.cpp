@@ -0,0 +1,664 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <thread>
+#include "diagramengine.h"
+#include "polynomial.h"
+#include "phasemodels.h"
+#include "npywriter.h"
+
+
+DiagramEngine::DiagramEngine(std::size_t w, std::size_t h)
+    : compressedStorage(false), analysis(true), precise(false), illConditioned(false), timingCounter(0), timingWeight(0.0),
+      model(PotentialModel::Trigonal3m), dX(0.0), dY(0.0), coeffs(), cancelled(false), width(w), height(h)
+{
+    // Резервирование места в двумерном векторе
+    data.resize(width);
+    for (auto &vec : data)
+        vec.resize(height);
+}
+
+
+DiagramEngine::~DiagramEngine()
+{
+
+}
+
+
+/* Проверяет условия минимума потенциала Potential (dxx > 0 и dxx * dyy - dxy^2 > 0) в точке (x, y)
+ * и, если они выполнены, вычисляет в phi значение потенциала.
+ * Вычисления выполняются в типе T. Если меньшее собственное значение гессиана или dxx мало
+ * по сравнению с элементами гессиана (в marginEps раз), выставляется признак marginal.
+ * При acceptMarginal такая точка считается минимумом, если гессиан неотрицательно определён с этой
+ * точностью и не равен нулю (вырожденный минимум на границе устойчивости фазы; при нулевом гессиане,
+ * например в начале координат при Альфа1 = 0, условия второго порядка ничего не говорят о минимуме).
+ */
+template<class Potential, class T>
+static bool isMinimum(const double *c, T x, T y, double &phi, bool &marginal, double marginEps, bool acceptMarginal)
+{
+    T first = Potential::template Derivative<2, 0>::value(c, x, y);
+    T second = Potential::template Derivative<0, 2>::value(c, x, y);
+    T mixed = Potential::template Derivative<1, 1>::value(c, x, y);
+    T det = first * second - mixed * mixed;
+    // Допуск собственных значений; меньшее из них (при малом det) близко к det / (first + second)
+    T margin = marginEps * (std::abs(first) + std::abs(second) + std::abs(mixed));
+    T detMargin = margin * (std::abs(first) + std::abs(second));
+    marginal = std::abs(first) <= margin || std::abs(det) <= detMargin;
+    if (marginal && acceptMarginal)
+    {
+        if (first < -margin || second < -margin || det < -detMargin || first + second <= 0)
+            return false;
+    }
+    else if (first <= 0 || det <= 0)
+        return false;
+    phi = static_cast<double>(Potential::value(c, x, y));
+    return true;
+}
+
+
+/* Возвращает true, если при данных значениях коэффициентов в точке (x, y) выполнены условия минимума
+ * потенциала Potential (фаза термодинамически стабильна). Если возвращается true, в phi помещается потенциал фазы.
+ */
+template<class Potential>
+bool DiagramEngine::PhaseSolver::isStable(double x, double y, double &phi)
+{
+    MetricsTimer timer(engine.current.stabilityTime, engine.timingWeight);
+    bool marginal;
+    if (engine.precise)
+        return isMinimum<Potential, long double>(c, x, y, phi, marginal, marginEps, true);
+    bool res = isMinimum<Potential, double>(c, x, y, phi, marginal, marginEps, false);
+    if (marginal)
+        engine.illConditioned = true;
+    return res;
+}
+
+
+/* Находит фазы модели model, проверяет выполнение условий термодинамической устойчивости
+ * и возвращает список стабильных фаз для коэффициентов coeffs
+ */
+
+std::vector<PhaseInfo> DiagramEngine::getPhases()
+{
+    std::vector<PhaseInfo> info;
+
+    // Ядра моделей собираются на этапе компиляции (PhaseModel)
+    PhaseSolver solver(*this);
+    switch (model)
+    {
+    case PotentialModel::Trigonal3m:
+        Model3m::phases(solver, info);
+        break;
+    case PotentialModel::Tetragonal4mm:
+        Model4mm::phases(solver, info);
+        break;
+    }
+
+    // Близкие потенциалы фаз (сосуществование): наиболее устойчивая фаза определяется ненадёжно
+    if (!precise)
+        for (std::size_t i = 0; i < info.size() && !illConditioned; ++i)
+            for (std::size_t j = i + 1; j < info.size(); ++j)
+                if (std::abs(info[i].phi - info[j].phi) <= marginEps * std::max({std::abs(info[i].phi), std::abs(info[j].phi), 1.0}))
+                {
+                    illConditioned = true;
+                    break;
+                }
+
+    return info;
+}
+
+
+// Находит корни уравнения, учитывая затраченное время в показателях производительности
+const std::vector<double> &DiagramEngine::solve(Polynomial &equation)
+{
+    MetricsTimer timer(current.rootTime, timingWeight);
+    ++current.solverCalls;
+    std::vector<double> &res = solverContext.roots;
+    if (precise)
+    {
+        // Корни изолируются заново в long double с уменьшенной погрешностью (не только уточняются)
+        equation.preciseRoots(solverContext);
+        for (double &x : res)
+            x = equation.polishRoot(x);
+        return res;
+    }
+    equation.roots(solverContext);
+    for (double x : res)
+        if (equation.rootCondition(x) > conditionLimit)
+        {
+            illConditioned = true;
+            break;
+        }
+    return res;
+}
+
+
+/* Пакетное решение кубических уравнений аналитическим методом (если для 3 степени выбран другой метод,
+ * уравнения решаются по одному через roots()). Каждое уравнение учитывается в показателях как отдельный вызов.
+ */
+void DiagramEngine::solveCubics(std::size_t n, const std::array<double, 4> *coeffs, std::array<double, 3> *roots, unsigned *counts)
+{
+    MetricsTimer timer(current.rootTime, timingWeight);
+    current.solverCalls += n;
+    if (precise)
+    {
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            Polynomial equation({coeffs[k][0], coeffs[k][1], coeffs[k][2], coeffs[k][3]});
+            const std::vector<double> &res = equation.preciseRoots(solverContext);
+            counts[k] = std::min<std::size_t>(res.size(), 3);
+            for (unsigned i = 0; i < counts[k]; ++i)
+                roots[k][i] = Polynomial::polishRoot(coeffs[k].data(), 4, res[i]);
+        }
+        return;
+    }
+    if (Polynomial::solver(3) == RootSolver::Analytic)
+        Polynomial::solveCubics(n, coeffs, roots, counts);
+    else
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            Polynomial equation({coeffs[k][0], coeffs[k][1], coeffs[k][2], coeffs[k][3]});
+            const std::vector<double> &res = equation.roots(solverContext);
+            counts[k] = std::min<std::size_t>(res.size(), 3);
+            std::copy(res.begin(), res.begin() + counts[k], roots[k].begin());
+        }
+    for (std::size_t k = 0; k < n; ++k)
+        for (unsigned i = 0; i < counts[k]; ++i)
+            if (Polynomial::rootCondition(coeffs[k].data(), 4, roots[k][i]) > conditionLimit)
+                illConditioned = true;
+}
+
+
+/* Рассчитывает набор стабильных фаз и наиболее устойчивую фазу в точке (i, j) диаграммы
+ * (startX и startY - стартовые значения Бета1 и Альфа1)
+ */
+void DiagramEngine::calculatePoint(std::size_t i, std::size_t j, double startX, double startY, DiagramPoint &dp)
+{
+    coeffs.b[0] = startX + i * dX;
+    coeffs.a[0] = startY + (height - 1 - j) * dY;
+    calculatePhases(dp);
+}
+
+
+// Рассчитывает точку диаграммы для текущих значений coeffs
+void DiagramEngine::calculatePhases(DiagramPoint &dp)
+{
+    dp.x = coeffs.b[0];
+    dp.y = coeffs.a[0];
+    dp.transition = false;
+    timingWeight = timingCounter++ % timingPeriod ? 0.0 : timingPeriod;
+
+    illConditioned = false;
+    dp.phases = getPhases();
+    if (illConditioned)
+    {
+        /* Плохо обусловленная точка рассчитывается повторно с повышенной точностью.
+         * Если уточнённый расчёт нашёл меньше стабильных фаз, сохраняется исходный результат:
+         * фаза, устойчивая в double, не должна пропадать из-за уточнения на границе устойчивости.
+         */
+        precise = true;
+        std::vector<PhaseInfo> refined = getPhases();
+        precise = false;
+        if (refined.size() >= dp.phases.size())
+            dp.phases = std::move(refined);
+        ++current.refinedPoints;
+    }
+
+    // Выяснение наиболее устойчивой фазы, т.е. фазы с миниммальным потенциалом
+    auto pos = std::min_element(dp.phases.begin(),
+                                dp.phases.end(),
+                                [] (PhaseInfo &first, PhaseInfo &second) {return first.phi < second.phi;});
+    dp.stablest = pos == dp.phases.end() ? -1 : pos - dp.phases.begin();
+}
+
+
+void DiagramEngine::evaluatePoint(double x, double y, DiagramPoint &dp)
+{
+    double startY = coeffs.a[0], startX = coeffs.b[0];
+    coeffs.b[0] = x;
+    coeffs.a[0] = y;
+    calculatePhases(dp);
+    coeffs.a[0] = startY, coeffs.b[0] = startX;
+}
+
+
+/* Завершает обработку рассчитанного столбца i: запоминает ключи его точек для определения фазовых переходов
+ * первого рода (переходы отмечаются отдельным проходом после расчёта, см. TransitionStencil),
+ * в режиме сжатого хранения сжимает столбец, обновляет показатели производительности
+ * и сообщает процент выполнения (progress())
+ */
+void DiagramEngine::finishColumn(std::size_t i)
+{
+    if (analysis)
+    {
+        MetricsTimer timer(current.transitionTime);
+        stencil.appendColumn(data[i]);
+    }
+
+    // В режиме сжатого хранения столбец больше не нужен: переходы определяются по ключам
+    if (compressedStorage)
+    {
+        compressed.appendColumn(data[i]);
+        std::vector<DiagramPoint>().swap(data[i]);
+    }
+
+    // Обновление показателей производительности и процент выполнения
+    current.points += height;
+    current.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    publishMetrics();
+    progress(width > 1 ? static_cast<int>(100 * i / (width - 1)) : 100);
+}
+
+
+void DiagramEngine::computeColumns(double startX, double startY)
+{
+    for (decltype(data.size()) i = 0; i < data.size() && !cancelled; ++i)
+    {
+        // Столбец мог быть освобождён при предыдущем расчёте в режиме сжатого хранения
+        data[i].resize(height);
+        for (decltype(data[i].size()) j = 0; j < data[i].size(); ++j)
+            calculatePoint(i, j, startX, startY, data[i][j]);
+        finishColumn(i);
+    }
+}
+
+
+void DiagramEngine::progress(int)
+{
+
+}
+
+
+/* Рассчитывает точки столбцов first..first + count - 1 в columns без определения фазовых переходов
+ * (coeffs.a[0] и coeffs.b[0] должны содержать стартовые значения Альфа1 и Бета1 всей диаграммы).
+ * Используется вычислительными процессами распределённого расчёта (см. TileFarm).
+ */
+void DiagramEngine::calculateColumns(std::size_t first, std::size_t count, std::vector<std::vector<DiagramPoint>> &columns)
+{
+    double startY = coeffs.a[0], startX = coeffs.b[0];
+    columns.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        columns[i].resize(height);
+        for (std::size_t j = 0; j < height; ++j)
+            calculatePoint(first + i, j, startX, startY, columns[i][j]);
+    }
+    // Точки учитываются при сборке столбцов (finishColumn())
+    publishMetrics();
+    coeffs.a[0] = startY, coeffs.b[0] = startX;
+}
+
+
+/* Статистика диаграммы как параллельная редукция: столбцы делятся на полосы, каждая полоса
+ * обрабатывается своим потоком с отдельным накопителем, затем частичные результаты складываются.
+ * В режиме сжатого хранения каждый поток сам восстанавливает свои столбцы (и столбец перед полосой).
+ */
+void DiagramEngine::computeStatistics()
+{
+    // Не менее minColumns столбцов на поток, иначе накладные расходы на запуск потоков не окупаются
+    const std::size_t minColumns = 64;
+    std::size_t threadsCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), width / minColumns));
+    std::vector<DiagramStatistics> partial(threadsCount);
+    auto reduce = [this, threadsCount, &partial](std::size_t k)
+    {
+        DiagramStatistics &s = partial[k];
+        s.reset(dX, dY);
+        std::size_t first = width * k / threadsCount, last = width * (k + 1) / threadsCount;
+        std::vector<DiagramPoint> buffers[2];
+        for (std::size_t i = first; i < last; ++i)
+        {
+            if (!compressedStorage)
+            {
+                s.addColumn(data[i], i ? &data[i - 1] : nullptr);
+                continue;
+            }
+            if (i == first && i)
+                compressed.column(i - 1, buffers[(i - 1) % 2]);
+            compressed.column(i, buffers[i % 2]);
+            s.addColumn(buffers[i % 2], i ? &buffers[(i - 1) % 2] : nullptr);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t k = 1; k < threadsCount; ++k)
+        threads.emplace_back(reduce, k);
+    reduce(0);
+    for (auto &t : threads)
+        t.join();
+
+    statistics.reset(dX, dY);
+    for (const DiagramStatistics &s : partial)
+        statistics += s;
+}
+
+
+void DiagramEngine::setTransitions(std::size_t i, const TransitionStencil::Key *flags)
+{
+    if (!compressedStorage)
+    {
+        for (std::size_t j = 0; j < height; ++j)
+            data[i][j].transition = flags[j];
+        return;
+    }
+    std::vector<std::uint32_t> rows;
+    for (std::size_t j = 0; j < height; ++j)
+        if (flags[j])
+            rows.push_back(j);
+    compressed.setTransitions(i, std::move(rows));
+}
+
+
+// Расчёт и заполнение массива data
+void DiagramEngine::calculate()
+{
+    // Стартовые значения Альфа1 и Бета1
+    double startY = coeffs.a[0], startX = coeffs.b[0];
+    cancelled = false;
+    startTime = std::chrono::steady_clock::now();
+    current = RunMetrics();
+    current.totalPoints = width * height;
+    publishMetrics();
+    if (compressedStorage)
+        compressed.reset(width, height, startX, startY, dX, dY);
+    if (analysis)
+        stencil.reset(width, height);
+
+    computeColumns(startX, startY);
+
+    // Фазовые переходы первого рода - отдельным проходом по ключам рассчитанных столбцов
+    if (analysis)
+    {
+        markTransitions(TransitionStencil::FirstOrder());
+        if (!cancelled)
+            computeStatistics();
+    }
+    else
+        statistics.reset(dX, dY);
+    current.elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    publishMetrics();
+
+    // Возвращение a[0] и b[0] их начальных значений
+    coeffs.a[0] = startY, coeffs.b[0] = startX;
+}
+
+
+/* Установка параметров: коэффициентов потенциала (для Альфа1 и Бета1 передаются их стартовые значения)
+ * и шагов изменения Альфа1 (stepY) и Бета1 (stepX).
+ * Функция должна вызываться перед запуском calculate().
+ */
+void DiagramEngine::setParameters(const Coefficients coefficients, const double stepX, const double stepY)
+{
+   coeffs = coefficients;
+   dX = stepX;
+   dY = stepY;
+}
+
+
+void DiagramEngine::cancel()
+{
+    cancelled = true;
+}
+
+
+bool DiagramEngine::isCancelled() const
+{
+    return cancelled;
+}
+
+
+void DiagramEngine::publishMetrics()
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metrics = current;
+}
+
+
+RunMetrics DiagramEngine::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    return metrics;
+}
+
+
+const DiagramPoint &DiagramEngine::pointAt(std::size_t i, std::size_t j) const
+{
+    if (compressedStorage)
+        return compressed.at(i, j);
+    return data[i][j];
+}
+
+
+const DiagramPoint &DiagramEngine::getDiagramPoint(std::size_t i, std::size_t j) const
+{
+    // Возвращает константную ссылку на структуру с информацией о данной точке диаграммы
+    return pointAt(i, j);
+}
+
+
+void DiagramEngine::getColumn(std::size_t i, std::vector<DiagramPoint> &column) const
+{
+    if (compressedStorage)
+        compressed.column(i, column);
+    else
+        column = data[i];
+}
+
+
+Coefficients DiagramEngine::getCoefficients() const
+{
+    return coeffs;
+}
+
+
+double DiagramEngine::getStepX() const
+{
+    return dX;
+}
+
+
+double DiagramEngine::getStepY() const
+{
+    return dY;
+}
+
+
+std::size_t DiagramEngine::getWidth() const
+{
+    return width;
+}
+
+
+std::size_t DiagramEngine::getHeight() const
+{
+    return height;
+}
+
+
+DiagramStatistics DiagramEngine::getStatistics() const
+{
+    return statistics;
+}
+
+
+void DiagramEngine::setModel(PotentialModel potentialModel)
+{
+    model = potentialModel;
+}
+
+
+PotentialModel DiagramEngine::getModel() const
+{
+    return model;
+}
+
+
+void DiagramEngine::setCompressedStorage(bool flag)
+{
+    compressedStorage = flag;
+}
+
+
+bool DiagramEngine::isCompressedStorage() const
+{
+    return compressedStorage;
+}
+
+
+void DiagramEngine::setAnalysis(bool flag)
+{
+    analysis = flag;
+}
+
+
+bool DiagramEngine::isAnalysis() const
+{
+    return analysis;
+}
+
+
+void DiagramEngine::swapCompressed(CompressedDiagram &other)
+{
+    std::swap(compressed, other);
+}
+
+
+/* Формат файла: сигнатура "PDG1", коэффициенты потенциала (9 double), шаги dX и dY (double),
+ * далее сжатая диаграмма (см. CompressedDiagram::write).
+ */
+
+static const char fileSignature[4] {'P', 'D', 'G', '1'};
+
+
+bool DiagramEngine::saveData(const std::string &fileName) const
+{
+    std::ofstream stream(fileName, std::ios::binary);
+    if (!stream)
+        return false;
+    stream.write(fileSignature, sizeof(fileSignature));
+    stream.write(reinterpret_cast<const char*>(coeffs.c), sizeof(coeffs.c));
+    stream.write(reinterpret_cast<const char*>(&dX), sizeof(dX));
+    stream.write(reinterpret_cast<const char*>(&dY), sizeof(dY));
+    if (compressedStorage)
+        return compressed.write(stream);
+    // Диаграмма хранится целиком и сжимается только для записи
+    CompressedDiagram temp;
+    temp.reset(width, height, coeffs.b[0], coeffs.a[0], dX, dY);
+    for (const auto &column : data)
+        temp.appendColumn(column);
+    return temp.write(stream);
+}
+
+
+bool DiagramEngine::loadData(const std::string &fileName)
+{
+    std::ifstream stream(fileName, std::ios::binary);
+    char signature[sizeof(fileSignature)];
+    Coefficients c;
+    double stepX, stepY;
+    if (!stream.read(signature, sizeof(signature)) || std::memcmp(signature, fileSignature, sizeof(signature)))
+        return false;
+    if (!stream.read(reinterpret_cast<char*>(c.c), sizeof(c.c)) ||
+        !stream.read(reinterpret_cast<char*>(&stepX), sizeof(stepX)) ||
+        !stream.read(reinterpret_cast<char*>(&stepY), sizeof(stepY)))
+        return false;
+    // Данные читаются во временный объект: при ошибке построенная диаграмма остаётся нетронутой
+    CompressedDiagram temp;
+    try
+    {
+        if (!temp.read(stream) || temp.columnsCount() != width || temp.rowsCount() != height)
+            return false;
+    }
+    catch (const std::bad_alloc &)
+    {
+        return false;
+    }
+    std::swap(compressed, temp);
+    // Полные данные больше не нужны
+    for (auto &column : data)
+        std::vector<DiagramPoint>().swap(column);
+    compressedStorage = true;
+    coeffs = c;
+    dX = stepX;
+    dY = stepY;
+    // Ключи точек - для повторного определения переходов (detectTransitions())
+    stencil.reset(width, height);
+    std::vector<DiagramPoint> column;
+    for (std::size_t i = 0; i < width; ++i)
+    {
+        compressed.column(i, column);
+        stencil.appendColumn(column);
+    }
+    computeStatistics();
+    return true;
+}
+
+
+/* Поля диаграммы записываются по столбцам (fortran_order, форма height x width, строка 0 - наибольшее Альфа1):
+ * в таком порядке точки хранятся в data и восстанавливаются из compressed, поэтому столбец переносится
+ * в буферы полей одним проходом и записывается целиком, без транспонирования и форматирования.
+ */
+bool DiagramEngine::exportFields(const std::string &prefix) const
+{
+    static const char *names[5] {"_stablest.npy", "_phases.npy", "_phi.npy", "_eta1.npy", "_eta2.npy"};
+    NpyWriter fields[5], axes[2];
+    const std::vector<std::size_t> shape {height, width};
+    bool ok = fields[0].open(prefix + names[0], "u1", 1, shape, true) &&
+              fields[1].open(prefix + names[1], "u1", 1, shape, true);
+    for (int k = 2; k < 5 && ok; ++k)
+        ok = fields[k].open(prefix + names[k], "f8", sizeof(double), shape, true);
+    ok = ok && axes[0].open(prefix + "_beta1.npy", "f8", sizeof(double), {width}, false) &&
+               axes[1].open(prefix + "_alpha1.npy", "f8", sizeof(double), {height}, false);
+    if (!ok)
+        return false;
+
+    // Оси: Бета1 по столбцам и Альфа1 по строкам (от наибольшего)
+    std::vector<double> values(std::max(width, height));
+    for (std::size_t i = 0; i < width; ++i)
+        values[i] = coeffs.b[0] + i * dX;
+    ok = axes[0].write(values.data(), width);
+    for (std::size_t j = 0; j < height; ++j)
+        values[j] = coeffs.a[0] + (height - 1 - j) * dY;
+    ok = ok && axes[1].write(values.data(), height);
+
+    // Тип наиболее устойчивой фазы (0 - нет устойчивых фаз), набор типов устойчивых фаз (бит k - фаза k + 1),
+    // потенциал и компоненты параметра порядка наиболее устойчивой фазы (NaN - нет устойчивых фаз)
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<std::uint8_t> stablest(height), phases(height);
+    std::vector<double> phi(height), eta1(height), eta2(height);
+    std::vector<DiagramPoint> buffer;
+    for (std::size_t i = 0; i < width && ok; ++i)
+    {
+        if (compressedStorage)
+            compressed.column(i, buffer);
+        const std::vector<DiagramPoint> &column = compressedStorage ? buffer : data[i];
+        for (std::size_t j = 0; j < height; ++j)
+        {
+            const DiagramPoint &dp = column[j];
+            std::uint8_t set = 0;
+            for (const PhaseInfo &item : dp.phases)
+                set |= 1u << (item.type - 1);
+            phases[j] = set;
+            if (dp.stablest == -1)
+            {
+                stablest[j] = 0;
+                phi[j] = eta1[j] = eta2[j] = nan;
+                continue;
+            }
+            const PhaseInfo &phase = dp.phases[dp.stablest];
+            stablest[j] = static_cast<std::uint8_t>(phase.type);
+            phi[j] = phase.phi;
+            eta1[j] = phase.n[0];
+            eta2[j] = phase.n[1];
+        }
+        ok = fields[0].write(stablest.data(), height) && fields[1].write(phases.data(), height) &&
+             fields[2].write(phi.data(), height) && fields[3].write(eta1.data(), height) &&
+             fields[4].write(eta2.data(), height);
+    }
+    for (NpyWriter &writer : fields)
+        ok = writer.close() && ok;
+    for (NpyWriter &writer : axes)
+        ok = writer.close() && ok;
+    return ok;
+}
@@ -0,0 +1,268 @@
+#ifndef DIAGRAMENGINE_H
+#define DIAGRAMENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "polynomial.h"
+#include "diagrampoint.h"
+#include "compresseddiagram.h"
+#include "runmetrics.h"
+#include "diagramstatistics.h"
+#include "transitionstencil.h"
+
+
+/* ---------------------------------------------------------------------  *
+ * DiagramEngine - расчёт фазовой диаграммы без зависимости от Qt         *
+ * ---------------------------------------------------------------------  *
+ * Основа Worker и библиотеки phasecore (C API для пакетных расчётов).    *
+ * Точки адресуются индексами (i, j): i - столбец (Бета1), j - строка,    *
+ * строка j = 0 соответствует наибольшему Альфа1.                         *
+ *                                                                        */
+
+
+// Коэффициенты модельного потенциала
+struct Coefficients
+{
+    union
+    {
+        struct
+        {
+            double a[4];
+            double b[2];
+            double d[3];
+        };
+        double c[9];
+    };
+};
+
+
+// Модели потенциала (см. phasemodels.h)
+enum class PotentialModel : unsigned
+{
+    Trigonal3m,     // Model3m - исходная модель программы
+    Tetragonal4mm   // Model4mm
+};
+
+
+class DiagramEngine
+{
+private:
+    static constexpr double eps = 1e-10;
+    /* Пороги обнаружения плохо обусловленных точек (вблизи кратных корней, границ устойчивости фаз
+     * и линий сосуществования): оценка обусловленности корня (Polynomial::rootCondition())
+     * и относительный запас условий устойчивости и разности потенциалов фаз.
+     */
+    static constexpr double conditionLimit = 1e7;
+    static constexpr double marginEps = 1e-7;
+    /* Признак хранения диаграммы в сжатом виде (для диаграмм большого размера).
+     * В этом режиме в data во время расчёта находится только текущий столбец,
+     * остальные сразу сжимаются в compressed.
+     */
+    bool compressedStorage;
+    // Признак определения фазовых переходов и расчёта статистики после расчёта точек (см. setAnalysis())
+    bool analysis;
+    CompressedDiagram compressed;
+    // Возвращает информацию о точке диаграммы из data или compressed
+    const DiagramPoint &pointAt(std::size_t i, std::size_t j) const;
+    RunMetrics metrics;
+    mutable std::mutex metricsMutex;
+    /* Режим повышенной точности, в котором повторно рассчитываются плохо обусловленные точки:
+     * корни изолируются заново в long double с уменьшенной погрешностью (Polynomial::preciseRoots())
+     * и уточняются методом Ньютона, устойчивость фаз и потенциалы вычисляются в long double,
+     * вырожденный в пределах marginEps минимум считается устойчивым.
+     */
+    bool precise;
+    // Признак плохой обусловленности текущей точки (выставляется в getPhases() при обычной точности)
+    bool illConditioned;
+    /* Время поиска корней и проверки устойчивости замеряется выборочно - в каждой timingPeriod-й точке
+     * (вызовы часов сопоставимы по стоимости с проверкой устойчивости). timingWeight - вес замеров
+     * текущей точки (timingPeriod или 0), timingCounter - число рассчитанных точек.
+     */
+    static constexpr unsigned timingPeriod = 16;
+    unsigned timingCounter;
+    double timingWeight;
+    // Рабочая память поиска корней (объект используется одним потоком)
+    SolverContext solverContext;
+    /* Находит корни уравнения с учётом в показателях производительности
+     * (ссылка на solverContext.roots действительна до следующего решения)
+     */
+    const std::vector<double> &solve(Polynomial &equation);
+    // Решает пакет из n кубических уравнений (см. Polynomial::solveCubics()) с учётом в показателях производительности
+    void solveCubics(std::size_t n, const std::array<double, 4> *coeffs, std::array<double, 3> *roots, unsigned *counts);
+    // Возвращает набор стабильных фаз для текущих значений коэффициентов потенциала
+    std::vector<PhaseInfo> getPhases();
+    // Рассчитывает точку (i, j) диаграммы (без определения фазовых переходов)
+    void calculatePoint(std::size_t i, std::size_t j, double startX, double startY, DiagramPoint &dp);
+    // Рассчитывает точку dp для текущих значений coeffs
+    void calculatePhases(DiagramPoint &dp);
+    // Ключи точек рассчитанных столбцов для определения фазовых переходов первого рода
+    TransitionStencil stencil;
+    // Отмечает переходы в рассчитанных столбцах по критерию criterion (см. TransitionStencil::run())
+    template<class Criterion>
+    void markTransitions(Criterion criterion);
+    // Записывает признаки переходов столбца i (flags[j] - признак для точки (i, j)) в data или compressed
+    void setTransitions(std::size_t i, const TransitionStencil::Key *flags);
+    // Время начала текущего расчёта
+    std::chrono::steady_clock::time_point startTime;
+    // Статистика построенной диаграммы
+    DiagramStatistics statistics;
+    // Рассчитывает statistics по данным диаграммы параллельно в нескольких потоках
+    void computeStatistics();
+    // Модель потенциала
+    PotentialModel model;
+protected:
+    // Шаг изменения Альфа1 (dY) и Бета1 (dX)
+    double dX, dY;
+    // Коэффициенты модельного потенциала
+    // (задаются перед началом расчётов и меняются в процессе)
+    Coefficients coeffs;
+    // Признак прерывания расчётов (устанавливается из другого потока функцией cancel())
+    std::atomic<bool> cancelled;
+    // Размеры диаграммы
+    std::size_t width, height;
+    // Двумерный массив, хранящий информацию для каждой точки диаграммы
+    std::vector<std::vector<DiagramPoint>> data;
+    // Показатели производительности: current накапливаются в процессе расчёта и периодически копируются в metrics
+    RunMetrics current;
+    // Копирует current в metrics
+    void publishMetrics();
+    // Завершает обработку рассчитанного столбца i (ключи для stencil, сжатие, показатели, вызов progress())
+    void finishColumn(std::size_t i);
+    /* Рассчитывает все столбцы диаграммы в data, для каждого вызывая finishColumn(), пока расчёт не прерван
+     * (startX и startY - стартовые значения Бета1 и Альфа1). По умолчанию - в данном потоке;
+     * Worker переопределяет функцию для распределённого расчёта.
+     */
+    virtual void computeColumns(double startX, double startY);
+    // Вызывается после каждого рассчитанного столбца (percent - процент выполнения)
+    virtual void progress(int percent);
+public:
+    /* Доступ ядер моделей (PhaseModel, см. phasemodel.h) к поиску корней и проверке устойчивости фаз
+     * с учётом показателей производительности, плохой обусловленности и режима повышенной точности
+     */
+    class PhaseSolver
+    {
+    private:
+        DiagramEngine &engine;
+    public:
+        static constexpr double eps = DiagramEngine::eps;
+        const double *const c;  // Коэффициенты потенциала
+        PhaseSolver(DiagramEngine &owner) : engine(owner), c(owner.coeffs.c) {}
+        const std::vector<double> &solve(Polynomial &equation) {return engine.solve(equation);}
+        void solveCubics(std::size_t n, const std::array<double, 4> *coeffs, std::array<double, 3> *roots, unsigned *counts)
+        {
+            engine.solveCubics(n, coeffs, roots, counts);
+        }
+        /* Возвращает true, если в точке (x, y) выполнены условия минимума потенциала Potential
+         * (phi - значение потенциала). Определена для моделей из phasemodels.h.
+         */
+        template<class Potential>
+        bool isStable(double x, double y, double &phi);
+    };
+
+    DiagramEngine(std::size_t w, std::size_t h);
+    virtual ~DiagramEngine();
+    /* Установка параметров - коэффициентов потенциала Coefficients
+     * (для Coefficients.alpha[0] и Coefficients.beta[0] должны быть установлены стартовые значения)
+     * и величин "шагов" по Бета1 (stepX) и Альфа1 (stepY).
+     * Функция должна быть вызывана перед вызовом calculate().
+     */
+    void setParameters(const Coefficients coefficients, const double stepX, const double stepY);
+    // Расчёт и заполнение диаграммы (прерывается функцией cancel())
+    void calculate();
+    /* Рассчитывает фазы в произвольной точке Бета1 = x, Альфа1 = y (не обязательно узле сетки)
+     * при остальных коэффициентах диаграммы. Не должна вызываться во время calculate().
+     */
+    void evaluatePoint(double x, double y, DiagramPoint &dp);
+    // Возвращает константную ссылку на информацию о фазах в точке (i, j)
+    const DiagramPoint &getDiagramPoint(std::size_t i, std::size_t j) const;
+    /* Копирует столбец i в column (память column используется повторно). В режиме сжатого хранения
+     * столбец восстанавливается целиком за один проход, что быстрее поточечных вызовов getDiagramPoint()
+     */
+    void getColumn(std::size_t i, std::vector<DiagramPoint> &column) const;
+    // Возвращает копию вектора коэффициентов
+    Coefficients getCoefficients() const;
+    // Возвращают шаги по Бета1 (X) и Альфа1 (Y)
+    double getStepX() const;
+    double getStepY() const;
+    // Возвращают размер диаграммы (число столбцов и строк)
+    std::size_t getWidth() const;
+    std::size_t getHeight() const;
+    /* Прерывает выполняющиеся расчёты (может вызываться из любого потока).
+     * calculate() завершается после обработки текущего столбца,
+     * данные в массиве при этом остаются неполными.
+     */
+    void cancel();
+    // Возвращает true, если последний запуск calculate() был прерван
+    bool isCancelled() const;
+    // Возвращает показатели производительности текущего или последнего расчёта (может вызываться из любого потока)
+    RunMetrics getMetrics() const;
+    // Возвращает статистику последней построенной или прочитанной из файла диаграммы
+    DiagramStatistics getStatistics() const;
+    /* Выбор модели потенциала (вызывается перед calculate(); по умолчанию - PotentialModel::Trigonal3m).
+     * Модель не записывается в файл данных, распределённый расчёт Worker выполняется для модели по умолчанию.
+     */
+    void setModel(PotentialModel potentialModel);
+    PotentialModel getModel() const;
+    // Включает или выключает сжатое хранение диаграммы (вызывается перед calculate())
+    void setCompressedStorage(bool flag);
+    bool isCompressedStorage() const;
+    /* Включает или выключает определение фазовых переходов первого рода и расчёт статистики в calculate()
+     * (по умолчанию включены). Без них точки не отмечаются как переходы, статистика пуста;
+     * выключается, когда нужны только фазы точек (члены ансамбля PhaseEnsemble). Вызывается перед calculate();
+     * после расчёта без анализа detectTransitions() не вызывается (ключи точек не сохранены).
+     */
+    void setAnalysis(bool flag);
+    bool isAnalysis() const;
+    /* Обменивает сжатые данные диаграммы с other (используется PhaseVolume, чтобы забрать рассчитанный слой
+     * без копирования). После обмена данные диаграммы недействительны до следующего calculate().
+     */
+    void swapCompressed(CompressedDiagram &other);
+    /* Запись построенной диаграммы (в сжатом виде) и коэффициентов в файл и чтение из файла.
+     * При чтении размер диаграммы в файле должен совпадать с размером данного объекта,
+     * после чтения включается сжатое хранение. Функции возвращают false в случае ошибки.
+     */
+    bool saveData(const std::string &fileName) const;
+    bool loadData(const std::string &fileName);
+    /* Экспорт полей построенной диаграммы в файлы NumPy .npy (см. NpyWriter): prefix_stablest.npy (тип наиболее
+     * устойчивой фазы, uint8), prefix_phases.npy (набор типов устойчивых фаз, бит k - фаза k + 1, uint8),
+     * prefix_phi.npy, prefix_eta1.npy и prefix_eta2.npy (потенциал и компоненты параметра порядка наиболее
+     * устойчивой фазы, float64, NaN - нет устойчивых фаз) - массивы height x width, строка 0 - наибольшее Альфа1;
+     * prefix_beta1.npy и prefix_alpha1.npy - значения Бета1 по столбцам и Альфа1 по строкам.
+     * Данные записываются по одному столбцу. В режиме сжатого хранения потенциал и параметр порядка
+     * внутри областей восстанавливаются приближённо (см. CompressedDiagram).
+     * Возвращает false в случае ошибки.
+     */
+    bool exportFields(const std::string &prefix) const;
+    /* Рассчитывает столбцы first..first + count - 1 в columns без определения фазовых переходов
+     * (используется вычислительными процессами распределённого расчёта)
+     */
+    void calculateColumns(std::size_t first, std::size_t count, std::vector<std::vector<DiagramPoint>> &columns);
+    /* Повторно определяет фазовые переходы первого рода по критерию criterion(ключ точки, ключ соседа)
+     * без пересчёта точек (см. TransitionStencil) и обновляет статистику.
+     * По умолчанию используется критерий calculate().
+     */
+    template<class Criterion = TransitionStencil::FirstOrder>
+    void detectTransitions(Criterion criterion = Criterion());
+};
+
+
+template<class Criterion>
+void DiagramEngine::markTransitions(Criterion criterion)
+{
+    MetricsTimer timer(current.transitionTime);
+    stencil.run(criterion, [this](std::size_t i, const TransitionStencil::Key *flags) {setTransitions(i, flags);});
+}
+
+
+template<class Criterion>
+void DiagramEngine::detectTransitions(Criterion criterion)
+{
+    markTransitions(criterion);
+    computeStatistics();
+    publishMetrics();
+}
+
+#endif // DIAGRAMENGINE_H
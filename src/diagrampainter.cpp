@@ -0,0 +1,151 @@
+#include <QPainter>
+#include <QPen>
+#include <QPoint>
+#include <QPolygonF>
+#include <algorithm>
+#include <bitset>
+#include "diagrampainter.h"
+
+
+const QRgb DiagramPainter::colors[20] {0xffffff, 0x008000, 0x000080, 0xff7f00, 0x800080, 0xffff00, 0x5959ab, 0x5c3317,
+                                       0x800000, 0x70db93, 0x4d4dff, 0x97694f, 0xff1cae, 0x99cc32, 0x80aead, 0xff0000,
+                                       0xc0d9d9, 0x38b0de, 0xd8bfd8, 0x00ffff};
+
+const QRgb DiagramPainter::minimaColors[DiagramStatistics::maxMinima + 1] {0xffffff, 0xc6dbef, 0x9ecae1, 0x6baed6,
+                                                                            0x3182bd, 0x08519c, 0x08306b};
+
+
+DiagramCurves::DiagramCurves()
+    : transitionsTraced(false), spinodalsTraced(false)
+{
+
+}
+
+
+void DiagramCurves::trace(const Worker &source, bool withTransitions, bool withSpinodals)
+{
+    if (withTransitions && !transitionsTraced)
+    {
+        transitions = TransitionTracer(source).trace();
+        transitionsTraced = true;
+    }
+    if (withSpinodals && !spinodalsTraced)
+    {
+        spinodals = SpinodalTracer(source).trace();
+        spinodalsTraced = true;
+    }
+}
+
+
+void DiagramCurves::clear()
+{
+    transitionsTraced = spinodalsTraced = false;
+    transitions.clear();
+    spinodals.clear();
+}
+
+
+DiagramPainter::DiagramPainter()
+    : showLines(false), traceLines(false), showIsosym(false), showMostStable(false), showMinima(false), showSpinodals(false)
+{
+
+}
+
+
+void DiagramPainter::prepare(const Worker &source, DiagramCurves &curves) const
+{
+    curves.trace(source, showLines && traceLines, showSpinodals);
+}
+
+
+void DiagramPainter::paint(const Worker &source, const DiagramCurves &curves, QImage &image) const
+{
+    // Положение координатных осей
+    QPoint zero = source.getZeroIndexes();
+    // Назначение цвета каждому пикселу
+    for (int i = 0; i < image.width(); ++i)
+        for (int j = 0; j < image.height(); ++j)
+        {
+            QPoint p(i, j);
+            if (i == zero.x() || j == zero.y())
+                image.setPixel(p, 0x000000);    // Здесь проходит координатная ось
+            else
+                image.setPixel(p, color(source.getDiagramPoint(p)));
+        }
+    // Уточнённые линии переходов и спинодали рисуются поверх областей
+    if (showLines && traceLines)
+        paintLines(source, curves.transitions, image);
+    if (showSpinodals)
+        paintSpinodals(source, curves.spinodals, image);
+}
+
+
+QRgb DiagramPainter::color(const DiagramPoint &point) const
+{
+    // Количество устойчивых фаз каждого типа (изосимметрийные модификации)
+    unsigned counts[5] {};
+    for (const PhaseInfo &item : point.phases)
+        ++counts[item.type];
+    if (showIsosym)
+        for (unsigned k = 4; k >= 2; --k)
+            if (counts[k] > 1)
+                // Требуется показывать области сосуществования изосимметрийных фаз
+                // и в данной точке диаграммы такие фазы сосуществуют
+                return colors[k + 14];
+    if (showLines && !traceLines && point.transition)
+        // Требуется показывать линии первородных фазовых переходов
+        // и данная точка диаграммы принадлежит такой линии
+        return colors[19];
+    if (showMinima)
+        // Карта метастабильности: число локальных минимумов (устойчивых фаз) в точке
+        return minimaColors[std::min<std::size_t>(point.phases.size(), DiagramStatistics::maxMinima)];
+    // Ничего необычного нет, нужно просто отобразить самую устойчивую фазу или набор всех устойчивых фаз
+    std::bitset<4> bs;
+    if (showMostStable)
+    {
+        // Установка в bs бита, соответствующего номеру наиболее устойчивой фазы
+        if (point.stablest != -1)
+            bs.set(point.phases[point.stablest].type - 1);
+    }
+    else
+        // Установка в bs битов, соответствующих устойчивым фазам
+        for (unsigned k = 1; k <= 4; ++k)
+            if (counts[k])
+                bs.set(k - 1);
+    return colors[bs.to_ulong()];
+}
+
+
+void DiagramPainter::paintLines(const Worker &source, const std::vector<TransitionLine> &lines, QImage &image) const
+{
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(QColor(colors[19]));
+    for (const TransitionLine &line : lines)
+        painter.drawPolyline(polyline(source, line));
+}
+
+
+void DiagramPainter::paintSpinodals(const Worker &source, const std::vector<SpinodalLine> &lines, QImage &image) const
+{
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    for (const SpinodalLine &line : lines)
+    {
+        painter.setPen(QPen(QColor(colors[1u << (line.type - 1)]), 1.0, Qt::DashLine));
+        painter.drawPolyline(polyline(source, line));
+    }
+}
+
+
+QPolygonF DiagramPainter::polyline(const Worker &source, const TracedLine &line)
+{
+    // Центр пиксела (i, j) - точка (i + 0.5, j + 0.5), строка j = 0 - наибольшее Альфа1
+    const Coefficients c = source.getCoefficients();
+    const QPointF steps = source.getSteps();
+    const int height = source.getSize().height();
+    QPolygonF res;
+    for (const QPointF &point : line.points)
+        res << QPointF((point.x() - c.b[0]) / steps.x() + 0.5, height - 0.5 - (point.y() - c.a[0]) / steps.y());
+    return res;
+}
@@ -0,0 +1,63 @@
+#ifndef DIAGRAMPAINTER_H
+#define DIAGRAMPAINTER_H
+
+#include <QImage>
+#include <QPolygonF>
+#include "worker.h"
+#include "transitiontracer.h"
+#include "spinodaltracer.h"
+
+/* Уточнённые линии переходов первого рода (TransitionTracer) и спинодали (SpinodalTracer) построенной диаграммы.
+ * Трассировка много дороже рисования, поэтому линии строятся один раз после расчёта диаграммы
+ * (в потоке расчёта, см. DiagramPainter::prepare()), а при каждой перерисовке используются готовые.
+ */
+struct DiagramCurves
+{
+    bool transitionsTraced;                 // Линии переходов построены
+    bool spinodalsTraced;                   // Спинодали построены
+    std::vector<TransitionLine> transitions;
+    std::vector<SpinodalLine> spinodals;
+    DiagramCurves();
+    // Строит ещё не построенные линии диаграммы source: линии переходов (withTransitions) и спинодали (withSpinodals)
+    void trace(const Worker &source, bool withTransitions, bool withSpinodals);
+    // Забывает построенные линии (диаграмма пересчитана или загружена)
+    void clear();
+};
+
+
+/* Рисование построенной диаграммы.
+ * Используется главным окном и при экспорте, чтобы цветовая схема везде была одинаковой.
+ */
+
+class DiagramPainter
+{
+public:
+    // Цвета для обозначения областей на диаграмме
+    static const QRgb colors[20];
+    // Цвета карты метастабильности по числу локальных минимумов потенциала
+    static const QRgb minimaColors[DiagramStatistics::maxMinima + 1];
+    bool showLines;         // Показывать линии фазовых переходов первого рода
+    bool traceLines;        // Уточнять линии переходов (TransitionTracer) и рисовать их ломаными вместо точек сетки
+    bool showIsosym;        // Показывать области с изосимметрийными низкосимметричными фазами
+    bool showMostStable;    // Показывать только наиболее стабильную фазу (иначе - наборы всех стабильных фаз)
+    bool showMinima;        // Показывать число локальных минимумов потенциала (карта метастабильности) вместо фаз
+    bool showSpinodals;     // Показывать спинодали (SpinodalTracer)
+    DiagramPainter();
+    // Строит линии диаграммы source, нужные для рисования с текущими настройками, если они ещё не построены
+    void prepare(const Worker &source, DiagramCurves &curves) const;
+    /* Рисует диаграмму, построенную объектом source, на image (размеры должны совпадать).
+     * Уточнённые линии и спинодали берутся из curves (см. prepare()), сами линии здесь не строятся.
+     */
+    void paint(const Worker &source, const DiagramCurves &curves, QImage &image) const;
+    // Возвращает цвет точки диаграммы (без координатных осей и уточнённых линий)
+    QRgb color(const DiagramPoint &point) const;
+    // Рисует уточнённые линии переходов диаграммы source поверх image
+    void paintLines(const Worker &source, const std::vector<TransitionLine> &lines, QImage &image) const;
+    // Рисует спинодали диаграммы source поверх image (штриховой линией цвета области фазы)
+    void paintSpinodals(const Worker &source, const std::vector<SpinodalLine> &lines, QImage &image) const;
+private:
+    // Вершины линии в координатах изображения
+    static QPolygonF polyline(const Worker &source, const TracedLine &line);
+};
+
+#endif // DIAGRAMPAINTER_H
@@ -0,0 +1,24 @@
+#ifndef DIAGRAMPOINT_H
+#define DIAGRAMPOINT_H
+
+#include <cstddef>
+#include <vector>
+
+// Информация о фазе
+struct PhaseInfo
+{
+    unsigned type;  // Тип (от 1 до 4)
+    double phi;     // Потенциал
+    double n[2];    // Параметр порядка
+};
+
+// Точка фазовой диаграммы
+struct DiagramPoint
+{
+    double x, y;                    // Коэффициенты Альфа1 (у) и Бета1 (х)
+    bool transition;                // Признак первородного фазового перехода
+    std::ptrdiff_t stablest;        // Индекс наиболее устойчивой фазы в векторе phases
+    std::vector<PhaseInfo> phases;  // Все устойчивые фазы
+};
+
+#endif // DIAGRAMPOINT_H
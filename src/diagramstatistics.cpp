@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include "diagramstatistics.h"
+
+
+namespace
+{
+    // Набор типов устойчивых фаз в точке
+    std::bitset<4> phaseSet(const DiagramPoint &point)
+    {
+        std::bitset<4> bs;
+        for (const PhaseInfo &item : point.phases)
+            bs.set(item.type - 1);
+        return bs;
+    }
+
+    // Признак перехода первого рода между соседними точками: тот же набор из нескольких фаз, но другая наиболее устойчивая
+    bool isCrossing(const DiagramPoint &first, std::bitset<4> firstSet, const DiagramPoint &second, std::bitset<4> secondSet)
+    {
+        return firstSet.count() > 1 && firstSet == secondSet && first.stablest != second.stablest;
+    }
+}
+
+
+DiagramStatistics::DiagramStatistics()
+{
+    reset(0.0, 0.0);
+}
+
+
+void DiagramStatistics::reset(double stepX, double stepY)
+{
+    points = transitions = crossingsX = crossingsY = 0;
+    std::fill(std::begin(stablest), std::end(stablest), 0);
+    std::fill(std::begin(combinations), std::end(combinations), 0);
+    std::fill(std::begin(isosymmetric), std::end(isosymmetric), 0);
+    std::fill(std::begin(minima), std::end(minima), 0);
+    dX = stepX;
+    dY = stepY;
+}
+
+
+void DiagramStatistics::addColumn(const std::vector<DiagramPoint> &column, const std::vector<DiagramPoint> *previous)
+{
+    std::bitset<4> above;
+    for (std::size_t j = 0; j < column.size(); ++j)
+    {
+        const DiagramPoint &point = column[j];
+        std::bitset<4> bs = phaseSet(point);
+        ++points;
+        ++combinations[bs.to_ulong()];
+        ++stablest[point.stablest == -1 ? 0 : point.phases[point.stablest].type];
+        ++minima[std::min<std::size_t>(point.phases.size(), maxMinima)];
+        unsigned counts[5] {};
+        for (const PhaseInfo &item : point.phases)
+            ++counts[item.type];
+        for (unsigned k = 2; k <= 4; ++k)
+            if (counts[k] > 1)
+                ++isosymmetric[k];
+        if (point.transition)
+            ++transitions;
+        if (previous && isCrossing(point, bs, (*previous)[j], phaseSet((*previous)[j])))
+            ++crossingsX;
+        if (j && isCrossing(point, bs, column[j - 1], above))
+            ++crossingsY;
+        above = bs;
+    }
+}
+
+
+DiagramStatistics &DiagramStatistics::operator+=(const DiagramStatistics &other)
+{
+    points += other.points;
+    for (unsigned k = 0; k < 5; ++k)
+    {
+        stablest[k] += other.stablest[k];
+        isosymmetric[k] += other.isosymmetric[k];
+    }
+    for (unsigned k = 0; k < 16; ++k)
+        combinations[k] += other.combinations[k];
+    for (unsigned k = 0; k <= maxMinima; ++k)
+        minima[k] += other.minima[k];
+    transitions += other.transitions;
+    crossingsX += other.crossingsX;
+    crossingsY += other.crossingsY;
+    return *this;
+}
+
+
+double DiagramStatistics::fraction(std::uint64_t count) const
+{
+    return points ? static_cast<double>(count) / points : 0.0;
+}
+
+
+double DiagramStatistics::area(std::uint64_t count) const
+{
+    return count * std::fabs(dX * dY);
+}
+
+
+double DiagramStatistics::transitionLength() const
+{
+    return std::atan(1.0) * (crossingsX * std::fabs(dX) + crossingsY * std::fabs(dY));
+}
@@ -0,0 +1,47 @@
+#ifndef DIAGRAMSTATISTICS_H
+#define DIAGRAMSTATISTICS_H
+
+#include <cstdint>
+#include <vector>
+#include "diagrampoint.h"
+
+/* Статистика фазовой диаграммы: доли и площади областей (в единицах Бета1 х Альфа1)
+ * по типу наиболее устойчивой фазы, по набору устойчивых фаз (номер набора - std::bitset<4>,
+ * как в DiagramPainter), по областям сосуществования изосимметрийных модификаций фаз
+ * и по числу локальных минимумов (карта метастабильности), а также длина линий фазовых переходов первого рода.
+ * Статистика накапливается по столбцам, частичные результаты складываются оператором +=,
+ * поэтому её можно считать параллельно по полосам столбцов.
+ */
+
+struct DiagramStatistics
+{
+    static constexpr unsigned maxMinima = 6;   // Наибольшее различаемое число локальных минимумов
+    std::uint64_t points;           // Число учтённых точек
+    std::uint64_t stablest[5];      // По типу наиболее устойчивой фазы (0 - нет устойчивых фаз)
+    std::uint64_t combinations[16]; // По набору устойчивых фаз (бит k - фаза k + 1)
+    std::uint64_t isosymmetric[5];  // Точки сосуществования изосимметрийных модификаций фазы k (k = 2..4)
+    std::uint64_t minima[maxMinima + 1];    // По числу локальных минимумов (устойчивых фаз), последний - maxMinima и более
+    std::uint64_t transitions;      // Точки линий фазовых переходов первого рода
+    /* Число пересечений линий переходов отрезками между соседними точками по Бета1 (crossingsX)
+     * и по Альфа1 (crossingsY) - по тому же признаку, что и TransitionStencil::FirstOrder
+     */
+    std::uint64_t crossingsX, crossingsY;
+    double dX, dY;                  // Шаги по Бета1 и Альфа1
+
+    DiagramStatistics();
+    // Обнуление с заданием шагов
+    void reset(double stepX, double stepY);
+    // Учитывает столбец column; previous - предыдущий столбец (nullptr для первого столбца диаграммы)
+    void addColumn(const std::vector<DiagramPoint> &column, const std::vector<DiagramPoint> *previous);
+    // Сложение частичных результатов (шаги должны совпадать)
+    DiagramStatistics &operator+=(const DiagramStatistics &other);
+    // Доля и площадь области из count точек
+    double fraction(std::uint64_t count) const;
+    double area(std::uint64_t count) const;
+    /* Длина линий переходов первого рода (в единицах Бета1 и Альфа1), оценённая по числу пересечений
+     * с сеткой (формула Коши-Крофтона): L = pi / 4 * (crossingsX * dX + crossingsY * dY)
+     */
+    double transitionLength() const;
+};
+
+#endif // DIAGRAMSTATISTICS_H
@@ -0,0 +1,84 @@
+#include <QtWidgets>
+#include <limits>
+#include "ensembledialog.h"
+
+
+// Номера коэффициентов Альфа2..Альфа4, Бета2, Дельта1..Дельта3 в Coefficients::c (Альфа1 и Бета1 - оси диаграммы)
+static const unsigned ensembleIndexes[7] {1, 2, 3, 5, 6, 7, 8};
+
+
+EnsembleDialog::EnsembleDialog(QWidget *parent)
+    : QDialog(parent)
+{
+    const QString names[7] {"\u03B12", "\u03B13", "\u03B14", "\u03B22", "\u03B41", "\u03B42", "\u03B43"};
+
+    cmbKind = new QComboBox;
+    cmbKind->addItem("Нормальное (погрешность - стандартное отклонение)");
+    cmbKind->addItem("Равномерное (погрешность - полуширина интервала)");
+
+    QFormLayout *lytForm = new QFormLayout;
+    lytForm->addRow("Распределение", cmbKind);
+    for (int k = 0; k < 7; ++k)
+    {
+        spbWidths[k] = new QDoubleSpinBox;
+        spbWidths[k]->setRange(0, 1000);
+        spbWidths[k]->setDecimals(4);
+        spbWidths[k]->setSingleStep(0.01);
+        lytForm->addRow(QString("Погрешность %1").arg(names[k]), spbWidths[k]);
+    }
+
+    spbMembers = new QSpinBox;
+    spbMembers->setRange(2, 1000000);
+    spbMembers->setValue(1000);
+    spbSize = new QSpinBox;
+    spbSize->setRange(10, 2000);
+    spbSize->setValue(200);
+    spbSeed = new QSpinBox;
+    spbSeed->setRange(0, std::numeric_limits<int>::max());
+    spbSeed->setValue(1);
+    lytForm->addRow("Число членов ансамбля", spbMembers);
+    lytForm->addRow("Размер диаграммы", spbSize);
+    lytForm->addRow("Начальное значение генератора", spbSeed);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+
+    QVBoxLayout *lytVBox = new QVBoxLayout;
+    lytVBox->addLayout(lytForm);
+    lytVBox->addWidget(buttons);
+    setLayout(lytVBox);
+
+    setWindowTitle("Ансамбль диаграмм (погрешности коэффициентов)");
+}
+
+
+std::array<CoefficientDistribution, 9> EnsembleDialog::distributions() const
+{
+    std::array<CoefficientDistribution, 9> res;
+    res.fill({CoefficientDistribution::Fixed, 0.0});
+    CoefficientDistribution::Kind kind = cmbKind->currentIndex() ? CoefficientDistribution::Uniform
+                                                                 : CoefficientDistribution::Normal;
+    for (int k = 0; k < 7; ++k)
+        if (spbWidths[k]->value() > 0)
+            res[ensembleIndexes[k]] = {kind, spbWidths[k]->value()};
+    return res;
+}
+
+
+unsigned EnsembleDialog::members() const
+{
+    return spbMembers->value();
+}
+
+
+QSize EnsembleDialog::diagramSize() const
+{
+    return QSize(spbSize->value(), spbSize->value());
+}
+
+
+unsigned EnsembleDialog::seed() const
+{
+    return spbSeed->value();
+}
@@ -0,0 +1,32 @@
+#ifndef ENSEMBLEDIALOG_H
+#define ENSEMBLEDIALOG_H
+
+#include <QDialog>
+#include "phaseensemble.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QDoubleSpinBox;
+class QSpinBox;
+QT_END_NAMESPACE
+
+// Диалог задания параметров ансамбля диаграмм (погрешности коэффициентов, число членов, размер диаграммы)
+
+class EnsembleDialog : public QDialog
+{
+private:
+    QComboBox *cmbKind;             // Вид распределения коэффициентов
+    QDoubleSpinBox *spbWidths[7];   // Погрешности Альфа2..Альфа4, Бета2, Дельта1..Дельта3
+    QSpinBox *spbMembers;           // Число членов ансамбля
+    QSpinBox *spbSize;              // Размер диаграммы (число точек по каждой оси)
+    QSpinBox *spbSeed;              // Начальное значение генератора случайных чисел
+public:
+    EnsembleDialog(QWidget *parent = 0);
+    // Распределения коэффициентов Coefficients::c (нулевая погрешность - коэффициент не меняется)
+    std::array<CoefficientDistribution, 9> distributions() const;
+    unsigned members() const;
+    QSize diagramSize() const;
+    unsigned seed() const;
+};
+
+#endif // ENSEMBLEDIALOG_H
@@ -0,0 +1,111 @@
+#include <QtWidgets>
+#include <cmath>
+#include "ensembleviewer.h"
+#include "diagrampainter.h"
+
+
+EnsembleViewer::EnsembleViewer(const PhaseEnsemble &phaseEnsemble, QWidget *parent)
+    : QDialog(parent), ensemble(phaseEnsemble)
+{
+    cmbMap = new QComboBox;
+    cmbMap->addItem("Наиболее вероятная фаза");
+    cmbMap->addItem("Вероятность: нет устойчивых фаз");
+    for (unsigned type = 1; type < PhaseEnsemble::typesCount; ++type)
+        cmbMap->addItem(QString("Вероятность фазы %1").arg(type));
+    cmbMap->addItem("Энтропия");
+    connect(cmbMap, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this]() {showMap();});
+
+    lblImage = new QLabel;
+    lblImage->setFixedSize(viewSize, viewSize);
+
+    // Средняя по диаграмме энтропия - общая мера неопределённости
+    double mean = 0.0;
+    for (std::size_t i = 0; i < ensemble.getWidth(); ++i)
+        for (std::size_t j = 0; j < ensemble.getHeight(); ++j)
+            mean += ensemble.entropy(i, j);
+    mean /= std::max<std::size_t>(1, ensemble.getWidth() * ensemble.getHeight());
+    QLabel *lblInfo = new QLabel(QString("Членов ансамбля: %1, средняя энтропия: %2 бит\n"
+                                         "Энтропия: белый - 0 бит (фаза определена), чёрный - %3 бит")
+                                 .arg(ensemble.getMembers()).arg(mean, 0, 'f', 3)
+                                 .arg(std::log2(PhaseEnsemble::typesCount), 0, 'f', 2));
+
+    QPushButton *btnSave = new QPushButton("Сохранить &изображение...");
+    QPushButton *btnExport = new QPushButton("&Экспорт в NumPy (.npy)...");
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    buttons->addButton(btnSave, QDialogButtonBox::ActionRole);
+    buttons->addButton(btnExport, QDialogButtonBox::ActionRole);
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(btnSave, &QPushButton::clicked, [this]() {saveImage();});
+    connect(btnExport, &QPushButton::clicked, [this]() {exportFields();});
+
+    QFormLayout *lytForm = new QFormLayout;
+    lytForm->addRow("Карта", cmbMap);
+
+    QVBoxLayout *lytVBox = new QVBoxLayout;
+    lytVBox->addLayout(lytForm);
+    lytVBox->addWidget(lblImage);
+    lytVBox->addWidget(lblInfo);
+    lytVBox->addWidget(buttons);
+    setLayout(lytVBox);
+
+    setWindowTitle("Ансамбль диаграмм");
+    showMap();
+}
+
+
+QRgb EnsembleViewer::blend(QRgb color, double weight)
+{
+    auto channel = [weight](int value) {return static_cast<int>(std::lround(255 + (value - 255) * weight));};
+    return qRgb(channel(qRed(color)), channel(qGreen(color)), channel(qBlue(color)));
+}
+
+
+void EnsembleViewer::showMap()
+{
+    const std::size_t width = ensemble.getWidth(), height = ensemble.getHeight();
+    const int map = cmbMap->currentIndex();
+    const double maxEntropy = std::log2(PhaseEnsemble::typesCount);
+    image = QImage(width, height, QImage::Format_RGB32);
+    for (std::size_t i = 0; i < width; ++i)
+        for (std::size_t j = 0; j < height; ++j)
+        {
+            QRgb color;
+            if (map == 0)
+            {
+                // Цвет наиболее вероятной фазы, тем бледнее, чем меньше её вероятность
+                unsigned type = ensemble.mostProbable(i, j);
+                color = type ? blend(DiagramPainter::colors[1u << (type - 1)], ensemble.probability(i, j, type))
+                             : DiagramPainter::colors[0];
+            }
+            else if (map <= static_cast<int>(PhaseEnsemble::typesCount))
+            {
+                unsigned type = map - 1;
+                // Для точек без устойчивых фаз белый цвет неразличим, используется чёрный
+                color = blend(type ? DiagramPainter::colors[1u << (type - 1)] : 0x000000, ensemble.probability(i, j, type));
+            }
+            else
+                color = blend(0x000000, ensemble.entropy(i, j) / maxEntropy);
+            image.setPixel(i, j, color);
+        }
+    lblImage->setPixmap(QPixmap::fromImage(image.scaled(viewSize, viewSize)));
+}
+
+
+void EnsembleViewer::saveImage()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Сохранение карты", "", "*.bmp");
+    if (!path.isEmpty() && !image.save(path, "BMP"))
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файл.");
+}
+
+
+void EnsembleViewer::exportFields()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Экспорт в NumPy (.npy)", "", "*.npy");
+    if (path.isEmpty())
+        return;
+    if (path.endsWith(".npy", Qt::CaseInsensitive))
+        path.chop(4);
+    if (!ensemble.exportFields(QDir::toNativeSeparators(path).toLocal8Bit().constData()))
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файлы.");
+}
@@ -0,0 +1,39 @@
+#ifndef ENSEMBLEVIEWER_H
+#define ENSEMBLEVIEWER_H
+
+#include <QDialog>
+#include <QImage>
+#include "phaseensemble.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+QT_END_NAMESPACE
+
+/* Просмотр карт ансамбля диаграмм (PhaseEnsemble): наиболее вероятная фаза (насыщенность цвета - вероятность),
+ * вероятность каждого типа наиболее устойчивой фазы и энтропия распределения типов (неопределённость диаграммы).
+ * Цвета фаз - как в главном окне (DiagramPainter::colors).
+ */
+
+class EnsembleViewer : public QDialog
+{
+private:
+    // Размер изображения карты на экране
+    static constexpr int viewSize = 500;
+    const PhaseEnsemble &ensemble;
+    QComboBox *cmbMap;      // Вид карты
+    QLabel *lblImage;       // Изображение карты
+    QImage image;           // Карта в разрешении ансамбля
+    // Рисует выбранную карту
+    void showMap();
+    // Смешивает белый цвет с цветом color в пропорции weight (0 - белый, 1 - color)
+    static QRgb blend(QRgb color, double weight);
+    // Сохраняет изображение карты
+    void saveImage();
+    // Экспорт вероятностей и энтропии в файлы NumPy (см. PhaseEnsemble::exportFields())
+    void exportFields();
+public:
+    EnsembleViewer(const PhaseEnsemble &phaseEnsemble, QWidget *parent = 0);
+};
+
+#endif // ENSEMBLEVIEWER_H
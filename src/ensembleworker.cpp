@@ -0,0 +1,21 @@
+#include "ensembleworker.h"
+
+
+EnsembleWorker::EnsembleWorker(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+
+void EnsembleWorker::progress(int percent)
+{
+    emit processed(percent);
+}
+
+
+void EnsembleWorker::calculate()
+{
+    PhaseEnsemble::calculate();
+    emit finished();
+}
@@ -0,0 +1,27 @@
+#ifndef ENSEMBLEWORKER_H
+#define ENSEMBLEWORKER_H
+
+#include <QObject>
+#include "phaseensemble.h"
+
+// Расчёт ансамбля диаграмм (PhaseEnsemble) в отдельном потоке с сигналами о ходе расчёта
+
+class EnsembleWorker : public QObject, public PhaseEnsemble
+{
+    Q_OBJECT
+protected:
+    // Посылает сигнал processed()
+    void progress(int percent) override;
+public:
+    EnsembleWorker(QObject *parent = 0);
+public slots:
+    // Запуск расчёта; по завершении (в том числе после cancel()) посылается сигнал finished()
+    void calculate();
+signals:
+    // Сигнал о завершении работы
+    void finished();
+    // Сигнал о расчёте percent % членов ансамбля
+    void processed(int percent);
+};
+
+#endif // ENSEMBLEWORKER_H
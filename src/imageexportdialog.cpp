@@ -0,0 +1,69 @@
+#include <QtWidgets>
+#include "imageexportdialog.h"
+
+
+ImageExportDialog::ImageExportDialog(const QSize &initialSize, QWidget *parent)
+    : QDialog(parent)
+{
+    spbWidth = new QSpinBox;
+    spbHeight = new QSpinBox;
+    for (QSpinBox *spb : {spbWidth, spbHeight})
+        spb->setRange(16, 100000);
+    spbWidth->setValue(initialSize.width());
+    spbHeight->setValue(initialSize.height());
+
+    // Выбор файла
+    edtFile = new QLineEdit;
+    QPushButton *btnBrowse = new QPushButton("...");
+    connect(btnBrowse, &QPushButton::clicked, [this]()
+    {
+        QString path = QFileDialog::getSaveFileName(this, "Экспорт изображения", edtFile->text(),
+                                                    "PNG (*.png);;TIFF (*.tif *.tiff)");
+        if (!path.isEmpty())
+            edtFile->setText(path);
+    });
+    QHBoxLayout *lytFile = new QHBoxLayout;
+    lytFile->addWidget(edtFile);
+    lytFile->addWidget(btnBrowse);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+
+    QFormLayout *lytForm = new QFormLayout;
+    lytForm->addRow("Ширина, пикселов", spbWidth);
+    lytForm->addRow("Высота, пикселов", spbHeight);
+    lytForm->addRow("Файл", lytFile);
+
+    // Изображение записывается полосами без сжатия (см. StripImageWriter)
+    QLabel *lblNote = new QLabel("PNG и TIFF записываются без сжатия: около 3 байт на пиксел,\n"
+                                 "т. е. немного больше, чем BMP того же размера.");
+    lblNote->setWordWrap(true);
+
+    QVBoxLayout *lytVBox = new QVBoxLayout;
+    lytVBox->addLayout(lytForm);
+    lytVBox->addWidget(lblNote);
+    lytVBox->addWidget(buttons);
+    setLayout(lytVBox);
+
+    setWindowTitle("Экспорт изображения");
+}
+
+
+QSize ImageExportDialog::imageSize() const
+{
+    return QSize(spbWidth->value(), spbHeight->value());
+}
+
+
+QString ImageExportDialog::fileName() const
+{
+    return edtFile->text();
+}
+
+
+bool ImageExportDialog::isTiff() const
+{
+    QString suffix = QFileInfo(edtFile->text()).suffix().toLower();
+    return suffix == "tif" || suffix == "tiff";
+}
@@ -0,0 +1,28 @@
+#ifndef IMAGEEXPORTDIALOG_H
+#define IMAGEEXPORTDIALOG_H
+
+#include <QDialog>
+#include <QSize>
+
+QT_BEGIN_NAMESPACE
+class QLineEdit;
+class QSpinBox;
+QT_END_NAMESPACE
+
+// Диалог задания параметров экспорта изображения (размер и файл PNG или TIFF)
+
+class ImageExportDialog : public QDialog
+{
+private:
+    QSpinBox *spbWidth;         // Ширина изображения
+    QSpinBox *spbHeight;        // Высота изображения
+    QLineEdit *edtFile;         // Имя файла
+public:
+    ImageExportDialog(const QSize &initialSize, QWidget *parent = 0);
+    QSize imageSize() const;
+    QString fileName() const;
+    // Возвращает true, если выбран формат TIFF (по расширению файла)
+    bool isTiff() const;
+};
+
+#endif // IMAGEEXPORTDIALOG_H
@@ -0,0 +1,115 @@
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <algorithm>
+#include <memory>
+#include "imageexporter.h"
+
+
+namespace
+{
+    // Worker для расчёта полосы: прерывает расчёт полосы, когда прерван экспорт (проверка после каждого столбца)
+    class StripWorker : public Worker
+    {
+    private:
+        const std::atomic<bool> &stop;
+    protected:
+        void progress(int percent) override
+        {
+            if (stop)
+                cancel();
+            Worker::progress(percent);
+        }
+    public:
+        StripWorker(QSize size, const std::atomic<bool> &flag)
+            : Worker(size), stop(flag)
+        {
+
+        }
+    };
+}
+
+
+ImageExporter::ImageExporter(QObject *parent)
+    : QObject(parent), cancelled(false)
+{
+
+}
+
+
+void ImageExporter::setParameters(const Coefficients coefficients, const double stepX, const double stepY, const QSize imageSize,
+                                  const QString &path, const StripImageWriter::Format imageFormat, const DiagramPainter &diagramPainter)
+{
+    coeffs = coefficients;
+    dX = stepX;
+    dY = stepY;
+    size = imageSize;
+    fileName = path;
+    format = imageFormat;
+    painter = diagramPainter;
+}
+
+
+void ImageExporter::cancel()
+{
+    cancelled = true;
+}
+
+
+void ImageExporter::run()
+{
+    cancelled = false;
+    StripImageWriter writer;
+    if (!writer.open(QDir::toNativeSeparators(fileName).toLocal8Bit().constData(), format, size.width(), size.height()))
+    {
+        emit finished(false);
+        return;
+    }
+
+    /* Полосы рассчитываются сверху вниз. Каждая полоса (кроме первой) рассчитывается вместе с последней строкой
+     * предыдущей, чтобы линии фазовых переходов на границах полос определялись так же, как внутри.
+     */
+    const int stripRows = std::max(1, std::min(size.height(), stripPoints / size.width()));
+    std::unique_ptr<Worker> worker;
+    QSize workerSize;
+    std::vector<std::uint32_t> pixels;
+    bool ok = true;
+    for (int top = 0; top < size.height() && ok && !cancelled; top += stripRows)
+    {
+        const int rows = std::min(stripRows, size.height() - top);
+        const int halo = top ? 1 : 0;
+        const QSize stripSize(size.width(), rows + halo);
+        // Объект Worker используется повторно для всех полос одинакового размера
+        if (!worker || workerSize != stripSize)
+        {
+            worker.reset(new StripWorker(stripSize, cancelled));
+            workerSize = stripSize;
+        }
+
+        // Альфа1 в нижней строке полосы
+        Coefficients c = coeffs;
+        c.a[0] = coeffs.a[0] + (size.height() - top - rows) * dY;
+        worker->setParameters(c, dX, dY);
+        worker->calculate();
+        if (worker->isCancelled())
+            break;
+
+        // Уточнённые линии полосы строятся один раз - здесь же, в потоке экспорта
+        DiagramCurves curves;
+        painter.prepare(*worker, curves);
+        QImage image(stripSize, QImage::Format_RGB32);
+        painter.paint(*worker, curves, image);
+        pixels.resize(static_cast<std::size_t>(rows) * size.width());
+        for (int j = 0; j < rows; ++j)
+        {
+            const QRgb *line = reinterpret_cast<const QRgb*>(image.constScanLine(j + halo));
+            std::copy(line, line + size.width(), pixels.begin() + static_cast<std::size_t>(j) * size.width());
+        }
+        ok = writer.writeRows(pixels.data(), rows);
+        emit processed(100 * (top + rows) / size.height());
+    }
+    ok = writer.close() && ok && !cancelled;
+    if (!ok)
+        QFile::remove(fileName);
+    emit finished(ok);
+}
@@ -0,0 +1,50 @@
+#ifndef IMAGEEXPORTER_H
+#define IMAGEEXPORTER_H
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include "worker.h"
+#include "diagrampainter.h"
+#include "stripimagewriter.h"
+
+/* Экспорт диаграммы в изображение произвольного размера, не зависящего от размера на экране.
+ * Диаграмма заново рассчитывается полосами строк (объектом Worker) и сразу записывается в файл,
+ * поэтому в памяти находится только одна полоса. Работает в отдельном потоке;
+ * cancel() прерывает и расчёт текущей полосы.
+ */
+
+class ImageExporter : public QObject
+{
+    Q_OBJECT
+private:
+    // Количество точек в одной полосе
+    static constexpr int stripPoints = 1 << 18;
+    Coefficients coeffs;        // Коэффициенты (Альфа1 и Бета1 - значения в левом нижнем углу)
+    double dX, dY;              // Шаги по Бета1 и Альфа1
+    QSize size;                 // Размер изображения
+    QString fileName;
+    StripImageWriter::Format format;
+    DiagramPainter painter;     // Параметры отображения
+    std::atomic<bool> cancelled;
+public:
+    ImageExporter(QObject *parent = 0);
+    /* Установка параметров. Функция должна быть вызвана перед вызовом run().
+     * coefficients, stepX и stepY - как при расчёте обычной диаграммы размером imageSize.
+     */
+    void setParameters(const Coefficients coefficients, const double stepX, const double stepY, const QSize imageSize,
+                       const QString &path, const StripImageWriter::Format imageFormat, const DiagramPainter &diagramPainter);
+    // Прерывает экспорт (может вызываться из любого потока)
+    void cancel();
+public slots:
+    // Запуск экспорта
+    void run();
+signals:
+    // Сигнал о записи percent % строк
+    void processed(int percent);
+    // Сигнал о завершении работы (success = false, если экспорт прерван или не удалось записать файл)
+    void finished(bool success);
+};
+
+#endif // IMAGEEXPORTER_H
@@ -0,0 +1,214 @@
+#ifndef LANDAUPOTENTIAL_H
+#define LANDAUPOTENTIAL_H
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include "polynomial.h"
+
+/* Символьное представление модельного потенциала как суммы мономов от двух переменных x и y.
+ * Список мономов задаётся на этапе компиляции, производные любого порядка строятся из него
+ * также на этапе компиляции (constexpr), а вычисление потенциала и производных разворачивается
+ * в линейный код без циклов и копирования коэффициентов.
+ * Коэффициенты мономов - коэффициенты потенциала из Coefficients::c (номер задаётся PotentialCoefficient),
+ * умноженные на целое число. Для добавления в потенциал нового слагаемого достаточно добавить моном в список.
+ */
+
+// Номера коэффициентов потенциала в массиве Coefficients::c
+enum PotentialCoefficient : unsigned {Alpha1, Alpha2, Alpha3, Alpha4, Beta1, Beta2, Delta1, Delta2, Delta3};
+
+// Моном factor * c[coefficient] * x^x * y^y
+struct Monomial
+{
+    int factor;
+    unsigned coefficient;
+    unsigned x, y;
+};
+
+
+// Число мономов, не обращающихся в ноль при дифференцировании dx раз по x и dy раз по y
+template<std::size_t N>
+constexpr std::size_t derivativeSize(const std::array<Monomial, N> &terms, unsigned dx, unsigned dy)
+{
+    std::size_t size = 0;
+    for (const Monomial &term : terms)
+        if (term.x >= dx && term.y >= dy)
+            ++size;
+    return size;
+}
+
+
+// Мономы производной (Size - результат derivativeSize())
+template<std::size_t Size, std::size_t N>
+constexpr std::array<Monomial, Size> derivativeTerms(const std::array<Monomial, N> &terms, unsigned dx, unsigned dy)
+{
+    std::array<Monomial, Size> res {};
+    std::size_t size = 0;
+    for (const Monomial &term : terms)
+        if (term.x >= dx && term.y >= dy)
+        {
+            Monomial d = term;
+            for (unsigned i = 0; i < dx; ++i)
+                d.factor *= d.x--;
+            for (unsigned i = 0; i < dy; ++i)
+                d.factor *= d.y--;
+            res[size++] = d;
+        }
+    return res;
+}
+
+
+// Степень x^N, развёрнутая в произведение
+template<unsigned N, class T>
+inline T power(const T &x)
+{
+    if constexpr (N == 0)
+        return static_cast<T>(1);
+    else if constexpr (N == 1)
+        return x;
+    else
+        return power<N / 2>(x) * power<N - N / 2>(x);
+}
+
+
+/* Потенциал (при DX = DY = 0) или его производная порядка DX по x и DY по y.
+ * Source - класс со статическим constexpr массивом мономов terms.
+ */
+template<class Source, unsigned DX = 0, unsigned DY = 0>
+class LandauPotential
+{
+public:
+    static constexpr std::size_t size = derivativeSize(Source::terms, DX, DY);
+    static constexpr std::array<Monomial, size> terms = derivativeTerms<size>(Source::terms, DX, DY);
+    // Производная данной функции
+    template<unsigned X, unsigned Y>
+    using Derivative = LandauPotential<Source, DX + X, DY + Y>;
+    // Значение в точке (x, y) при коэффициентах c, вычисленное в типе T
+    template<class T>
+    static T value(const double *c, const T &x, const T &y)
+    {
+        return sum(c, x, y, std::make_index_sequence<size>());
+    }
+    // Производная по коэффициенту c[coefficient] в точке (x, y) (от значений коэффициентов не зависит)
+    template<class T>
+    static T coefficientDerivative(unsigned coefficient, const T &x, const T &y)
+    {
+        return coefficientSum(coefficient, x, y, std::make_index_sequence<size>());
+    }
+    /* Коэффициент при y^Y как полином от x, делённый на x^Shift
+     * (например, уравнение состояния для фаз с y = 0: Derivative<1, 0>::row<0, 1>()).
+     */
+    template<unsigned Y, unsigned Shift = 0>
+    static Polynomial row(const double *c)
+    {
+        static_assert(rowLowDegree(Y) >= Shift, "row() is not divisible by x^Shift");
+        Polynomial res(rowDegree(Y) - Shift);
+        addToRow<Y, Shift>(c, res, std::make_index_sequence<size>());
+        return res;
+    }
+private:
+    template<std::size_t I, class T>
+    static T term(const double *c, const T &x, const T &y)
+    {
+        constexpr Monomial m = terms[I];
+        return static_cast<T>(m.factor) * static_cast<T>(c[m.coefficient]) * power<m.x>(x) * power<m.y>(y);
+    }
+    template<class T, std::size_t... I>
+    static T sum(const double *c, const T &x, const T &y, std::index_sequence<I...>)
+    {
+        return (static_cast<T>(0) + ... + term<I>(c, x, y));
+    }
+    template<std::size_t I, class T>
+    static T coefficientTerm(unsigned coefficient, const T &x, const T &y)
+    {
+        constexpr Monomial m = terms[I];
+        return m.coefficient == coefficient ? static_cast<T>(m.factor) * power<m.x>(x) * power<m.y>(y) : static_cast<T>(0);
+    }
+    template<class T, std::size_t... I>
+    static T coefficientSum(unsigned coefficient, const T &x, const T &y, std::index_sequence<I...>)
+    {
+        return (static_cast<T>(0) + ... + coefficientTerm<I>(coefficient, x, y));
+    }
+    template<unsigned Y, unsigned Shift, std::size_t I>
+    static void addTerm(const double *c, Polynomial &p)
+    {
+        constexpr Monomial m = terms[I];
+        if constexpr (m.y == Y)
+            p[m.x - Shift] += m.factor * c[m.coefficient];
+    }
+    template<unsigned Y, unsigned Shift, std::size_t... I>
+    static void addToRow(const double *c, Polynomial &p, std::index_sequence<I...>)
+    {
+        (addTerm<Y, Shift, I>(c, p), ...);
+    }
+    // Наибольшая и наименьшая степени x среди мономов при y^Y
+    static constexpr unsigned rowDegree(unsigned y)
+    {
+        unsigned res = 0;
+        for (const Monomial &term : terms)
+            if (term.y == y && term.x > res)
+                res = term.x;
+        return res;
+    }
+    static constexpr unsigned rowLowDegree(unsigned y)
+    {
+        unsigned res = ~0u;
+        for (const Monomial &term : terms)
+            if (term.y == y && term.x < res)
+                res = term.x;
+        return res;
+    }
+};
+
+
+/* Потенциал как функция компонент параметра порядка x = N[0], y = N[1]:
+ * a[3] * y^8 + (a[2] - 3*d[1]*x + (9*d[2] + 4*a[3])*x^2) * y^6 + ... + (a[3] + d[2]) * x^8.
+ */
+struct PotentialNTerms
+{
+    static constexpr std::array<Monomial, 30> terms {{
+        {1, Alpha4, 0, 8},
+        {1, Alpha3, 0, 6}, {-3, Delta2, 1, 6}, {9, Delta3, 2, 6}, {4, Alpha4, 2, 6},
+        {1, Alpha2, 0, 4}, {-3, Delta1, 1, 4}, {3, Alpha3, 2, 4}, {9, Beta2, 2, 4}, {-5, Delta2, 3, 4},
+        {6, Alpha4, 4, 4}, {3, Delta3, 4, 4},
+        {1, Alpha1, 0, 2}, {-3, Beta1, 1, 2}, {2, Alpha2, 2, 2}, {-2, Delta1, 3, 2}, {3, Alpha3, 4, 2},
+        {-6, Beta2, 4, 2}, {-1, Delta2, 5, 2}, {4, Alpha4, 6, 2}, {-5, Delta3, 6, 2},
+        {1, Alpha1, 2, 0}, {1, Beta1, 3, 0}, {1, Alpha2, 4, 0}, {1, Delta1, 5, 0}, {1, Alpha3, 6, 0},
+        {1, Beta2, 6, 0}, {1, Delta2, 7, 0}, {1, Alpha4, 8, 0}, {1, Delta3, 8, 0}
+    }};
+};
+
+/* Потенциал фазы 4 как функция инвариантов x = I[0], y = I[1]:
+ * (b[1] + d[2]*x) * y^2 + (b[0] + d[0]*x + d[1]*x^2) * y + a[0]*x + a[1]*x^2 + a[2]*x^3 + a[3]*x^4.
+ */
+struct PotentialITerms
+{
+    static constexpr std::array<Monomial, 9> terms {{
+        {1, Beta2, 0, 2}, {1, Delta3, 1, 2},
+        {1, Beta1, 0, 1}, {1, Delta1, 1, 1}, {1, Delta2, 2, 1},
+        {1, Alpha1, 1, 0}, {1, Alpha2, 2, 0}, {1, Alpha3, 3, 0}, {1, Alpha4, 4, 0}
+    }};
+};
+
+/* Потенциал как функция x = N[0] и y = N[1]^2 (все степени N[1] в PotentialNTerms чётные).
+ * Уравнения состояния в этих переменных не имеют решений с N[1] = 0, ответвляющихся от фаз 2 и 3.
+ */
+template<std::size_t N>
+constexpr std::array<Monomial, N> squaredTerms(const std::array<Monomial, N> &terms)
+{
+    std::array<Monomial, N> res = terms;
+    for (Monomial &term : res)
+        term.y /= 2;
+    return res;
+}
+
+struct PotentialSTerms
+{
+    static constexpr std::array<Monomial, PotentialNTerms::terms.size()> terms = squaredTerms(PotentialNTerms::terms);
+};
+
+typedef LandauPotential<PotentialNTerms> PotentialN;
+typedef LandauPotential<PotentialITerms> PotentialI;
+typedef LandauPotential<PotentialSTerms> PotentialS;
+
+#endif // LANDAUPOTENTIAL_H
@@ -1,8 +1,18 @@
 #include "mainwindow.h"
+#include "tilefarm.h"
 #include <QApplication>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    // Вычислительный процесс распределённого расчёта (запускается координатором, см. TileFarm)
+    for (int i = 1; i < argc; ++i)
+        if (!std::strcmp(argv[i], "--tile-worker"))
+        {
+            QCoreApplication a(argc, argv);
+            return TileFarm::serve(a.arguments());
+        }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
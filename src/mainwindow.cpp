@@ -1,4 +1,10 @@
 #include "mainwindow.h"
+#include "sweepdialog.h"
+#include "imageexportdialog.h"
+#include "multicriticallocator.h"
+#include "volumeviewer.h"
+#include "ensembledialog.h"
+#include "ensembleviewer.h"
 #include <QtWidgets>
 #include <bitset>
 #include <functional>
@@ -7,8 +13,13 @@
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
       diagramSize(QSize(500, 500)),
+      previewSize(QSize(128, 128)),
       imgDiagram(QImage(diagramSize, QImage::Format_RGB32)),
+      imgPreview(QImage(previewSize, QImage::Format_RGB32)),
       worker(diagramSize),
+      previewWorker(previewSize),
+      restartPending(false),
+      previewPending(false),
       settings("Mukovnin", "PhaseDiagram")
 {
     phasesInfoDialog = new PhasesInfoDialog(this);
@@ -25,6 +36,9 @@ MainWindow::MainWindow(QWidget *parent)
     if (QFile::exists(path))
         gnuplotFileName = path;
 
+    // Число вычислительных процессов распределённого расчёта
+    processCount = settings.value("processes", 0).toUInt();
+
     // Создание элементов главного окна
     createMenu();
     createOptionsBox();
@@ -42,8 +56,10 @@ MainWindow::MainWindow(QWidget *parent)
 
     prbProgress = new QProgressBar;
     lblCursorPos = new QLabel;
+    lblMetrics = new QLabel;
     lblStatus = new QLabel("Введите параметры и нажмите кнопку \"Применить\".");
     statusBar()->addWidget(lblStatus);
+    statusBar()->addPermanentWidget(lblMetrics);
 
     setWindowTitle("Модельный термодинамический потенциал с симметрией 3m");
 
@@ -65,12 +81,20 @@ MainWindow::MainWindow(QWidget *parent)
      */
     connect(&thread, SIGNAL(started()), this, SLOT(threadStarted()));
     connect(&thread, SIGNAL(started()), &worker, SLOT(calculate()));
+    // После расчёта в том же потоке строятся уточнённые линии (worker находится в потоке thread)
+    connect(&thread, &QThread::started, &worker, [this]() {
+        if (!worker.isCancelled())
+            curvesPainter.prepare(worker, curves);
+    });
     connect(&thread, SIGNAL(finished()), this, SLOT(threadFinished()));
     connect(&worker, SIGNAL(processed(int)), prbProgress, SLOT(setValue(int)));
+    connect(&worker, SIGNAL(processed(int)), this, SLOT(updateMetrics()));
     connect(&worker, SIGNAL(finished()), &thread, SLOT(quit()));
     connect(btnStart, SIGNAL(clicked()), this, SLOT(start()));
     // Диаграмма перерисовывается, если пользователь изменил настройки её отображения в меню.
     connect(actShowLines, SIGNAL(triggered(bool)), this, SLOT(drawDiagram()));
+    connect(actTraceLines, SIGNAL(triggered(bool)), this, SLOT(drawDiagram()));
+    connect(actShowSpinodals, SIGNAL(triggered(bool)), this, SLOT(drawDiagram()));
     connect(actShowIsosym, SIGNAL(triggered(bool)), this, SLOT(drawDiagram()));
     connect(actionGroup, SIGNAL(triggered(QAction*)), this, SLOT(drawDiagram()));
     /* Выбор любого пункта меню "Графики -> Показать график зависимости..." запускает слот showSurface(),
@@ -78,11 +102,83 @@ MainWindow::MainWindow(QWidget *parent)
      */
     for (QAction* action: actShowGraph)
         connect(action, SIGNAL(triggered(bool)), this, SLOT(showSurface()));
+    /* Предварительный просмотр.
+     * Пока пользователь перетаскивает ползунок, previewWorker в отдельном потоке строит диаграмму низкого разрешения.
+     * Если значения изменились до окончания расчёта, он прерывается и запускается заново с последними значениями,
+     * устаревшие запросы не накапливаются. После отпускания ползунка запускается полный расчёт.
+     */
+    previewWorker.moveToThread(&previewThread);
+    connect(&previewThread, SIGNAL(started()), &previewWorker, SLOT(calculate()));
+    connect(&previewThread, &QThread::started, &previewWorker, [this]() {
+        if (!previewWorker.isCancelled())
+            previewCurvesPainter.prepare(previewWorker, previewCurves);
+    });
+    connect(&previewThread, SIGNAL(finished()), this, SLOT(previewThreadFinished()));
+    connect(&previewWorker, SIGNAL(finished()), &previewThread, SLOT(quit()));
+    for (QSlider *slider : sldValues)
+    {
+        connect(slider, SIGNAL(valueChanged(int)), this, SLOT(sliderValueChanged(int)));
+        connect(slider, SIGNAL(sliderReleased()), this, SLOT(sliderReleased()));
+    }
+    connect(tblValues, SIGNAL(itemChanged(QTableWidgetItem*)), this, SLOT(syncSlider(QTableWidgetItem*)));
+    // Экспорт анимации выполняется в отдельном потоке, который сам распределяет расчёт кадров по ядрам
+    prdExport = new QProgressDialog("Экспорт анимации...", "Отмена", 0, 100, this);
+    prdExport->setWindowModality(Qt::NonModal);
+    prdExport->reset();
+    exporter.moveToThread(&exporterThread);
+    connect(&exporterThread, SIGNAL(started()), &exporter, SLOT(run()));
+    connect(&exporter, SIGNAL(processed(int)), prdExport, SLOT(setValue(int)));
+    connect(&exporter, SIGNAL(finished(bool)), this, SLOT(exportFinished(bool)));
+    connect(&exporter, SIGNAL(finished(bool)), &exporterThread, SLOT(quit()));
+    connect(prdExport, &QProgressDialog::canceled, [this]() {exporter.cancel();});
+    // Экспорт изображения высокого разрешения также выполняется в отдельном потоке, не блокируя интерфейс
+    prdImageExport = new QProgressDialog("Экспорт изображения...", "Отмена", 0, 100, this);
+    prdImageExport->setWindowModality(Qt::NonModal);
+    prdImageExport->reset();
+    imageExporter.moveToThread(&imageExporterThread);
+    connect(&imageExporterThread, SIGNAL(started()), &imageExporter, SLOT(run()));
+    connect(&imageExporter, SIGNAL(processed(int)), prdImageExport, SLOT(setValue(int)));
+    connect(&imageExporter, SIGNAL(finished(bool)), this, SLOT(exportImageFinished(bool)));
+    connect(&imageExporter, SIGNAL(finished(bool)), &imageExporterThread, SLOT(quit()));
+    connect(prdImageExport, &QProgressDialog::canceled, [this]() {imageExporter.cancel();});
+    // Трёхмерная диаграмма строится в отдельном потоке, который сам распределяет слои по ядрам
+    prdVolume = new QProgressDialog("Построение трёхмерной диаграммы...", "Отмена", 0, 100, this);
+    prdVolume->setWindowModality(Qt::NonModal);
+    prdVolume->reset();
+    volume.moveToThread(&volumeThread);
+    connect(&volumeThread, SIGNAL(started()), &volume, SLOT(calculate()));
+    connect(&volume, SIGNAL(processed(int)), prdVolume, SLOT(setValue(int)));
+    connect(&volume, SIGNAL(finished()), this, SLOT(volumeFinished()));
+    connect(&volume, SIGNAL(finished()), &volumeThread, SLOT(quit()));
+    connect(prdVolume, &QProgressDialog::canceled, [this]() {volume.cancel();});
+    // Ансамбль диаграмм также рассчитывается в отдельном потоке, распределяющем члены ансамбля по ядрам
+    prdEnsemble = new QProgressDialog("Расчёт ансамбля диаграмм...", "Отмена", 0, 100, this);
+    prdEnsemble->setWindowModality(Qt::NonModal);
+    prdEnsemble->reset();
+    ensemble.moveToThread(&ensembleThread);
+    connect(&ensembleThread, SIGNAL(started()), &ensemble, SLOT(calculate()));
+    connect(&ensemble, SIGNAL(processed(int)), prdEnsemble, SLOT(setValue(int)));
+    connect(&ensemble, SIGNAL(finished()), this, SLOT(ensembleFinished()));
+    connect(&ensemble, SIGNAL(finished()), &ensembleThread, SLOT(quit()));
+    connect(prdEnsemble, &QProgressDialog::canceled, [this]() {ensemble.cancel();});
 }
 
 
 MainWindow::~MainWindow()
 {
+    // Остановка расчётов перед уничтожением объектов
+    worker.cancel();
+    previewWorker.cancel();
+    exporter.cancel();
+    imageExporter.cancel();
+    volume.cancel();
+    ensemble.cancel();
+    thread.wait();
+    previewThread.wait();
+    exporterThread.wait();
+    imageExporterThread.wait();
+    volumeThread.wait();
+    ensembleThread.wait();
     // Сохранение пути к исполняемому файлу gnuplot
     if (!gnuplotFileName.isEmpty())
         settings.setValue("gnuplot", gnuplotFileName);
@@ -94,6 +190,13 @@ void MainWindow::createMenu()
     // Меню "Файл"
     QMenu *fileMenu = new QMenu("&Файл");
     actSave = fileMenu->addAction("&Сохранить диаграмму в файл...", this, SLOT(save()), Qt::CTRL | Qt::Key_S);
+    actExportImage = fileMenu->addAction("Экспорт &изображения высокого разрешения...", this, SLOT(exportImage()));
+    actExportSweep = fileMenu->addAction("&Экспорт анимации...", this, SLOT(exportSweep()));
+    fileMenu->addSeparator();
+    fileMenu->addAction("&Открыть данные диаграммы...", this, SLOT(loadData()), Qt::CTRL | Qt::Key_O);
+    actSaveData = fileMenu->addAction("Сохранить &данные диаграммы...", this, SLOT(saveData()));
+    actSaveLines = fileMenu->addAction("Сохранить &линии переходов первого рода и спинодали...", this, SLOT(saveLines()));
+    actExportFields = fileMenu->addAction("Экспорт &полей в формате NumPy (.npy)...", this, SLOT(exportFields()));
     fileMenu->addSeparator();
     fileMenu->addAction("&Выход", this, SLOT(close()));
     menuBar()->addMenu(fileMenu);
@@ -109,14 +212,26 @@ void MainWindow::createMenu()
     for (int i = 0; i < 3; ++i)
         actShowGraph[i] = graphsMenu->addAction
                 (QString("График зависимости %1 от \u03B11 и \u03B21").arg(names[i]));
+    graphsMenu->addSeparator();
+    actLocate = graphsMenu->addAction("&Найти тройные точки и концы линий переходов первого рода...",
+                                      this, SLOT(locateMulticritical()));
+    actVolume = graphsMenu->addAction("&Трёхмерная диаграмма по третьему коэффициенту...", this, SLOT(buildVolume()));
+    actEnsemble = graphsMenu->addAction("&Ансамбль диаграмм по погрешностям коэффициентов...", this, SLOT(buildEnsemble()));
     menuBar()->addMenu(graphsMenu);
 
     // Меню "Параметры"
     QMenu *optionsMenu = new QMenu("&Параметры");
     actShowLines = optionsMenu->addAction("&Показывать линии фазовых переходов первого рода");
     actShowLines->setCheckable(true);
+    actTraceLines = optionsMenu->addAction("&Уточнять линии фазовых переходов первого рода");
+    actTraceLines->setCheckable(true);
+    actShowSpinodals = optionsMenu->addAction("Показывать с&пинодали (границы метастабильности фаз)");
+    actShowSpinodals->setCheckable(true);
     actShowIsosym = optionsMenu->addAction("П&оказывать области сосуществования изосимметрийных модификаций фаз 2 и 3");
     actShowIsosym->setCheckable(true);
+    actCompressed = optionsMenu->addAction("&Сжатое хранение данных (для диаграмм большого размера)");
+    actCompressed->setCheckable(true);
+    optionsMenu->addAction("&Число вычислительных процессов...", this, SLOT(setProcessCount()));
     menuBar()->addMenu(optionsMenu);
 
     // Подменю "Режим отображения фаз"
@@ -127,9 +242,12 @@ void MainWindow::createMenu()
     actShowAllStable->setChecked(true);
     actShowMostStable = viewModeMenu->addAction("П&оказывать только наиболее устойчивую фазу");
     actShowMostStable->setCheckable(true);
+    actShowMinima = viewModeMenu->addAction("Показывать &число локальных минимумов (карта метастабильности)");
+    actShowMinima->setCheckable(true);
     actionGroup = new QActionGroup(this);
     actionGroup->addAction(actShowAllStable);
     actionGroup->addAction(actShowMostStable);
+    actionGroup->addAction(actShowMinima);
 
     // Меню "Справка"
     QMenu *helpMenu = new QMenu("&Справка");
@@ -144,7 +262,7 @@ void MainWindow::createOptionsBox()
     // Настройка таблиц для ввода диапазонов Альфа1 и Бета1 и значений прочих коэффициентов
 
     tblValues = new QTableWidget;
-    tblValues->setColumnCount(1);
+    tblValues->setColumnCount(2);
     tblValues->setRowCount(7);
     tblValues->verticalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     tblValues->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
@@ -162,7 +280,7 @@ void MainWindow::createOptionsBox()
     tblValues->setVerticalHeaderLabels(lst);
 
     lst.clear();
-    lst << "Значение";
+    lst << "Значение" << "Регулятор";
     tblValues->setHorizontalHeaderLabels(lst);
 
     lst.clear();
@@ -181,7 +299,14 @@ void MainWindow::createOptionsBox()
 
     int arr[7] {1, 1, 0, 1, 1, 0, 0};
     for (int i = 0; i < 7; ++i)
+    {
         tblValues->setItem(i, 0, new QTableWidgetItem(QString("%1").arg(arr[i])));
+        // Ползунок позволяет менять значение в диапазоне -10..10 с шагом sliderStep
+        sldValues[i] = new QSlider(Qt::Horizontal);
+        sldValues[i]->setRange(qRound(-10 / sliderStep), qRound(10 / sliderStep));
+        sldValues[i]->setValue(qRound(arr[i] / sliderStep));
+        tblValues->setCellWidget(i, 1, sldValues[i]);
+    }
 
     btnStart = new QPushButton("Применить");
     btnStart->setDefault(true);
@@ -214,15 +339,25 @@ void MainWindow::createDiagramBox()
 }
 
 
+// Наборы фаз в порядке следования в легенде: установленный i-й бит означает присутствие i-й фазы
+static const unsigned legendSets[16] {0b0001, 0b0010, 0b0100, 0b1000, 0b0011, 0b0101, 0b1001, 0b0110,
+                                      0b1010, 0b1100, 0b0111, 0b1011, 0b1101, 0b1110, 0b1111, 0b0000};
+
+
+// Заливка метки обозначения цветом
+static void setLabelColor(QLabel *label, const QColor &color)
+{
+    QPalette pal = label->palette();
+    pal.setColor(label->backgroundRole(), color);
+    label->setPalette(pal);
+}
+
+
 void MainWindow::createLegendBox()
 {
     gbLegend = new QGroupBox("Обозначения на диаграмме");
     QGridLayout *lytGrid = new QGridLayout;
 
-    // Установленный i-й бит означает присутствие i-й фазы
-    const unsigned arr[16] {0b0001, 0b0010, 0b0100, 0b1000, 0b0011, 0b0101, 0b1001, 0b0110,
-                            0b1010, 0b1100, 0b0111, 0b1011, 0b1101, 0b1110, 0b1111, 0b0000};
-
     // Построение легенды
     for (int i = 0; i < 20; ++i)
     {
@@ -230,7 +365,7 @@ void MainWindow::createLegendBox()
         QString s;
         if (i < 16)
         {
-            std::bitset<4> bs(arr[i]);
+            std::bitset<4> bs(legendSets[i]);
             int count = bs.count();
             s = count == 0 ? "Нет устойч. фаз" : count > 1 ? "Фазы" : "Фаза";
             for (size_t j = 0; j < 4; ++j)
@@ -245,20 +380,22 @@ void MainWindow::createLegendBox()
         }
 
         // Определение цвета
-        QColor color = i < 16 ? QColor(colors[arr[i]]) : QColor(colors[i]);
+        QColor color = i < 16 ? QColor(DiagramPainter::colors[legendSets[i]]) : QColor(DiagramPainter::colors[i]);
 
         // Отображение цвета
         QLabel *lblColor = new QLabel;
         lblColor->setMinimumWidth(120);
         lblColor->setMaximumHeight(15);
-        QPalette pal = lblColor->palette();
-        pal.setColor(lblColor->backgroundRole(), color);
-        lblColor->setPalette(pal);
+        setLabelColor(lblColor, color);
         lblColor->setAutoFillBackground(true);
+        lblLegendColor[i] = lblColor;
+        legendColors[i] = color;
 
         // Отображение подписи
         QLabel *lblText = new QLabel(s);
         lblText->setAlignment(Qt::AlignCenter);
+        lblLegend[i] = lblText;
+        legendCaptions[i] = s;
 
         QVBoxLayout *lytVBox = new QVBoxLayout;
         lytVBox->addWidget(lblColor, 0, Qt::AlignHCenter);
@@ -271,6 +408,67 @@ void MainWindow::createLegendBox()
 }
 
 
+void MainWindow::updateLegend(const Worker *source)
+{
+    DiagramStatistics st;
+    if (source)
+        st = source->getStatistics();
+    bool mostStable = actShowMostStable->isChecked(), minimaMap = actShowMinima->isChecked();
+    const int maxMinima = DiagramStatistics::maxMinima;
+    for (int i = 0; i < 20; ++i)
+    {
+        // На карте метастабильности первые обозначения - число локальных минимумов, остальные скрыты
+        bool minima = minimaMap && i <= maxMinima;
+        lblLegend[i]->setVisible(!minimaMap || minima);
+        lblLegendColor[i]->setVisible(!minimaMap || minima);
+        setLabelColor(lblLegendColor[i], minima ? QColor(DiagramPainter::minimaColors[i]) : legendColors[i]);
+        QString s = !minima ? legendCaptions[i] :
+                    i < maxMinima ? QString("Минимумов: %1").arg(i) : QString("Минимумов: %1 и более").arg(i);
+        if (source)
+        {
+            // Число точек области: при показе только наиболее устойчивой фазы наборы из нескольких фаз не отображаются
+            std::uint64_t count;
+            if (minima)
+                count = st.minima[i];
+            else if (i < 16)
+            {
+                std::bitset<4> bs(legendSets[i]);
+                if (!mostStable)
+                    count = st.combinations[legendSets[i]];
+                else if (bs.count() > 1)
+                    count = 0;
+                else
+                {
+                    // Тип единственной фазы набора (0 - нет устойчивых фаз)
+                    unsigned type = 0;
+                    for (unsigned k = 0; k < 4; ++k)
+                        if (bs.test(k))
+                            type = k + 1;
+                    count = st.stablest[type];
+                }
+            }
+            else if (i < 19)
+                count = st.isosymmetric[i - 14];
+            else
+                count = st.transitions;
+            if (minima || i < 19)
+            {
+                s += QString("\n%1 %").arg(100.0 * st.fraction(count), 0, 'f', 1);
+                lblLegend[i]->setToolTip(QString("Площадь: %1").arg(st.area(count), 0, 'g', 4));
+            }
+            else
+            {
+                s += QString("\nL = %1").arg(st.transitionLength(), 0, 'g', 4);
+                lblLegend[i]->setToolTip("Длина линий фазовых переходов первого рода в единицах \u03B21 и \u03B11");
+            }
+        }
+        else
+            lblLegend[i]->setToolTip(QString());
+        lblLegend[i]->setText(s);
+    }
+}
+
+
 bool MainWindow::eventFilter(QObject *pobj, QEvent *pe)
 {
     if (pobj == lblDiagram && diagramCreated)
@@ -303,13 +501,12 @@ bool MainWindow::eventFilter(QObject *pobj, QEvent *pe)
 }
 
 
-bool MainWindow::setWorkerOptions()
+bool MainWindow::getOptions(Coefficients &c, double &sX, double &sY, const QSize &size, bool silent)
 {
     // Проверка данных, введённых пользователем
     bool ok[11];    // Если все ok = true, все текстовые данные удалось преобразовать в числа
     const QString s[11] {"\u03B12", "\u03B13", "\u03B14", "\u03B22", "\u03B41", "\u03B42", "\u03B43",
                          "\u03B11 (min)", "\u03B11 (max)", "\u03B21 (min)", "\u03B21 (max)"};
-    Coefficients c;
 
     c.a[1] = tblValues->item(0, 0)->text().toDouble(&ok[0]);
     c.a[2] = tblValues->item(1, 0)->text().toDouble(&ok[1]);
@@ -319,7 +516,7 @@ bool MainWindow::setWorkerOptions()
     c.d[1] = tblValues->item(5, 0)->text().toDouble(&ok[5]);
     c.d[2] = tblValues->item(6, 0)->text().toDouble(&ok[6]);
 
-    double maxX, sX, maxY, sY;
+    double maxX, maxY;
 
     c.a[0] = tblRanges->item(0, 0)->text().toDouble(&ok[7]);
     maxY = tblRanges->item(0, 1)->text().toDouble(&ok[8]);
@@ -330,93 +527,77 @@ bool MainWindow::setWorkerOptions()
     auto pos = std::find(std::begin(ok), std::end(ok), false);
     if (pos != std::end(ok))
     {
+        if (silent)
+            return false;
         QString msg = QString("Указанное в таблице значение %1 не удалось преобразовать в число.").arg(s[pos - std::begin(ok)]);
         QMessageBox::warning(this, "Ошибка преобразования", msg);
         return false;
     }
 
     // Проверка границ диапазонов
-    sX = (maxX - c.b[0]) / diagramSize.width();
-    sY = (maxY - c.a[0]) / diagramSize.height();
+    sX = (maxX - c.b[0]) / size.width();
+    sY = (maxY - c.a[0]) / size.height();
 
     if (sX <= 0 || sY <= 0)
     {
+        if (silent)
+            return false;
         int i = sX < 0 ? 9 : 7;
         QString msg = QString("В указанных параметрах %1 больше либо равно %2.").arg(s[i]).arg(s[i + 1]);
         QMessageBox::warning(this, "Ошибка диапазона", msg);
         return false;
     }
 
+    return true;
+}
+
+
+bool MainWindow::setWorkerOptions(Worker &target, const QSize &size, bool silent)
+{
+    Coefficients c;
+    double sX, sY;
+    if (!getOptions(c, sX, sY, size, silent))
+        return false;
     // Установка параметров worker'а
-    worker.setParameters(c, sX, sY);
+    target.setParameters(c, sX, sY);
     return true;
 }
 
 
 void MainWindow::drawDiagram()
 {
-    // Рисование диаграммы, если массив с данными готов
+    // Рисование диаграммы, если массив с данными готов (легенда обновляется и без диаграммы - её вид зависит от режима)
     if (!diagramCreated)
+    {
+        updateLegend(nullptr);
         return;
-    // Положение координатных осей
-    QPoint zero = worker.getZeroIndexes();
-    // Назначение цвета каждому пикселу
-    for (int i = 0; i < diagramSize.width(); ++i)
-        for (int j = 0; j < diagramSize.height(); ++j)
-        {
-            QRgb c;
-            QPoint p(i, j);
-            if (i == zero.x() || j == zero.y())
-                c = 0x000000;   // Здесь проходит координатная ось
-            else
-            {
-                bool detected = false;
-                if (actShowIsosym->isChecked())
-                {
-                    for (unsigned k = 2; k <= 4; ++k)
-                        if (worker.getIsosymmetricCount(p, k) > 1)
-                        {
-                            // Пользователь хочет видеть области сосуществования изосимметрийных фаз
-                            // и в данной точке диаграммы такие фазы сосуществуют
-                            c = colors[k + 14];
-                            detected = true;
-                        }
-                }
-                if (!detected)
-                {
-                    if (actShowLines->isChecked() && worker.isTransition(p))
-                        // Пользователь хочет видеть линии первородных фазовых переходов
-                        // и данная точка диаграммы принадлежит такой линии
-                        c = colors[19];
-                    else
-                    {
-                        // Ничего необычного нет, нужно просто отобразить самую устойчивую фазу или набор всех устойчивых фаз
-                        std::bitset<4> bs;
-                        if (actShowMostStable->isChecked())
-                        {
-                            // Установка в bs бита, соответствующего номеру наиболее устойчивой фазы
-                            unsigned stablest = worker.getStablestPhaseType(p);
-                            if (stablest)
-                                bs.set(stablest - 1);
-                        }
-                        else
-                            // Установка в bs битов, соответствующих устойчивым фазам
-                            for (size_t k = 1; k <= 4; ++k)
-                                if (worker.isPhaseStable(p, k))
-                                    bs.set(k - 1);
-                        // Определение цвета
-                        c = colors[bs.to_ulong()];
-                    }
-                }
-            }
-            // Рисование пиксела
-            imgDiagram.setPixel(p, c);
-        }
+    }
+    updateLegend(&worker);
+    // Во время расчёта данные и линии worker'а меняются в его потоке: диаграмма перерисуется в threadFinished()
+    if (thread.isRunning())
+        return;
+    DiagramPainter p = painter();
+    p.prepare(worker, curves);
+    p.paint(worker, curves, imgDiagram);
     // Отображение картинки из imgDiagram на lblDiagram
     lblDiagram->setPixmap(QPixmap::fromImage(imgDiagram));
 }
 
 
+DiagramPainter MainWindow::painter() const
+{
+    // Параметры отображения, выбранные пользователем в меню
+    DiagramPainter p;
+    p.showLines = actShowLines->isChecked();
+    p.traceLines = actTraceLines->isChecked();
+    p.showIsosym = actShowIsosym->isChecked();
+    p.showMostStable = actShowMostStable->isChecked();
+    p.showMinima = actShowMinima->isChecked();
+    p.showSpinodals = actShowSpinodals->isChecked();
+    return p;
+}
+
+
 void MainWindow::showSurface()
 {   
     if (gnuplotFileName.isEmpty())
@@ -507,12 +688,53 @@ void MainWindow::showPotential()
 }
 
 
+void MainWindow::locateMulticritical()
+{
+    if (!diagramCreated || thread.isRunning())
+        return;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    MulticriticalLocator locator(worker);
+    std::vector<MulticriticalPoint> points = locator.locate();
+    QApplication::restoreOverrideCursor();
+    QString text;
+    for (const MulticriticalPoint &point : points)
+    {
+        text += point.kind == MulticriticalPoint::TriplePoint ?
+                    "<b>Тройная точка</b>" : "<b>Конец линии перехода первого рода</b>";
+        text += QString("<br>\u03b1<sub>1</sub> = %1, \u03b2<sub>1</sub> = %2")
+                .arg(QString::number(point.alpha1, 'g', 17), QString::number(point.beta1, 'g', 17));
+        for (std::size_t k = 0; k < point.phases.size(); ++k)
+        {
+            const PhaseInfo &phase = point.phases[k];
+            text += QString("<br>Фаза %1: \u03b7<sub>1</sub> = %2, \u03b7<sub>2</sub> = %3, \u03a6 = %4")
+                    .arg(phase.type)
+                    .arg(QString::number(phase.n[0], 'g', 10), QString::number(phase.n[1], 'g', 10),
+                         QString::number(phase.phi, 'g', 10));
+            if (point.kind == MulticriticalPoint::CriticalEndPoint && k + 1 == point.phases.size())
+                text += " (теряет устойчивость)";
+        }
+        text += "<br><br>";
+    }
+    if (points.empty())
+        text = "Тройные точки и концы линий переходов первого рода не найдены.<br><br>";
+    text += QString("Начальных приближений: %1, итераций метода Ньютона: %2")
+            .arg(locator.seedsCount()).arg(locator.iterationsCount());
+    QMessageBox::information(this, "Мультикритические точки", text);
+}
+
+
 void MainWindow::setDiagramCreated(bool flag)
 {
     diagramCreated = flag;
     actSave->setEnabled(diagramCreated);
+    actSaveData->setEnabled(diagramCreated);
+    actSaveLines->setEnabled(diagramCreated);
+    actExportFields->setEnabled(diagramCreated);
     for (auto action : actShowGraph)
         action->setEnabled(diagramCreated);
+    actLocate->setEnabled(diagramCreated);
+    if (!diagramCreated)
+        updateLegend(nullptr);
 }
 
 
@@ -524,6 +746,238 @@ void MainWindow::save()
 }
 
 
+void MainWindow::exportSweep()
+{
+    if (exporterThread.isRunning())
+        return;
+    SweepDialog dialog(this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    if (dialog.directory().isEmpty() || !QDir(dialog.directory()).exists())
+    {
+        QMessageBox::warning(this, "Экспорт анимации", "Укажите существующий каталог для записи кадров.");
+        return;
+    }
+    Coefficients c;
+    double sX, sY;
+    if (!getOptions(c, sX, sY, diagramSize))
+        return;
+    exporter.setParameters(c, sX, sY, diagramSize, dialog.coefficient(), dialog.from(), dialog.to(), dialog.frames(),
+                           dialog.directory(), painter());
+    actExportSweep->setEnabled(false);
+    prdExport->setValue(0);
+    prdExport->show();
+    exporterThread.start();
+}
+
+
+void MainWindow::exportFinished(bool success)
+{
+    bool canceled = prdExport->wasCanceled();
+    prdExport->reset();
+    actExportSweep->setEnabled(true);
+    if (!success && !canceled)
+        QMessageBox::warning(this, "Экспорт анимации", "Не удалось записать файлы кадров.");
+}
+
+
+void MainWindow::exportImage()
+{
+    if (imageExporterThread.isRunning())
+        return;
+    ImageExportDialog dialog(diagramSize, this);
+    if (dialog.exec() != QDialog::Accepted || dialog.fileName().isEmpty())
+        return;
+    Coefficients c;
+    double sX, sY;
+    // Шаги рассчитываются для заданного размера изображения, диапазоны Альфа1 и Бета1 - из таблицы
+    if (!getOptions(c, sX, sY, dialog.imageSize()))
+        return;
+    imageExporter.setParameters(c, sX, sY, dialog.imageSize(), dialog.fileName(),
+                                dialog.isTiff() ? StripImageWriter::Tiff : StripImageWriter::Png, painter());
+    actExportImage->setEnabled(false);
+    prdImageExport->setValue(0);
+    prdImageExport->show();
+    imageExporterThread.start();
+}
+
+
+void MainWindow::buildVolume()
+{
+    if (volumeThread.isRunning())
+        return;
+    SweepDialog dialog(this, true);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    Coefficients c;
+    double sX, sY;
+    if (!getOptions(c, sX, sY, diagramSize))
+        return;
+    volume.setParameters(c, sX, sY, diagramSize.width(), diagramSize.height(),
+                         dialog.coefficient(), dialog.from(), dialog.to(), dialog.frames());
+    actVolume->setEnabled(false);
+    prdVolume->setValue(0);
+    prdVolume->show();
+    volumeThread.start();
+}
+
+
+void MainWindow::volumeFinished()
+{
+    prdVolume->reset();
+    actVolume->setEnabled(true);
+    if (volume.isComplete())
+        VolumeViewer(volume, painter(), this).exec();
+}
+
+
+void MainWindow::buildEnsemble()
+{
+    if (ensembleThread.isRunning())
+        return;
+    EnsembleDialog dialog(this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    Coefficients c;
+    double sX, sY;
+    // Шаги рассчитываются для размера диаграммы ансамбля, диапазоны Альфа1 и Бета1 - из таблицы
+    if (!getOptions(c, sX, sY, dialog.diagramSize()))
+        return;
+    ensemble.setParameters(c, sX, sY, dialog.diagramSize().width(), dialog.diagramSize().height(),
+                           dialog.distributions(), dialog.members(), dialog.seed());
+    actEnsemble->setEnabled(false);
+    prdEnsemble->setValue(0);
+    prdEnsemble->show();
+    ensembleThread.start();
+}
+
+
+void MainWindow::ensembleFinished()
+{
+    prdEnsemble->reset();
+    actEnsemble->setEnabled(true);
+    if (ensemble.isComplete())
+        EnsembleViewer(ensemble, this).exec();
+}
+
+
+void MainWindow::exportImageFinished(bool success)
+{
+    bool canceled = prdImageExport->wasCanceled();
+    prdImageExport->reset();
+    actExportImage->setEnabled(true);
+    if (!success && !canceled)
+        QMessageBox::warning(this, "Экспорт изображения", "Не удалось записать файл изображения.");
+}
+
+
+void MainWindow::saveData()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Сохранение данных диаграммы", "", "*.pdg");
+    if (!path.isEmpty() && !worker.saveData(QDir::toNativeSeparators(path).toLocal8Bit().constData()))
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файл.");
+}
+
+
+void MainWindow::saveLines()
+{
+    if (!diagramCreated || thread.isRunning())
+        return;
+    QString path = QFileDialog::getSaveFileName(this, "Сохранение линий переходов первого рода и спинодалей", "", "*.txt");
+    if (path.isEmpty())
+        return;
+    /* Формат для gnuplot: каждая линия - отдельный блок строк "Бета1 Альфа1",
+     * в комментарии перед блоком - типы фаз и причины окончания линии
+     */
+    static const char *ends[] {"boundary", "stability_limit", "triple_point", "degenerate", "closed", "stopped"};
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файл.");
+        return;
+    }
+    QTextStream out(&file);
+    curves.trace(worker, true, true);
+    for (const TransitionLine &line : curves.transitions)
+    {
+        out << QString("# phases %1 %2: %3 .. %4\n").arg(line.types[0]).arg(line.types[1])
+               .arg(ends[line.ends[0]], ends[line.ends[1]]);
+        for (const QPointF &point : line.points)
+            out << QString::number(point.x(), 'g', 17) << ' ' << QString::number(point.y(), 'g', 17) << '\n';
+        out << "\n\n";
+    }
+    for (const SpinodalLine &line : curves.spinodals)
+    {
+        out << QString("# spinodal of phase %1: %2 .. %3\n").arg(line.type).arg(ends[line.ends[0]], ends[line.ends[1]]);
+        for (const QPointF &point : line.points)
+            out << QString::number(point.x(), 'g', 17) << ' ' << QString::number(point.y(), 'g', 17) << '\n';
+        out << "\n\n";
+    }
+}
+
+
+void MainWindow::exportFields()
+{
+    if (!diagramCreated || thread.isRunning())
+        return;
+    QString path = QFileDialog::getSaveFileName(this, "Экспорт полей диаграммы", "", "*.npy");
+    if (path.isEmpty())
+        return;
+    // Имя файла без расширения - общий префикс файлов полей (prefix_stablest.npy и т. д.)
+    if (path.endsWith(".npy", Qt::CaseInsensitive))
+        path.chop(4);
+    if (!worker.exportFields(QDir::toNativeSeparators(path).toLocal8Bit().constData()))
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файлы.");
+}
+
+
+void MainWindow::loadData()
+{
+    if (thread.isRunning())
+        return;
+    QString path = QFileDialog::getOpenFileName(this, "Открытие данных диаграммы", "", "*.pdg");
+    if (path.isEmpty())
+        return;
+    if (!worker.loadData(QDir::toNativeSeparators(path).toLocal8Bit().constData()))
+    {
+        setDiagramCreated(false);
+        QMessageBox::warning(this, "Ошибка", "Не удалось прочитать файл или размер диаграммы в нём не совпадает с текущим.");
+        return;
+    }
+    curves.clear();
+    // Отображение загруженных коэффициентов и диапазонов в таблицах
+    Coefficients c = worker.getCoefficients();
+    QPointF steps = worker.getSteps();
+    const int indexes[7] {1, 2, 3, 5, 6, 7, 8};
+    for (int i = 0; i < 7; ++i)
+        tblValues->item(i, 0)->setText(QString("%1").arg(c.c[indexes[i]]));
+    tblRanges->item(0, 0)->setText(QString("%1").arg(c.a[0]));
+    tblRanges->item(0, 1)->setText(QString("%1").arg(c.a[0] + steps.y() * diagramSize.height()));
+    tblRanges->item(1, 0)->setText(QString("%1").arg(c.b[0]));
+    tblRanges->item(1, 1)->setText(QString("%1").arg(c.b[0] + steps.x() * diagramSize.width()));
+    actCompressed->setChecked(true);
+    setDiagramCreated(true);
+    drawDiagram();
+    lblStatus->setText("Для получения полной информации нажмите левую кнопку мыши в нужной точке диаграммы.");
+    statusBar()->addWidget(lblCursorPos);
+    lblCursorPos->show();
+}
+
+
+void MainWindow::setProcessCount()
+{
+    bool ok;
+    int count = QInputDialog::getInt(this, "Число вычислительных процессов",
+                                     "Число процессов для расчёта диаграммы (0 - расчёт без запуска процессов):",
+                                     processCount, 0, 256, 1, &ok);
+    if (ok)
+    {
+        processCount = count;
+        settings.setValue("processes", processCount);
+    }
+}
+
+
 void MainWindow::setGnuplotPath()
 {
     QString path = QFileDialog::getOpenFileName(this, "Файл gnuplot", "", "");
@@ -534,14 +988,85 @@ void MainWindow::setGnuplotPath()
 
 void MainWindow::start()
 {
-    if (setWorkerOptions())
+    if (thread.isRunning())
     {
+        // Расчёт по устаревшим параметрам прерывается, после его остановки будет запущен новый
+        restartPending = true;
+        worker.cancel();
+        return;
+    }
+    if (setWorkerOptions(worker, diagramSize))
+    {
+        worker.setCompressedStorage(actCompressed->isChecked());
+        worker.setProcessCount(processCount);
+        curves.clear();
+        curvesPainter = painter();
         worker.moveToThread(&thread);
         thread.start();
     }
 }
 
 
+void MainWindow::preview()
+{
+    if (previewThread.isRunning())
+    {
+        // Побеждает последний запрос: текущий расчёт прерывается и перезапускается после остановки
+        previewPending = true;
+        previewWorker.cancel();
+        return;
+    }
+    if (setWorkerOptions(previewWorker, previewSize, true))
+    {
+        previewCurves.clear();
+        previewCurvesPainter = painter();
+        previewThread.start();
+    }
+}
+
+
+void MainWindow::sliderValueChanged(int value)
+{
+    // Определение ползунка, положение которого изменилось
+    auto pos = std::find(std::begin(sldValues), std::end(sldValues), sender());
+    if (pos == std::end(sldValues))
+        return;
+    int row = pos - std::begin(sldValues);
+    tblValues->item(row, 0)->setText(QString("%1").arg(value * sliderStep));
+    // Во время перетаскивания строится диаграмма низкого разрешения, при прочих изменениях - сразу полная
+    if ((*pos)->isSliderDown())
+        preview();
+    else
+        start();
+}
+
+
+void MainWindow::sliderReleased()
+{
+    // Предварительный просмотр больше не нужен
+    previewPending = false;
+    previewWorker.cancel();
+    start();
+}
+
+
+void MainWindow::syncSlider(QTableWidgetItem *item)
+{
+    // Ползунок следует за значением, введённым в таблицу вручную
+    if (item->column() != 0)
+        return;
+    bool ok;
+    double value = item->text().toDouble(&ok);
+    QSlider *slider = sldValues[item->row()];
+    if (ok && qRound(value / sliderStep) != slider->value())
+    {
+        slider->blockSignals(true);
+        slider->setValue(qRound(value / sliderStep));
+        slider->blockSignals(false);
+    }
+}
+
+
 void MainWindow::threadStarted()
 {
     setDiagramCreated(false);
@@ -554,16 +1079,104 @@ void MainWindow::threadStarted()
 
 void MainWindow::threadFinished()
 {
+    if (restartPending)
+    {
+        // Параметры изменились во время расчёта, результат устарел
+        restartPending = false;
+        start();
+        return;
+    }
+    prbProgress->reset();
+    statusBar()->removeWidget(prbProgress);
+    if (worker.isCancelled())
+    {
+        // Диаграмма не построена: индикатор выполнения убирается, строка состояния возвращается к исходной
+        lblStatus->setText("Расчёт прерван. Введите параметры и нажмите кнопку \"Применить\".");
+        return;
+    }
+    updateMetrics();
+    writeMetricsLog();
     setDiagramCreated(true);
     drawDiagram();
-    prbProgress->reset();
     lblStatus->setText("Для получения полной информации нажмите левую кнопку мыши в нужной точке диаграммы.");
-    statusBar()->removeWidget(prbProgress);
     statusBar()->addWidget(lblCursorPos);
     lblCursorPos->show();
 }
 
 
+void MainWindow::updateMetrics()
+{
+    RunMetrics m = worker.getMetrics();
+    // Доли времени, затраченные на отдельные этапы расчёта
+    double total = m.elapsed > 0.0 ? m.elapsed : 1.0;
+    QString s = QString("%1 точек/с, %2 решений/с").arg(m.pointsPerSecond(), 0, 'f', 0).arg(m.solverCallsPerSecond(), 0, 'f', 0);
+    if (thread.isRunning() && m.points < m.totalPoints)
+        s += QString(", осталось %1 с").arg(m.eta(), 0, 'f', 1);
+    else
+        s += QString(", всего %1 с").arg(m.elapsed, 0, 'f', 2);
+    s += QString(" (корни %1%, устойчивость %2%, переходы %3%)")
+            .arg(100 * m.rootTime / total, 0, 'f', 0)
+            .arg(100 * m.stabilityTime / total, 0, 'f', 0)
+            .arg(100 * m.transitionTime / total, 0, 'f', 0);
+    if (m.refinedPoints)
+        s += QString(", уточнено точек: %1").arg(m.refinedPoints);
+    lblMetrics->setText(s);
+}
+
+
+void MainWindow::writeMetricsLog()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (dir.isEmpty() || !QDir().mkpath(dir))
+        return;
+    QFile log(QDir(dir).filePath("metrics.jsonl"));
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return;
+
+    RunMetrics m = worker.getMetrics();
+    Coefficients c = worker.getCoefficients();
+    QJsonArray coefficients;
+    for (double value : c.c)
+        coefficients.append(value);
+    QJsonObject obj;
+    obj["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    obj["width"] = diagramSize.width();
+    obj["height"] = diagramSize.height();
+    obj["coefficients"] = coefficients;
+    obj["points"] = static_cast<double>(m.points);
+    obj["solverCalls"] = static_cast<double>(m.solverCalls);
+    obj["refinedPoints"] = static_cast<double>(m.refinedPoints);
+    obj["elapsed"] = m.elapsed;
+    obj["pointsPerSecond"] = m.pointsPerSecond();
+    obj["solverCallsPerSecond"] = m.solverCallsPerSecond();
+    obj["rootTime"] = m.rootTime;
+    obj["stabilityTime"] = m.stabilityTime;
+    obj["transitionTime"] = m.transitionTime;
+    log.write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n");
+}
+
+
+void MainWindow::previewThreadFinished()
+{
+    if (previewPending)
+    {
+        previewPending = false;
+        preview();
+        return;
+    }
+    // Прерванный расчёт или запущенный полный расчёт делают предварительную диаграмму ненужной
+    if (previewWorker.isCancelled() || thread.isRunning())
+        return;
+    // Построенная ранее диаграмма больше не соответствует коэффициентам
+    setDiagramCreated(false);
+    updateLegend(&previewWorker);
+    DiagramPainter p = painter();
+    p.prepare(previewWorker, previewCurves);
+    p.paint(previewWorker, previewCurves, imgPreview);
+    lblDiagram->setPixmap(QPixmap::fromImage(imgPreview.scaled(diagramSize)));
+}
+
+
 void MainWindow::about()
 {
     QMessageBox::about(this, "О программе",
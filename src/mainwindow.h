@@ -8,6 +8,11 @@
 #include <QTemporaryFile>
 #include "worker.h"
 #include "phasesinfodialog.h"
+#include "diagrampainter.h"
+#include "sweepexporter.h"
+#include "imageexporter.h"
+#include "volumeworker.h"
+#include "ensembleworker.h"
 
 QT_BEGIN_NAMESPACE
 class QAction;
@@ -19,7 +24,10 @@ class QMenu;
 class QMenuBar;
 class QPushButton;
 class QTableWidget;
+class QTableWidgetItem;
 class QProgressBar;
+class QProgressDialog;
+class QSlider;
 class QProcess;
 class QTemporaryFile;
 class QSettings;
@@ -33,38 +41,82 @@ class MainWindow : public QMainWindow
 private:
     // Размер двумерного массива, представляющего диаграмму: инициализируется в конструкторе, по умолчанию 500х500
     const QSize diagramSize;
-    // Цвета для обозначения областей на диаграмме
-    const QRgb colors[20] {0xffffff, 0x008000, 0x000080, 0xff7f00, 0x800080, 0xffff00, 0x5959ab, 0x5c3317,
-                           0x800000, 0x70db93, 0x4d4dff, 0x97694f, 0xff1cae, 0x99cc32, 0x80aead, 0xff0000,
-                           0xc0d9d9, 0x38b0de, 0xd8bfd8, 0x00ffff};
+    // Размер диаграммы предварительного просмотра, строящейся при перетаскивании ползунков
+    const QSize previewSize;
+    // Цена деления ползунков, задающих коэффициенты
+    static constexpr double sliderStep = 0.01;
 
     QAction *actSave;            // Сохранение
+    QAction *actExportSweep;     // Экспорт анимации
+    QAction *actExportImage;     // Экспорт изображения высокого разрешения
+    QAction *actSaveData;        // Сохранение данных диаграммы
+    QAction *actCompressed;      // Сжатое хранение данных диаграммы
     QAction *actShowLines;       // Показ линий первородных фазовых переходов
+    QAction *actTraceLines;      // Уточнение линий фазовых переходов первого рода
+    QAction *actSaveLines;       // Сохранение уточнённых линий фазовых переходов первого рода
+    QAction *actExportFields;    // Экспорт полей диаграммы в файлы NumPy
     QAction *actShowGraph[3];    // Отображение трёхмерных графиков
+    QAction *actLocate;          // Поиск тройных точек и концов линий переходов первого рода
+    QAction *actVolume;          // Построение трёхмерной диаграммы
+    QAction *actEnsemble;        // Расчёт ансамбля диаграмм по погрешностям коэффициентов
     QAction *actShowIsosym;      // Отображение областей с изосимметрийными низкосимметричными фазами
     QAction *actShowMostStable;  // Отображение только наиболее стабильной фазы
     QAction *actShowAllStable;   // Отображение всех стабильных фаз
-    QActionGroup *actionGroup;   // Группа для actShowMostStable и actShowAllStable
+    QAction *actShowMinima;      // Отображение числа локальных минимумов (карта метастабильности)
+    QAction *actShowSpinodals;   // Отображение спинодалей
+    QActionGroup *actionGroup;   // Группа для actShowMostStable, actShowAllStable и actShowMinima
 
     QImage imgDiagram;
+    QImage imgPreview;
     QLabel *lblDiagram;
     QLabel *lblStatus;
     QLabel *lblCursorPos;
+    QLabel *lblMetrics;
     QGroupBox *gbLegend;
+    QLabel *lblLegend[20];       // Подписи обозначений на диаграмме
+    QLabel *lblLegendColor[20];  // Цвета обозначений на диаграмме
+    QString legendCaptions[20];  // Подписи без статистики
+    QColor legendColors[20];     // Цвета обозначений (кроме карты метастабильности)
     QGroupBox *gbOptions;
     QGroupBox *gbDiagram;
     QPushButton *btnStart;
     QTableWidget *tblValues;
+    QSlider *sldValues[7];       // Ползунки для изменения коэффициентов из tblValues
     QTableWidget *tblRanges;
     QProgressBar *prbProgress;
 
     Worker worker;                          // Объект, занимающийся расчётами
     QThread thread;                         // Поток, в котором происходит работа worker'а
+    Worker previewWorker;                   // Объект, строящий диаграмму предварительного просмотра
+    QThread previewThread;                  // Поток, в котором происходит работа previewWorker'а
+    bool restartPending;                    // Нужен перезапуск расчётов worker'а с новыми параметрами
+    bool previewPending;                    // Нужен перезапуск расчётов previewWorker'а с новыми параметрами
+    /* Уточнённые линии диаграмм worker'а и previewWorker'а. Строятся в потоках расчёта сразу после него
+     * с настройками отображения на момент запуска (curvesPainter, previewCurvesPainter);
+     * линии, включённые позже, строятся один раз при перерисовке.
+     */
+    DiagramCurves curves;
+    DiagramCurves previewCurves;
+    DiagramPainter curvesPainter;
+    DiagramPainter previewCurvesPainter;
+    SweepExporter exporter;                 // Объект, выполняющий экспорт анимации
+    QThread exporterThread;                 // Поток, в котором работает exporter
+    QProgressDialog *prdExport;             // Индикатор хода экспорта
+    ImageExporter imageExporter;            // Объект, выполняющий экспорт изображения высокого разрешения
+    QThread imageExporterThread;            // Поток, в котором работает imageExporter
+    QProgressDialog *prdImageExport;        // Индикатор хода экспорта изображения
+    VolumeWorker volume;                    // Объект, строящий трёхмерную диаграмму
+    QThread volumeThread;                   // Поток, в котором работает volume
+    QProgressDialog *prdVolume;             // Индикатор хода построения трёхмерной диаграммы
+    EnsembleWorker ensemble;                // Объект, рассчитывающий ансамбль диаграмм
+    QThread ensembleThread;                 // Поток, в котором работает ensemble
+    QProgressDialog *prdEnsemble;           // Индикатор хода расчёта ансамбля
     PhasesInfoDialog *phasesInfoDialog;     // Диалог с подробной информацией о фазах в данной точке диаграммы
     QProcess gnuplot;                       // Запущенный процесс gnuplot
     QTemporaryFile file;                    // Временный файл для построения графика в gnuplot
     QSettings settings;                     // Сохранение настроек
     QString gnuplotFileName;                // Путь к исполняемому файлу gnuplot
+    unsigned processCount;                  // Число вычислительных процессов распределённого расчёта (0 - без процессов)
 
     // Создание элементов главного окна
     void createMenu();
@@ -74,12 +126,25 @@ private:
 
     // Признак того, что диаграмма построена
     bool diagramCreated;
-    /* Установка параметров worker'а,
-     * вызывается перед запуском расчётов, считывая введённые пользователем в элементах главного окна данные */
-    bool setWorkerOptions();
+    /* Считывает введённые пользователем коэффициенты c и вычисляет шаги sX (Бета1) и sY (Альфа1)
+     * для диаграммы размером size. Возвращает false, если данные некорректны
+     * (при silent = false об этом выводится сообщение). */
+    bool getOptions(Coefficients &c, double &sX, double &sY, const QSize &size, bool silent = false);
+    /* Установка параметров target для построения диаграммы размером size,
+     * вызывается перед запуском расчётов, считывая введённые пользователем в элементах главного окна данные.
+     * Если silent = true, сообщения об ошибках не показываются. */
+    bool setWorkerOptions(Worker &target, const QSize &size, bool silent = false);
+    // Возвращает объект для рисования диаграммы с выбранными в меню параметрами отображения
+    DiagramPainter painter() const;
 
     // Меняет значение флага diagramCreated, управляя доступностью пунктов меню
     void setDiagramCreated(bool flag);
+    /* Дописывает к подписям легенды доли площади обозначенных областей диаграммы, рассчитанной source,
+     * и длину линий переходов первого рода (source = nullptr - только подписи)
+     */
+    void updateLegend(const Worker *source);
+    // Дописывает показатели производительности завершённого расчёта в журнал (по одному объекту JSON в строке)
+    void writeMetricsLog();
 
 protected:
     /* Фильтр событий главного окна:
@@ -92,13 +157,33 @@ private slots:
     void drawDiagram();     // Рисует построенную диаграмму на imgDiagram
     void about();           // Показать диалог "О программе"
     void save();            // Показать диалог сохранения диаграммы
+    void exportSweep();     // Показать диалог экспорта анимации и запустить экспорт
+    void saveData();        // Показать диалог сохранения данных диаграммы
+    void saveLines();       // Показать диалог сохранения уточнённых линий фазовых переходов первого рода
+    void exportFields();    // Показать диалог экспорта полей диаграммы в файлы NumPy (.npy)
+    void loadData();        // Показать диалог открытия сохранённых данных диаграммы
+    void exportFinished(bool success);  // Экспорт анимации завершён
+    void exportImage();     // Показать диалог экспорта изображения высокого разрешения и запустить экспорт
+    void exportImageFinished(bool success);  // Экспорт изображения завершён
     void setGnuplotPath();  // Показать диалог выбора исполняемого файла gnuplot
+    void setProcessCount(); // Показать диалог выбора числа вычислительных процессов
     void showSurface();     // Показать один из трёхмерных графиков
     void showPotential();   // Показать диалог с выражением для потенциала
+    void locateMulticritical();  // Найти тройные точки и концы линий переходов первого рода и показать их
+    void buildVolume();     // Показать диалог параметров трёхмерной диаграммы и запустить её построение
+    void volumeFinished();  // Построение трёхмерной диаграммы завершено
+    void buildEnsemble();   // Показать диалог параметров ансамбля диаграмм и запустить расчёт
+    void ensembleFinished();  // Расчёт ансамбля диаграмм завершён
     void start();           // Нажатие кнопки "Применить" - запуск расчётов, если введённые параметры корректны
+    void preview();         // Запуск расчёта диаграммы предварительного просмотра
+    void sliderValueChanged(int value);                 // Изменилось положение одного из ползунков
+    void sliderReleased();                              // Пользователь отпустил ползунок
+    void syncSlider(QTableWidgetItem *item);            // Установка ползунка по введённому в таблицу значению
+    void updateMetrics();   // Показ скорости расчёта и оставшегося времени в строке состояния
 public slots:    
     void threadStarted();   // Поток с расчётами стартовал
     void threadFinished();  // Поток с расчётами завершился
+    void previewThreadFinished();   // Поток с расчётом диаграммы предварительного просмотра завершился
 
 public:
     MainWindow(QWidget *parent = 0);
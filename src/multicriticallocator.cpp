@@ -0,0 +1,328 @@
+#include <QPoint>
+#include <QSize>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "multicriticallocator.h"
+#include "landaupotential.h"
+#include "phaseequations.h"
+
+
+namespace
+{
+    constexpr double eps = std::numeric_limits<double>::epsilon();
+
+    // Наиболее устойчивая фаза точки (nullptr, если устойчивых фаз нет)
+    const PhaseInfo *stablestPhase(const DiagramPoint &point)
+    {
+        return point.stablest == -1 ? nullptr : &point.phases[point.stablest];
+    }
+
+    unsigned stablestType(const DiagramPoint &point)
+    {
+        return point.stablest == -1 ? 0 : point.phases[point.stablest].type;
+    }
+
+    bool isStable(const DiagramPoint &point, unsigned type)
+    {
+        return std::any_of(point.phases.cbegin(), point.phases.cend(), [type](const PhaseInfo &item) {return item.type == type;});
+    }
+
+    /* Невязка f и якобиан jacobian (по строкам) системы для z = (Альфа1, Бета1, переменные каждой из m фаз),
+     * см. phaseequations.h. Строки 2p и 2p + 1 - уравнения состояния фазы p, строка 2m - равенство потенциалов фаз 0 и 1,
+     * строка 2m + 1 - равенство потенциалов фаз 0 и 2 (тройная точка)
+     * или обращение в ноль определителя матрицы вторых производных фазы 1 (конец линии перехода).
+     */
+    void evaluate(MulticriticalPoint::Kind kind, const std::vector<unsigned> &types, Coefficients c,
+                  const std::vector<double> &z, std::vector<double> &f, std::vector<double> &jacobian)
+    {
+        const std::size_t m = (z.size() - 2) / 2, n = z.size();
+        c.a[0] = z[0];
+        c.b[0] = z[1];
+        std::fill(jacobian.begin(), jacobian.end(), 0.0);
+        std::vector<PhaseDerivatives> l(m);
+        for (std::size_t p = 0; p < m; ++p)
+        {
+            l[p] = phaseDerivatives(c.c, types[p], z[2 + 2 * p], z[3 + 2 * p]);
+            stateEquations(types[p], l[p], z[2 + 2 * p], z[3 + 2 * p], 2 + 2 * p, &f[2 * p], &jacobian[2 * p * n], n);
+        }
+        potentialDifference(l[0], 2, l[1], 4, f[2 * m], &jacobian[2 * m * n]);
+        if (kind == MulticriticalPoint::TriplePoint)
+        {
+            potentialDifference(l[0], 2, l[2], 6, f[2 * m + 1], &jacobian[(2 * m + 1) * n]);
+            return;
+        }
+
+        /* Определитель xx * yy - xy^2 для фазы 1 и его производные
+         * (для фазы 4 в переменных N[0], N[1]^2 он обращается в ноль одновременно с определителем по N)
+         */
+        const PhaseDerivatives &e = l[1];
+        f[2 * m + 1] = e.xx * e.yy - e.xy * e.xy;
+        double *row = &jacobian[(2 * m + 1) * n];
+        for (unsigned k = 0; k < 2; ++k)
+            row[k] = e.cxx[k] * e.yy + e.xx * e.cyy[k] - 2 * e.xy * e.cxy[k];
+        row[4] = e.xxx * e.yy + e.xx * e.xyy - 2 * e.xy * e.xxy;
+        row[5] = e.xxy * e.yy + e.xx * e.yyy - 2 * e.xy * e.xyy;
+    }
+}
+
+
+MulticriticalLocator::MulticriticalLocator(const Worker &diagram)
+    : source(diagram), coeffs(diagram.getCoefficients()), seeds(0), iterations(0)
+{
+    QPointF steps = diagram.getSteps();
+    dX = steps.x();
+    dY = steps.y();
+}
+
+
+std::vector<MulticriticalLocator::Seed> MulticriticalLocator::findSeeds() const
+{
+    std::vector<Seed> res;
+    QSize size = source.getSize();
+    if (size.width() < 2 || size.height() < 2)
+        return res;
+    // Два соседних столбца
+    std::vector<DiagramPoint> left, right;
+    source.getColumn(0, right);
+    for (int i = 0; i + 1 < size.width(); ++i)
+    {
+        left.swap(right);
+        source.getColumn(i + 1, right);
+        for (int j = 0; j + 1 < size.height(); ++j)
+        {
+            const DiagramPoint *cell[4] {&left[j], &right[j], &left[j + 1], &right[j + 1]};
+            // Различные наиболее устойчивые фазы ячейки
+            std::vector<const PhaseInfo*> phases;
+            bool empty = false;
+            for (const DiagramPoint *point : cell)
+            {
+                const PhaseInfo *phase = stablestPhase(*point);
+                if (!phase)
+                    empty = true;
+                else if (std::none_of(phases.cbegin(), phases.cend(), [phase](const PhaseInfo *item) {return item->type == phase->type;}))
+                    phases.push_back(phase);
+            }
+            if (empty || phases.size() < 2)
+                continue;
+            if (phases.size() >= 3)
+            {
+                res.push_back({MulticriticalPoint::TriplePoint, static_cast<std::size_t>(i), static_cast<std::size_t>(j),
+                               {*phases[0], *phases[1], *phases[2]}, {}});
+                continue;
+            }
+
+            // Две фазы: ищутся стороны ячейки с переходом первого рода и с переходом без сосуществования
+            const int edges[4][2] {{0, 1}, {2, 3}, {0, 2}, {1, 3}};
+            bool firstOrder = false;
+            const DiagramPoint *lost = nullptr, *kept = nullptr;
+            for (auto &edge : edges)
+            {
+                const DiagramPoint &p = *cell[edge[0]], &q = *cell[edge[1]];
+                unsigned a = stablestType(p), b = stablestType(q);
+                if (a == b)
+                    continue;
+                if (isStable(p, b) && isStable(q, a))
+                    firstOrder = true;
+                else if (!isStable(p, b))
+                    lost = &q, kept = &p;   // Фаза b, наиболее устойчивая в q, неустойчива в p
+                else
+                    lost = &p, kept = &q;
+            }
+            if (!firstOrder || !lost)
+                continue;
+            Seed seed {MulticriticalPoint::CriticalEndPoint, static_cast<std::size_t>(i), static_cast<std::size_t>(j),
+                       {*stablestPhase(*kept), *stablestPhase(*lost)}, {}};
+            if (seed.phases[1].type == 4)
+            {
+                /* Фаза 4 вблизи точки ответвления от фазы 2 или 3: ближайшее к N направление симметричной фазы
+                 * (кратное 60 градусам) поворачивается на ось N[1] = 0 (чётные направления - фаза 3, нечётные - фаза 2)
+                 */
+                const PhaseInfo &phase = seed.phases[1];
+                double r = std::hypot(phase.n[0], phase.n[1]);
+                long k = std::lround(std::atan2(phase.n[1], phase.n[0]) * 3 / std::acos(-1.0));
+                bool even = k % 2 == 0;
+                seed.alternatives.push_back({.type = even ? 3u : 2u, .phi = phase.phi, .n = {even ? r : -r, 0.0}});
+            }
+            for (const DiagramPoint *point : cell)
+                for (const PhaseInfo &item : point->phases)
+                    if (item.type != seed.phases[0].type && item.type != seed.phases[1].type &&
+                        std::none_of(seed.alternatives.cbegin(), seed.alternatives.cend(), [&item](const PhaseInfo &other) {return other.type == item.type;}))
+                        seed.alternatives.push_back(item);
+            res.push_back(seed);
+        }
+    }
+    return res;
+}
+
+
+bool MulticriticalLocator::solve(const Seed &seed, MulticriticalPoint &point)
+{
+    const std::size_t m = seed.phases.size(), n = 2 + 2 * m;
+    std::vector<double> z(n), f(n), jacobian(n * n), scale(n);
+    // Начальное приближение - центр ячейки
+    QSize size = source.getSize();
+    z[0] = coeffs.a[0] + (size.height() - 1.5 - seed.j) * dY;
+    z[1] = coeffs.b[0] + (seed.i + 0.5) * dX;
+    // Переменные фаз (для фазы 4 - N[0] и N[1]^2, см. evaluate())
+    std::vector<unsigned> types(m);
+    for (std::size_t p = 0; p < m; ++p)
+    {
+        types[p] = seed.phases[p].type;
+        phaseVariables(seed.phases[p], z[2 + 2 * p], z[3 + 2 * p]);
+    }
+    const double alpha0 = z[0], beta0 = z[1];
+
+    double previous = std::numeric_limits<double>::infinity();
+    for (unsigned it = 1; it <= maxIterations; ++it)
+    {
+        ++iterations;
+        evaluate(seed.kind, types, coeffs, z, f, jacobian);
+        for (double &value : f)
+            value = -value;
+        if (!solveLinear(jacobian, f, n))
+            return false;
+        /* Масштабы переменных для критерия сходимости: Альфа1 и Бета1 - не меньше шага сетки,
+         * N - не меньше |N| фазы (N[1]^2 - не меньше |N|^2)
+         */
+        scale[0] = std::max(std::abs(z[0]), std::abs(dY));
+        scale[1] = std::max(std::abs(z[1]), std::abs(dX));
+        for (std::size_t p = 0; p < m; ++p)
+        {
+            double x = z[2 + 2 * p], y = z[3 + 2 * p];
+            double r = std::max(types[p] == 4 ? std::sqrt(x * x + std::abs(y)) : std::hypot(x, y), eps);
+            scale[2 + 2 * p] = r;
+            scale[3 + 2 * p] = types[p] == 4 ? r * r : r;
+        }
+        /* Шаг ограничивается: по Альфа1 и Бета1 - несколькими шагами сетки, по N - долей |N|
+         * (иначе фаза может перескочить к другому решению уравнений состояния)
+         */
+        double limit = std::max({1.0, std::abs(f[0]) / (maxStep * std::abs(dY)), std::abs(f[1]) / (maxStep * std::abs(dX))});
+        for (std::size_t k = 2; k < n; ++k)
+            limit = std::max(limit, std::abs(f[k]) / (maxOrderStep * scale[k]));
+        double norm = 0.0;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            z[k] += f[k] / limit;
+            norm = std::max(norm, std::abs(f[k] / limit) / scale[k]);
+        }
+        if (std::abs(z[0] - alpha0) > maxDistance * std::abs(dY) || std::abs(z[1] - beta0) > maxDistance * std::abs(dX))
+            return false;
+        /* Сходимость: шаг на уровне машинной точности
+         * или перестал уменьшаться, когда точность уже определяется ошибками округления
+         */
+        if (norm <= 4 * eps || (norm >= previous && previous <= 1e-10))
+        {
+            point.kind = seed.kind;
+            point.alpha1 = z[0];
+            point.beta1 = z[1];
+            point.iterations = it;
+            point.phases = seed.phases;
+            Coefficients c = coeffs;
+            c.a[0] = z[0];
+            c.b[0] = z[1];
+            for (std::size_t p = 0; p < m; ++p)
+            {
+                PhaseInfo &phase = point.phases[p];
+                if (!orderParameter(types[p], z[2 + 2 * p], z[3 + 2 * p], seed.phases[p].n[1], phase.n))
+                    return false;
+                phase.phi = PotentialN::value(c.c, phase.n[0], phase.n[1]);
+            }
+            return true;
+        }
+        previous = norm;
+    }
+    return false;
+}
+
+
+bool MulticriticalLocator::validate(const MulticriticalPoint &point) const
+{
+    Coefficients c = coeffs;
+    c.a[0] = point.alpha1;
+    c.b[0] = point.beta1;
+    const std::vector<PhaseInfo> &phases = point.phases;
+
+    // Фазы должны быть различны (совпадение означает критическую точку, а не сосуществование)
+    for (std::size_t p = 0; p < phases.size(); ++p)
+        for (std::size_t q = p + 1; q < phases.size(); ++q)
+        {
+            double distance = std::hypot(phases[p].n[0] - phases[q].n[0], phases[p].n[1] - phases[q].n[1]);
+            double norm = std::max(std::hypot(phases[p].n[0], phases[p].n[1]), std::hypot(phases[q].n[0], phases[q].n[1]));
+            if (distance <= 1e-6 * norm)
+                return false;
+        }
+
+    // Условия минимума (для теряющей устойчивость фазы в конце линии перехода - только след матрицы)
+    for (std::size_t p = 0; p < phases.size(); ++p)
+    {
+        double x = phases[p].n[0], y = phases[p].n[1];
+        PhaseDerivatives l = orderDerivatives(c.c, x, y);
+        double xx = l.xx, xy = l.xy, yy = l.yy;
+        double det = xx * yy - xy * xy;
+        bool marginal = point.kind == MulticriticalPoint::CriticalEndPoint && p == 1;
+        if (xx + yy <= 0 || (!marginal && (xx <= 0 || det <= -1e-9 * (std::abs(xx * yy) + xy * xy))))
+            return false;
+    }
+
+    // Никакая другая фаза не должна быть устойчивее сосуществующих
+    Worker probe(QSize(1, 1));
+    probe.setParameters(c, dX, dY);
+    std::vector<std::vector<DiagramPoint>> columns;
+    probe.calculateColumns(0, 1, columns);
+    double phi = phases[0].phi;
+    for (const PhaseInfo &item : columns[0][0].phases)
+        if (item.phi < phi - 1e-7 * std::abs(phi) - 1e-14)
+            return false;
+    return true;
+}
+
+
+std::vector<MulticriticalPoint> MulticriticalLocator::locate()
+{
+    std::vector<MulticriticalPoint> res;
+    std::vector<Seed> list = findSeeds();
+    seeds = list.size();
+    iterations = 0;
+    QSize size = source.getSize();
+    for (const Seed &seed : list)
+    {
+        // Приближения рядом с уже найденной точкой того же вида пропускаются
+        bool found = std::any_of(res.cbegin(), res.cend(), [&](const MulticriticalPoint &item)
+        {
+            double i = (item.beta1 - coeffs.b[0]) / dX, j = size.height() - 1 - (item.alpha1 - coeffs.a[0]) / dY;
+            return item.kind == seed.kind && std::abs(i - seed.i - 0.5) <= maxDistance && std::abs(j - seed.j - 0.5) <= maxDistance;
+        });
+        if (found)
+            continue;
+        MulticriticalPoint point;
+        if (solve(seed, point) && validate(point))
+        {
+            res.push_back(point);
+            continue;
+        }
+        Seed other = seed;
+        for (const PhaseInfo &item : seed.alternatives)
+        {
+            other.phases[1] = item;
+            if (solve(other, point) && validate(point))
+            {
+                res.push_back(point);
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+
+std::size_t MulticriticalLocator::seedsCount() const
+{
+    return seeds;
+}
+
+
+std::size_t MulticriticalLocator::iterationsCount() const
+{
+    return iterations;
+}
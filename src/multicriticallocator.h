@@ -0,0 +1,86 @@
+#ifndef MULTICRITICALLOCATOR_H
+#define MULTICRITICALLOCATOR_H
+
+#include <cstddef>
+#include <vector>
+#include "worker.h"
+
+
+// Мультикритическая точка диаграммы
+struct MulticriticalPoint
+{
+    enum Kind
+    {
+        TriplePoint,        // Тройная точка: сосуществуют три фазы
+        CriticalEndPoint    // Конец линии перехода первого рода: одна из двух сосуществующих фаз теряет устойчивость
+    };
+    Kind kind;
+    double alpha1, beta1;           // Координаты точки
+    std::vector<PhaseInfo> phases;  // Сосуществующие фазы (в конце линии перехода последняя - теряющая устойчивость)
+    unsigned iterations;            // Число итераций метода Ньютона
+};
+
+
+/* ---------------------------------------------------------------------------- *
+ * MulticriticalLocator - поиск тройных точек и концов линий переходов первого  *
+ * рода построенной диаграммы                                                   *
+ * ---------------------------------------------------------------------------- *
+ *
+ * Начальные приближения берутся из ячеек 2 x 2 точки диаграммы, в которых встречаются области
+ * трёх наиболее устойчивых фаз или граница двух фаз меняет род перехода (переход первого рода,
+ * при котором обе фазы устойчивы по обе стороны границы, сменяется переходом без сосуществования).
+ * Из каждого приближения методом Ньютона решается система для Альфа1, Бета1 и параметров
+ * порядка N всех участвующих фаз:
+ *     dPhi/dN[0] = dPhi/dN[1] = 0 для каждой фазы (уравнения состояния),
+ *     Phi(фаза 1) = Phi(фаза 2) = Phi(фаза 3) для тройной точки или
+ *     Phi(фаза 1) = Phi(фаза 2), det(d2Phi/dN2)(фаза 2) = 0 для конца линии перехода.
+ * Якобиан вычисляется точно по производным потенциала PotentialN (в том числе по Альфа1 и Бета1,
+ * см. LandauPotential::coefficientDerivative()). Найденная точка принимается, если фазы различны,
+ * устойчивы (в конце линии - кроме теряющей устойчивость) и никакая другая фаза в этой точке
+ * не имеет меньшего потенциала (проверка одним вызовом Worker::calculateColumns()).
+ * Изосимметрийные модификации одной фазы не различаются.
+ */
+
+class MulticriticalLocator
+{
+public:
+    explicit MulticriticalLocator(const Worker &diagram);
+    // Находит мультикритические точки диаграммы (без повторов, в порядке обхода диаграммы по столбцам)
+    std::vector<MulticriticalPoint> locate();
+    // Возвращает число начальных приближений и общее число итераций метода Ньютона последнего поиска
+    std::size_t seedsCount() const;
+    std::size_t iterationsCount() const;
+private:
+    /* Максимальное число итераций, максимальный шаг по Альфа1 и Бета1 (в шагах сетки)
+     * и по параметру порядка (в долях |N|)
+     */
+    static constexpr unsigned maxIterations = 50;
+    static constexpr double maxStep = 2.0;
+    static constexpr double maxOrderStep = 0.25;
+    // Допустимое удаление найденной точки от начального приближения (в шагах сетки)
+    static constexpr double maxDistance = 4.0;
+    const Worker &source;
+    Coefficients coeffs;
+    double dX, dY;
+    std::size_t seeds, iterations;
+    /* Начальное приближение: ячейка (i, j) - (i + 1, j + 1) и фазы в порядке уравнений системы.
+     * Для конца линии перехода в alternatives - другие устойчивые в ячейке фазы, которые пробуются
+     * в качестве теряющей устойчивость, если из phases решение не найдено (например, если в ячейке
+     * видна фаза 4, ответвляющаяся от теряющей устойчивость фазы 2 или 3 в точке, где система вырождена).
+     */
+    struct Seed
+    {
+        MulticriticalPoint::Kind kind;
+        std::size_t i, j;
+        std::vector<PhaseInfo> phases;
+        std::vector<PhaseInfo> alternatives;
+    };
+    // Находит начальные приближения
+    std::vector<Seed> findSeeds() const;
+    // Решает систему методом Ньютона из приближения seed
+    bool solve(const Seed &seed, MulticriticalPoint &point);
+    // Проверяет найденную точку
+    bool validate(const MulticriticalPoint &point) const;
+};
+
+#endif // MULTICRITICALLOCATOR_H
@@ -0,0 +1,61 @@
+#include "npywriter.h"
+
+
+NpyWriter::NpyWriter()
+    : expected(0), written(0)
+{
+
+}
+
+
+bool NpyWriter::open(const std::string &fileName, const char *type, std::size_t elementSize,
+                     const std::vector<std::size_t> &shape, bool fortranOrder)
+{
+    stream.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        return false;
+    // Порядок байтов элементов - как в памяти данного компьютера
+    const std::uint16_t probe = 1;
+    char order = elementSize == 1 ? '|' : *reinterpret_cast<const char*>(&probe) ? '<' : '>';
+    std::string header = std::string("{'descr': '") + order + type + "', 'fortran_order': " +
+                         (fortranOrder ? "True" : "False") + ", 'shape': (";
+    expected = elementSize;
+    for (std::size_t k = 0; k < shape.size(); ++k)
+    {
+        header += std::to_string(shape[k]) + (shape.size() == 1 || k + 1 < shape.size() ? "," : "");
+        if (k + 1 < shape.size())
+            header += ' ';
+        expected *= shape[k];
+    }
+    header += "), }";
+    // Сигнатура (6 байт), версия (2), длина заголовка (2), заголовок с пробелами и '\n' - кратно 64 байтам
+    std::size_t total = (10 + header.size() + 1 + 63) / 64 * 64;
+    header.append(total - 10 - header.size() - 1, ' ');
+    header += '\n';
+    if (header.size() > 0xffff)
+        return false;
+    char prefix[10] {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                     static_cast<char>(header.size() & 0xff), static_cast<char>(header.size() >> 8)};
+    stream.write(prefix, sizeof(prefix));
+    stream.write(header.data(), header.size());
+    written = 0;
+    return static_cast<bool>(stream);
+}
+
+
+bool NpyWriter::writeBytes(const void *data, std::size_t size)
+{
+    if (written + size > expected)
+        return false;
+    stream.write(static_cast<const char*>(data), size);
+    written += size;
+    return static_cast<bool>(stream);
+}
+
+
+bool NpyWriter::close()
+{
+    bool res = stream && written == expected;
+    stream.close();
+    return res && !stream.fail();
+}
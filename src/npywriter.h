@@ -0,0 +1,44 @@
+#ifndef NPYWRITER_H
+#define NPYWRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* Потоковая запись массива в формате NumPy .npy (версия 1.0).
+ * Заголовок с формой массива записывается сразу, данные дописываются частями как есть (без форматирования),
+ * поэтому массив не хранится в памяти целиком. Заголовок дополняется до 64 байт, так что данные выровнены
+ * и файл можно отображать в память (numpy.load(..., mmap_mode='r')).
+ */
+
+class NpyWriter
+{
+private:
+    std::ofstream stream;
+    std::uint64_t expected, written;    // Размер данных массива и количество записанных байтов
+public:
+    NpyWriter();
+    /* Создаёт файл и записывает заголовок массива формы shape с элементами типа type
+     * (код NumPy без порядка байтов: "u1", "f8" и т. п.) размером elementSize байт.
+     * fortranOrder = true - элементы по столбцам (первый индекс меняется быстрее).
+     * Возвращает false в случае ошибки.
+     */
+    bool open(const std::string &fileName, const char *type, std::size_t elementSize,
+              const std::vector<std::size_t> &shape, bool fortranOrder);
+    // Записывает count очередных элементов. Возвращает false в случае ошибки.
+    template<class T>
+    bool write(const T *values, std::size_t count);
+    bool writeBytes(const void *data, std::size_t size);
+    // Завершает запись (должны быть записаны все элементы). Возвращает false в случае ошибки.
+    bool close();
+};
+
+
+template<class T>
+bool NpyWriter::write(const T *values, std::size_t count)
+{
+    return writeBytes(values, count * sizeof(T));
+}
+
+#endif // NPYWRITER_H
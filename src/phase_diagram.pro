@@ -10,6 +10,7 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = phase_diagram
 TEMPLATE = app
+CONFIG += c++17
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked as deprecated (the exact warnings
@@ -26,14 +27,46 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += main.cpp\
         mainwindow.cpp \
     worker.cpp \
-    polynomial.cpp \
-    twovarspolynomial.cpp \
-    phasesinfodialog.cpp
+    phasesinfodialog.cpp \
+    diagrampainter.cpp \
+    sweepexporter.cpp \
+    sweepdialog.cpp \
+    stripimagewriter.cpp \
+    imageexporter.cpp \
+    imageexportdialog.cpp \
+    tilefarm.cpp \
+    multicriticallocator.cpp \
+    phaseequations.cpp \
+    curvetracer.cpp \
+    transitiontracer.cpp \
+    spinodaltracer.cpp \
+    volumeworker.cpp \
+    volumeviewer.cpp \
+    ensembleworker.cpp \
+    ensembledialog.cpp \
+    ensembleviewer.cpp
 
 HEADERS  += mainwindow.h \
     worker.h \
-    polynomial.h \
-    twovarspolynomial.h \
-    phasesinfodialog.h
+    phasesinfodialog.h \
+    diagrampainter.h \
+    sweepexporter.h \
+    sweepdialog.h \
+    stripimagewriter.h \
+    imageexporter.h \
+    imageexportdialog.h \
+    tilefarm.h \
+    multicriticallocator.h \
+    phaseequations.h \
+    curvetracer.h \
+    transitiontracer.h \
+    spinodaltracer.h \
+    volumeworker.h \
+    volumeviewer.h \
+    ensembleworker.h \
+    ensembledialog.h \
+    ensembleviewer.h
+
+include(phasecore.pri)
 
 RC_FILE = phase_diagram.rc
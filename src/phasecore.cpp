@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <new>
+#include "phasecore.h"
+#include "diagramengine.h"
+
+
+// Объект C API: DiagramEngine с функцией прогресса вызывающей стороны
+struct pd_engine : public DiagramEngine
+{
+    pd_progress_callback callback;
+    void *user;
+
+    pd_engine(std::size_t w, std::size_t h)
+        : DiagramEngine(w, h), callback(nullptr), user(nullptr)
+    {
+
+    }
+
+    void progress(int percent) override
+    {
+        if (callback && callback(percent, user))
+            cancel();
+    }
+};
+
+
+namespace
+{
+    /* Выполняет action, преобразуя исключения C++ в коды ошибок
+     * (исключения не должны выходить за границу интерфейса на C)
+     */
+    template<class Action>
+    int guarded(Action action)
+    {
+        try
+        {
+            return action();
+        }
+        catch (const std::bad_alloc &)
+        {
+            return PD_ERROR_MEMORY;
+        }
+        catch (...)
+        {
+            return PD_ERROR_INTERNAL;
+        }
+    }
+
+    void fillCell(const DiagramPoint &dp, pd_cell &cell)
+    {
+        cell.stablest = dp.stablest == -1 ? 0 : dp.phases[dp.stablest].type;
+        cell.phases = 0;
+        for (const PhaseInfo &item : dp.phases)
+            cell.phases |= 1u << (item.type - 1);
+        cell.count = static_cast<unsigned>(dp.phases.size());
+        cell.transition = dp.transition;
+        cell.phi = dp.stablest == -1 ? 0.0 : dp.phases[dp.stablest].phi;
+        cell.n[0] = dp.stablest == -1 ? 0.0 : dp.phases[dp.stablest].n[0];
+        cell.n[1] = dp.stablest == -1 ? 0.0 : dp.phases[dp.stablest].n[1];
+    }
+
+    int copyPhases(const DiagramPoint &dp, pd_phase *phases, std::size_t capacity, std::size_t *count, int *stablest)
+    {
+        if (!count || (capacity && !phases))
+            return PD_ERROR_ARGUMENT;
+        *count = dp.phases.size();
+        for (std::size_t k = 0; k < std::min(capacity, dp.phases.size()); ++k)
+            phases[k] = {dp.phases[k].type, dp.phases[k].phi, {dp.phases[k].n[0], dp.phases[k].n[1]}};
+        if (stablest)
+            *stablest = static_cast<int>(dp.stablest);
+        return PD_OK;
+    }
+
+    bool contains(const pd_engine *engine, std::size_t i, std::size_t j)
+    {
+        return engine && i < engine->getWidth() && j < engine->getHeight();
+    }
+}
+
+
+int pd_api_version(void)
+{
+    return PD_API_VERSION;
+}
+
+
+pd_engine *pd_engine_create(size_t width, size_t height)
+{
+    try
+    {
+        return new pd_engine(width, height);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+
+void pd_engine_destroy(pd_engine *engine)
+{
+    delete engine;
+}
+
+
+int pd_engine_set_parameters(pd_engine *engine, const double coefficients[9], double step_beta, double step_alpha)
+{
+    if (!engine || !coefficients)
+        return PD_ERROR_ARGUMENT;
+    Coefficients c;
+    std::copy(coefficients, coefficients + 9, c.c);
+    engine->setParameters(c, step_beta, step_alpha);
+    return PD_OK;
+}
+
+
+int pd_engine_set_model(pd_engine *engine, int model)
+{
+    if (!engine || model < PD_MODEL_3M || model > PD_MODEL_4MM)
+        return PD_ERROR_ARGUMENT;
+    engine->setModel(static_cast<PotentialModel>(model));
+    return PD_OK;
+}
+
+
+int pd_engine_set_compressed(pd_engine *engine, int flag)
+{
+    if (!engine)
+        return PD_ERROR_ARGUMENT;
+    engine->setCompressedStorage(flag != 0);
+    return PD_OK;
+}
+
+
+int pd_engine_calculate(pd_engine *engine, pd_progress_callback progress, void *user)
+{
+    if (!engine)
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        engine->callback = progress;
+        engine->user = user;
+        engine->calculate();
+        engine->callback = nullptr;
+        return engine->isCancelled() ? PD_CANCELLED : PD_OK;
+    });
+}
+
+
+void pd_engine_cancel(pd_engine *engine)
+{
+    if (engine)
+        engine->cancel();
+}
+
+
+int pd_engine_copy_grid(const pd_engine *engine, pd_cell *buffer, size_t capacity)
+{
+    if (!engine || !buffer || capacity < engine->getWidth() * engine->getHeight())
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        // Обход по столбцам: в режиме сжатого хранения столбцы восстанавливаются по одному
+        const std::size_t width = engine->getWidth(), height = engine->getHeight();
+        for (std::size_t i = 0; i < width; ++i)
+            for (std::size_t j = 0; j < height; ++j)
+                fillCell(engine->getDiagramPoint(i, j), buffer[j * width + i]);
+        return PD_OK;
+    });
+}
+
+
+int pd_engine_cell(const pd_engine *engine, size_t i, size_t j, pd_cell *cell)
+{
+    if (!contains(engine, i, j) || !cell)
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        fillCell(engine->getDiagramPoint(i, j), *cell);
+        return PD_OK;
+    });
+}
+
+
+int pd_engine_phases(const pd_engine *engine, size_t i, size_t j,
+                     pd_phase *phases, size_t capacity, size_t *count, int *stablest)
+{
+    if (!contains(engine, i, j))
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        return copyPhases(engine->getDiagramPoint(i, j), phases, capacity, count, stablest);
+    });
+}
+
+
+int pd_engine_evaluate(pd_engine *engine, double beta, double alpha,
+                       pd_phase *phases, size_t capacity, size_t *count, int *stablest)
+{
+    if (!engine)
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        DiagramPoint dp;
+        engine->evaluatePoint(beta, alpha, dp);
+        return copyPhases(dp, phases, capacity, count, stablest);
+    });
+}
+
+
+int pd_engine_export_npy(const pd_engine *engine, const char *prefix)
+{
+    if (!engine || !prefix)
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        return engine->exportFields(prefix) ? PD_OK : PD_ERROR_INTERNAL;
+    });
+}
+
+
+int pd_compute_grid(size_t width, size_t height, const double coefficients[9], double step_beta,
+                    double step_alpha, pd_cell *buffer, pd_progress_callback progress, void *user)
+{
+    if (!coefficients || !buffer)
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        pd_engine engine(width, height);
+        pd_engine_set_parameters(&engine, coefficients, step_beta, step_alpha);
+        int res = pd_engine_calculate(&engine, progress, user);
+        if (res != PD_OK)
+            return res;
+        return pd_engine_copy_grid(&engine, buffer, width * height);
+    });
+}
+
+
+int pd_polynomial_roots(const double *coefficients, size_t count, double *roots, size_t capacity, size_t *found)
+{
+    if (!coefficients || !count || !found || (capacity && !roots))
+        return PD_ERROR_ARGUMENT;
+    return guarded([=]
+    {
+        // Рабочая память - своя для каждого потока, при повторных вызовах выделений памяти нет
+        static thread_local SolverContext context;
+        Polynomial equation(count - 1);
+        for (std::size_t k = 0; k < count; ++k)
+            equation[k] = coefficients[k];
+        const std::vector<double> &res = equation.roots(context);
+        // Polynomial::roots() для полинома степени 0 возвращает корень 0.0; для константы корней нет
+        if (!equation.degree())
+        {
+            *found = 0;
+            return PD_OK;
+        }
+        *found = res.size();
+        std::copy(res.begin(), res.begin() + std::min(capacity, res.size()), roots);
+        return PD_OK;
+    });
+}
+
+
+int pd_set_root_solver(size_t degree, int solver)
+{
+    if (solver < PD_SOLVER_ANALYTIC || solver > PD_SOLVER_COMPANION)
+        return PD_ERROR_ARGUMENT;
+    Polynomial::setSolver(degree, static_cast<RootSolver>(solver));
+    return PD_OK;
+}
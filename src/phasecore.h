@@ -0,0 +1,159 @@
+#ifndef PHASECORE_H
+#define PHASECORE_H
+
+#include <stddef.h>
+
+/* phasecore - библиотека расчёта фазовых диаграмм без Qt с интерфейсом на C для пакетных расчётов
+ * (скрипты, другие языки, вычислительные кластеры). Интерфейс стабилен в пределах версии PD_API_VERSION:
+ * объекты доступны только через непрозрачный указатель pd_engine, структуры передаются по значению
+ * или в буферах вызывающей стороны, исключения C++ через границу интерфейса не проходят.
+ *
+ * Коэффициенты потенциала - 9 чисел в порядке Альфа1..Альфа4, Бета1, Бета2, Дельта1..Дельта3
+ * (как в файлах диаграмм, см. DiagramEngine::saveData()). Для диаграммы Альфа1 и Бета1 - стартовые
+ * (наименьшие) значения. Точка (i, j): i - столбец (Бета1), j - строка, j = 0 - наибольшее Альфа1.
+ *
+ * Функции, возвращающие int, возвращают PD_OK (или PD_CANCELLED) при успехе и отрицательный код ошибки.
+ * Разные объекты pd_engine могут использоваться из разных потоков одновременно, один объект - только из
+ * одного потока (кроме pd_engine_cancel()).
+ */
+
+#if defined(PHASECORE_SHARED)
+#  if defined(_WIN32)
+#    if defined(PHASECORE_BUILD)
+#      define PHASECORE_EXPORT __declspec(dllexport)
+#    else
+#      define PHASECORE_EXPORT __declspec(dllimport)
+#    endif
+#  else
+#    define PHASECORE_EXPORT __attribute__((visibility("default")))
+#  endif
+#else
+#  define PHASECORE_EXPORT
+#endif
+
+#define PD_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Коды результата
+enum
+{
+    PD_OK = 0,
+    PD_CANCELLED = 1,           // Расчёт прерван (pd_engine_cancel() или функцией прогресса)
+    PD_ERROR_ARGUMENT = -1,     // Неверный аргумент (нулевой указатель, индекс вне диаграммы, мал буфер)
+    PD_ERROR_MEMORY = -2,       // Недостаточно памяти
+    PD_ERROR_INTERNAL = -3      // Прочие ошибки
+};
+
+// Методы поиска корней (см. RootSolver)
+enum
+{
+    PD_SOLVER_ANALYTIC = 0,
+    PD_SOLVER_STURM = 1,
+    PD_SOLVER_DESCARTES = 2,
+    PD_SOLVER_ABERTH = 3,
+    PD_SOLVER_COMPANION = 4
+};
+
+// Модели потенциала (см. PotentialModel и phasemodels.h)
+enum
+{
+    PD_MODEL_3M = 0,            // Исходная модель (по умолчанию)
+    PD_MODEL_4MM = 1            // Двухкомпонентный параметр порядка с тетрагональной анизотропией
+};
+
+typedef struct pd_engine pd_engine;
+
+// Устойчивая фаза в точке
+typedef struct pd_phase
+{
+    unsigned type;              // Тип фазы 1..4
+    double phi;                 // Потенциал
+    double n[2];                // Компоненты параметра порядка
+} pd_phase;
+
+// Сводка точки диаграммы (элемент буфера pd_engine_copy_grid())
+typedef struct pd_cell
+{
+    unsigned stablest;          // Тип наиболее устойчивой фазы 1..4 или 0, если устойчивых фаз нет
+    unsigned phases;            // Набор типов устойчивых фаз: бит k - фаза k + 1
+    unsigned count;             // Число устойчивых фаз (с изосимметрийными модификациями)
+    unsigned transition;        // 1 - точка линии фазового перехода первого рода
+    double phi;                 // Потенциал и компоненты параметра порядка наиболее устойчивой фазы
+    double n[2];                // (нули, если устойчивых фаз нет)
+} pd_cell;
+
+/* Функция прогресса расчёта: вызывается после каждого рассчитанного столбца в потоке расчёта,
+ * percent - процент выполнения. Ненулевое возвращаемое значение прерывает расчёт.
+ */
+typedef int (*pd_progress_callback)(int percent, void *user);
+
+// Возвращает версию интерфейса библиотеки (PD_API_VERSION, с которой она собрана)
+PHASECORE_EXPORT int pd_api_version(void);
+
+// Создаёт объект расчёта диаграммы width x height (NULL при ошибке) и уничтожает его
+PHASECORE_EXPORT pd_engine *pd_engine_create(size_t width, size_t height);
+PHASECORE_EXPORT void pd_engine_destroy(pd_engine *engine);
+
+// Задаёт коэффициенты потенциала и шаги по Бета1 и Альфа1 (до pd_engine_calculate())
+PHASECORE_EXPORT int pd_engine_set_parameters(pd_engine *engine, const double coefficients[9], double step_beta, double step_alpha);
+// Выбор модели потенциала PD_MODEL_* (до pd_engine_calculate()); коэффициенты - в порядке Coefficients::c
+PHASECORE_EXPORT int pd_engine_set_model(pd_engine *engine, int model);
+// Включает (flag != 0) или выключает сжатое хранение диаграммы (для больших диаграмм)
+PHASECORE_EXPORT int pd_engine_set_compressed(pd_engine *engine, int flag);
+
+/* Рассчитывает диаграмму. progress может быть NULL, user передаётся в progress.
+ * Возвращает PD_CANCELLED, если расчёт прерван (данные диаграммы при этом неполные).
+ */
+PHASECORE_EXPORT int pd_engine_calculate(pd_engine *engine, pd_progress_callback progress, void *user);
+// Прерывает расчёт (может вызываться из любого потока)
+PHASECORE_EXPORT void pd_engine_cancel(pd_engine *engine);
+
+/* Копирует сводки всех точек рассчитанной диаграммы в буфер вызывающей стороны
+ * (capacity - размер буфера в элементах, не менее width * height) построчно: buffer[j * width + i].
+ */
+PHASECORE_EXPORT int pd_engine_copy_grid(const pd_engine *engine, pd_cell *buffer, size_t capacity);
+// Сводка точки (i, j) рассчитанной диаграммы
+PHASECORE_EXPORT int pd_engine_cell(const pd_engine *engine, size_t i, size_t j, pd_cell *cell);
+/* Устойчивые фазы в точке (i, j) рассчитанной диаграммы: в *count записывается их число,
+ * в phases - не более capacity первых из них, в *stablest (если не NULL) - индекс наиболее устойчивой
+ * фазы или -1. phases может быть NULL при capacity = 0 (запрос числа фаз).
+ */
+PHASECORE_EXPORT int pd_engine_phases(const pd_engine *engine, size_t i, size_t j,
+                                      pd_phase *phases, size_t capacity, size_t *count, int *stablest);
+/* То же для произвольной точки Бета1 = beta, Альфа1 = alpha при остальных коэффициентах объекта
+ * (рассчитывается заново; не вызывать одновременно с pd_engine_calculate())
+ */
+PHASECORE_EXPORT int pd_engine_evaluate(pd_engine *engine, double beta, double alpha,
+                                        pd_phase *phases, size_t capacity, size_t *count, int *stablest);
+
+/* Записывает поля рассчитанной диаграммы в файлы NumPy prefix_*.npy (см. DiagramEngine::exportFields()):
+ * тип наиболее устойчивой фазы, набор устойчивых фаз, потенциал, компоненты параметра порядка и оси.
+ */
+PHASECORE_EXPORT int pd_engine_export_npy(const pd_engine *engine, const char *prefix);
+
+// Расчёт диаграммы width x height сразу в буфер (width * height элементов, см. pd_engine_copy_grid())
+PHASECORE_EXPORT int pd_compute_grid(size_t width, size_t height, const double coefficients[9], double step_beta,
+                                     double step_alpha, pd_cell *buffer, pd_progress_callback progress, void *user);
+
+/* Вещественные корни полинома с count коэффициентами по возрастанию степени:
+ * в *found записывается число корней, в roots - не более capacity первых из них.
+ * Используется метод, выбранный для степени полинома (см. pd_set_root_solver()).
+ * Если все коэффициенты, кроме свободного члена, пренебрежимо малы (полином - константа, в том числе нулевая),
+ * корней нет (*found = 0).
+ */
+PHASECORE_EXPORT int pd_polynomial_roots(const double *coefficients, size_t count,
+                                         double *roots, size_t capacity, size_t *found);
+/* Выбор метода поиска корней (PD_SOLVER_*) для полиномов степени degree.
+ * Действует на все объекты; вызывается до начала расчётов. Полиномы степени выше 8 всегда решаются
+ * методом Штурма.
+ */
+PHASECORE_EXPORT int pd_set_root_solver(size_t degree, int solver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PHASECORE_H
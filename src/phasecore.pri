@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Ядро расчёта диаграммы без Qt (DiagramEngine, поиск корней, сжатое хранение, статистика).
+# Подключается приложением, бенчмарками и библиотекой phasecore.
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/diagramengine.cpp \
+    $$PWD/polynomial.cpp \
+    $$PWD/solvercontext.cpp \
+    $$PWD/rootsolvers.cpp \
+    $$PWD/compresseddiagram.cpp \
+    $$PWD/diagramstatistics.cpp \
+    $$PWD/transitionstencil.cpp \
+    $$PWD/npywriter.cpp \
+    $$PWD/phasevolume.cpp \
+    $$PWD/phaseensemble.cpp
+
+HEADERS += $$PWD/diagramengine.h \
+    $$PWD/polynomial.h \
+    $$PWD/solvercontext.h \
+    $$PWD/rootsolvers.h \
+    $$PWD/landaupotential.h \
+    $$PWD/phasemodel.h \
+    $$PWD/phasemodels.h \
+    $$PWD/diagrampoint.h \
+    $$PWD/compresseddiagram.h \
+    $$PWD/runmetrics.h \
+    $$PWD/diagramstatistics.h \
+    $$PWD/transitionstencil.h \
+    $$PWD/npywriter.h \
+    $$PWD/phasevolume.h \
+    $$PWD/phaseensemble.h
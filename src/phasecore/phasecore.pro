@@ -0,0 +1,26 @@
+#-------------------------------------------------
+#
+# Библиотека phasecore: расчёт фазовых диаграмм без Qt с интерфейсом на C (phasecore.h)
+# По умолчанию собирается статическая библиотека, динамическая - qmake CONFIG+=phasecore_shared
+#
+#-------------------------------------------------
+
+TEMPLATE = lib
+CONFIG += c++17 staticlib
+CONFIG -= qt
+
+TARGET = phasecore
+
+include(../phasecore.pri)
+
+SOURCES += ../phasecore.cpp
+
+HEADERS += ../phasecore.h
+
+phasecore_shared {
+    CONFIG -= staticlib
+    CONFIG += shared hide_symbols
+    DEFINES += PHASECORE_SHARED PHASECORE_BUILD
+}
+
+unix: LIBS += -lpthread
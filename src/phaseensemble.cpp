@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "phaseensemble.h"
+#include "landaupotential.h"
+#include "npywriter.h"
+
+
+namespace
+{
+    // DiagramEngine для расчёта члена ансамбля: прерывает расчёт, когда прерван расчёт всего ансамбля
+    class MemberEngine : public DiagramEngine
+    {
+    private:
+        const std::atomic<bool> &stop;
+    protected:
+        void progress(int) override
+        {
+            if (stop)
+                cancel();
+        }
+    public:
+        MemberEngine(std::size_t w, std::size_t h, const std::atomic<bool> &flag)
+            : DiagramEngine(w, h), stop(flag)
+        {
+
+        }
+    };
+}
+
+
+PhaseEnsemble::PhaseEnsemble()
+    : distributions(), dX(0.0), dY(0.0), width(0), height(0), members(0), seed(0), cancelled(false), complete(false)
+{
+
+}
+
+
+PhaseEnsemble::~PhaseEnsemble()
+{
+
+}
+
+
+void PhaseEnsemble::setParameters(const Coefficients coefficients, const double stepX, const double stepY, std::size_t w, std::size_t h,
+                                  const std::array<CoefficientDistribution, 9> &distribution, std::size_t count, unsigned randomSeed)
+{
+    coeffs = coefficients;
+    dX = stepX;
+    dY = stepY;
+    width = w;
+    height = h;
+    distributions = distribution;
+    members = count;
+    seed = randomSeed;
+    complete = false;
+}
+
+
+void PhaseEnsemble::progress(int)
+{
+
+}
+
+
+Coefficients PhaseEnsemble::sample(std::size_t k) const
+{
+    // Свой генератор для каждого члена: выборка не зависит от порядка расчёта членов потоками
+    std::seed_seq sequence {seed, static_cast<unsigned>(k), static_cast<unsigned>(static_cast<std::uint64_t>(k) >> 32)};
+    std::mt19937_64 generator(sequence);
+    Coefficients c = coeffs;
+    for (unsigned m = 0; m < 9; ++m)
+    {
+        if (m == Alpha1 || m == Beta1)
+            continue;
+        const CoefficientDistribution &d = distributions[m];
+        if (d.kind == CoefficientDistribution::Normal && d.width > 0)
+            c.c[m] = std::normal_distribution<double>(coeffs.c[m], d.width)(generator);
+        else if (d.kind == CoefficientDistribution::Uniform && d.width > 0)
+            c.c[m] = std::uniform_real_distribution<double>(coeffs.c[m] - d.width, coeffs.c[m] + d.width)(generator);
+    }
+    return c;
+}
+
+
+void PhaseEnsemble::calculate()
+{
+    cancelled = false;
+    complete = false;
+    counts.assign(width * height * typesCount, 0);
+    const std::size_t threadsCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), members));
+    std::atomic<std::size_t> next(0), done(0);
+    /* Счётчики общие для всех потоков и разделены на полосы столбцов, каждая со своим мьютексом.
+     * Поток добавляет диаграмму члена по столбцам, начиная со своей полосы, поэтому потоки редко ждут друг друга.
+     * Сложение целых не зависит от порядка, результат детерминирован.
+     */
+    const std::size_t stripsCount = std::max<std::size_t>(1, std::min<std::size_t>(width, 4 * threadsCount));
+    std::vector<std::mutex> stripMutexes(stripsCount);
+    auto compute = [this, threadsCount, stripsCount, &next, &done, &stripMutexes](std::size_t index)
+    {
+        MemberEngine engine(width, height, cancelled);
+        engine.setCompressedStorage(true);
+        // Нужен только тип наиболее устойчивой фазы в точках: переходы и статистика не определяются
+        engine.setAnalysis(false);
+        CompressedDiagram member;
+        std::vector<DiagramPoint> column;
+        const std::size_t offset = width * index / threadsCount;
+        for (std::size_t k; !cancelled && (k = next++) < members; )
+        {
+            engine.setParameters(sample(k), dX, dY);
+            engine.calculate();
+            if (engine.isCancelled())
+                return;
+            // Диаграмма забирается без копирования и сразу сводится к счётчикам
+            engine.swapCompressed(member);
+            for (std::size_t n = 0; n < width; ++n)
+            {
+                const std::size_t i = (offset + n) % width;
+                member.column(i, column);
+                std::lock_guard<std::mutex> lock(stripMutexes[i * stripsCount / width]);
+                for (std::size_t j = 0; j < height; ++j)
+                {
+                    const DiagramPoint &dp = column[j];
+                    ++counts[(i * height + j) * typesCount + (dp.stablest == -1 ? 0 : dp.phases[dp.stablest].type)];
+                }
+            }
+            progress(static_cast<int>(100 * ++done / members));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < threadsCount; ++t)
+        threads.emplace_back(compute, t);
+    compute(0);
+    for (auto &t : threads)
+        t.join();
+    complete = !cancelled;
+}
+
+
+void PhaseEnsemble::cancel()
+{
+    cancelled = true;
+}
+
+
+bool PhaseEnsemble::isComplete() const
+{
+    return complete;
+}
+
+
+std::size_t PhaseEnsemble::getWidth() const
+{
+    return width;
+}
+
+
+std::size_t PhaseEnsemble::getHeight() const
+{
+    return height;
+}
+
+
+std::size_t PhaseEnsemble::getMembers() const
+{
+    return members;
+}
+
+
+Coefficients PhaseEnsemble::getCoefficients() const
+{
+    return coeffs;
+}
+
+
+double PhaseEnsemble::getStepX() const
+{
+    return dX;
+}
+
+
+double PhaseEnsemble::getStepY() const
+{
+    return dY;
+}
+
+
+double PhaseEnsemble::probability(std::size_t i, std::size_t j, unsigned type) const
+{
+    return members ? static_cast<double>(counts[(i * height + j) * typesCount + type]) / members : 0.0;
+}
+
+
+double PhaseEnsemble::entropy(std::size_t i, std::size_t j) const
+{
+    double res = 0.0;
+    for (unsigned type = 0; type < typesCount; ++type)
+    {
+        double p = probability(i, j, type);
+        if (p > 0)
+            res -= p * std::log2(p);
+    }
+    return res;
+}
+
+
+unsigned PhaseEnsemble::mostProbable(std::size_t i, std::size_t j) const
+{
+    const std::uint32_t *first = &counts[(i * height + j) * typesCount];
+    return static_cast<unsigned>(std::max_element(first, first + typesCount) - first);
+}
+
+
+bool PhaseEnsemble::exportFields(const std::string &prefix) const
+{
+    if (!complete)
+        return false;
+    NpyWriter fields[typesCount + 1], axes[2];
+    const std::vector<std::size_t> shape {height, width};
+    bool ok = true;
+    for (unsigned type = 0; type < typesCount && ok; ++type)
+        ok = fields[type].open(prefix + "_p" + std::to_string(type) + ".npy", "f8", sizeof(double), shape, true);
+    ok = ok && fields[typesCount].open(prefix + "_entropy.npy", "f8", sizeof(double), shape, true) &&
+               axes[0].open(prefix + "_beta1.npy", "f8", sizeof(double), {width}, false) &&
+               axes[1].open(prefix + "_alpha1.npy", "f8", sizeof(double), {height}, false);
+    if (!ok)
+        return false;
+
+    // Оси: Бета1 по столбцам и Альфа1 по строкам (от наибольшего)
+    std::vector<double> values(std::max(width, height));
+    for (std::size_t i = 0; i < width; ++i)
+        values[i] = coeffs.b[0] + i * dX;
+    ok = axes[0].write(values.data(), width);
+    for (std::size_t j = 0; j < height; ++j)
+        values[j] = coeffs.a[0] + (height - 1 - j) * dY;
+    ok = ok && axes[1].write(values.data(), height);
+
+    // Поля записываются по столбцам (порядок Fortran)
+    for (std::size_t i = 0; i < width && ok; ++i)
+    {
+        for (unsigned type = 0; type < typesCount && ok; ++type)
+        {
+            for (std::size_t j = 0; j < height; ++j)
+                values[j] = probability(i, j, type);
+            ok = fields[type].write(values.data(), height);
+        }
+        for (std::size_t j = 0; j < height; ++j)
+            values[j] = entropy(i, j);
+        ok = ok && fields[typesCount].write(values.data(), height);
+    }
+    for (NpyWriter &writer : fields)
+        ok = writer.close() && ok;
+    for (NpyWriter &writer : axes)
+        ok = writer.close() && ok;
+    return ok;
+}
@@ -0,0 +1,84 @@
+#ifndef PHASEENSEMBLE_H
+#define PHASEENSEMBLE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "diagramengine.h"
+
+/* Ансамбль фазовых диаграмм для коэффициентов с погрешностями (метод Монте-Карло).
+ * Коэффициенты каждого члена ансамбля выбираются из заданных распределений, диаграммы рассчитываются
+ * параллельно, и для каждой точки (Бета1, Альфа1) накапливается число членов с данной наиболее устойчивой фазой.
+ * Диаграммы членов ансамбля не хранятся: память - счётчики точек и по одной сжатой диаграмме на поток.
+ * Каждый поток использует для всех своих членов один объект DiagramEngine (рабочая память поиска корней
+ * и буферы выделяются один раз). Выборка коэффициентов члена k зависит только от seed и k,
+ * поэтому результат не зависит от числа потоков.
+ */
+
+// Распределение коэффициента в ансамбле (среднее - значение коэффициента)
+struct CoefficientDistribution
+{
+    enum Kind {Fixed, Normal, Uniform};
+    Kind kind;
+    double width;   // Стандартное отклонение (Normal) или полуширина интервала (Uniform)
+};
+
+class PhaseEnsemble
+{
+public:
+    // Число значений типа наиболее устойчивой фазы (0 - нет устойчивых фаз, 1..4 - фазы)
+    static constexpr unsigned typesCount = 5;
+private:
+    Coefficients coeffs;                                    // Средние коэффициенты (Альфа1 и Бета1 - стартовые значения)
+    std::array<CoefficientDistribution, 9> distributions;   // Распределения коэффициентов
+    double dX, dY;                                          // Шаги по Бета1 и Альфа1
+    std::size_t width, height;
+    std::size_t members;                                    // Число членов ансамбля
+    unsigned seed;                                          // Начальное значение генератора случайных чисел
+    std::vector<std::uint32_t> counts;                      // Счётчики: индекс (i * height + j) * typesCount + тип
+    std::atomic<bool> cancelled;
+    bool complete;                                          // Все члены ансамбля рассчитаны
+protected:
+    // Вызывается из потоков расчёта после каждого рассчитанного члена ансамбля (percent - процент выполнения)
+    virtual void progress(int percent);
+public:
+    PhaseEnsemble();
+    virtual ~PhaseEnsemble();
+    /* Установка параметров. coefficients, stepX и stepY - как при расчёте обычной диаграммы размером w x h;
+     * distribution[k] - распределение коэффициента Coefficients::c[k] (для Альфа1 и Бета1 - осей диаграммы -
+     * не используется), count - число членов ансамбля. Функция должна быть вызвана перед вызовом calculate().
+     */
+    void setParameters(const Coefficients coefficients, const double stepX, const double stepY, std::size_t w, std::size_t h,
+                       const std::array<CoefficientDistribution, 9> &distribution, std::size_t count, unsigned randomSeed);
+    // Расчёт ансамбля (прерывается функцией cancel())
+    void calculate();
+    // Прерывает расчёт (может вызываться из любого потока)
+    void cancel();
+    // Возвращает true, если рассчитаны все члены ансамбля
+    bool isComplete() const;
+    std::size_t getWidth() const;
+    std::size_t getHeight() const;
+    std::size_t getMembers() const;
+    // Возвращает средние коэффициенты и шаги по Бета1 (X) и Альфа1 (Y)
+    Coefficients getCoefficients() const;
+    double getStepX() const;
+    double getStepY() const;
+    // Коэффициенты члена ансамбля k
+    Coefficients sample(std::size_t k) const;
+    // Вероятность того, что в точке (i, j) наиболее устойчива фаза type (0 - нет устойчивых фаз)
+    double probability(std::size_t i, std::size_t j, unsigned type) const;
+    // Энтропия распределения типа наиболее устойчивой фазы в точке (i, j), бит (от 0 до log2(typesCount))
+    double entropy(std::size_t i, std::size_t j) const;
+    // Наиболее вероятный тип наиболее устойчивой фазы в точке (i, j)
+    unsigned mostProbable(std::size_t i, std::size_t j) const;
+    /* Экспорт в файлы NumPy .npy (см. NpyWriter): prefix_p0.npy ... prefix_p4.npy (вероятности типов,
+     * 0 - нет устойчивых фаз) и prefix_entropy.npy - массивы height x width типа float64, строка 0 - наибольшее
+     * Альфа1; prefix_beta1.npy и prefix_alpha1.npy - значения Бета1 по столбцам и Альфа1 по строкам.
+     * Возвращает false в случае ошибки.
+     */
+    bool exportFields(const std::string &prefix) const;
+};
+
+#endif // PHASEENSEMBLE_H
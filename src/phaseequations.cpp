@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include "phaseequations.h"
+#include "landaupotential.h"
+
+
+namespace
+{
+    template<class Potential>
+    PhaseDerivatives derivatives(const double *c, double x, double y)
+    {
+        PhaseDerivatives d;
+        d.v = Potential::value(c, x, y);
+        d.x = Potential::template Derivative<1, 0>::value(c, x, y);
+        d.y = Potential::template Derivative<0, 1>::value(c, x, y);
+        d.xx = Potential::template Derivative<2, 0>::value(c, x, y);
+        d.xy = Potential::template Derivative<1, 1>::value(c, x, y);
+        d.yy = Potential::template Derivative<0, 2>::value(c, x, y);
+        d.xxx = Potential::template Derivative<3, 0>::value(c, x, y);
+        d.xxy = Potential::template Derivative<2, 1>::value(c, x, y);
+        d.xyy = Potential::template Derivative<1, 2>::value(c, x, y);
+        d.yyy = Potential::template Derivative<0, 3>::value(c, x, y);
+        const unsigned parameters[2] {Alpha1, Beta1};
+        for (unsigned k = 0; k < 2; ++k)
+        {
+            d.cv[k] = Potential::coefficientDerivative(parameters[k], x, y);
+            d.cx[k] = Potential::template Derivative<1, 0>::coefficientDerivative(parameters[k], x, y);
+            d.cy[k] = Potential::template Derivative<0, 1>::coefficientDerivative(parameters[k], x, y);
+            d.cxx[k] = Potential::template Derivative<2, 0>::coefficientDerivative(parameters[k], x, y);
+            d.cxy[k] = Potential::template Derivative<1, 1>::coefficientDerivative(parameters[k], x, y);
+            d.cyy[k] = Potential::template Derivative<0, 2>::coefficientDerivative(parameters[k], x, y);
+        }
+        return d;
+    }
+}
+
+
+PhaseDerivatives phaseDerivatives(const double *c, unsigned type, double x, double y)
+{
+    return type == 4 ? derivatives<PotentialS>(c, x, y) : derivatives<PotentialN>(c, x, y);
+}
+
+
+PhaseDerivatives orderDerivatives(const double *c, double x, double y)
+{
+    return derivatives<PotentialN>(c, x, y);
+}
+
+
+void phaseVariables(const PhaseInfo &phase, double &x, double &y)
+{
+    x = phase.n[0];
+    y = phase.type == 4 ? phase.n[1] * phase.n[1] : phase.n[1];
+}
+
+
+bool orderParameter(unsigned type, double x, double y, double sign, double n[2])
+{
+    n[0] = x;
+    if (type != 4)
+        n[1] = y;
+    else if (y > 0)
+        n[1] = std::copysign(std::sqrt(y), sign);
+    else
+        return false;
+    return true;
+}
+
+
+void stateEquations(unsigned type, const PhaseDerivatives &d, double x, double y, std::size_t column,
+                    double *f, double *row, std::size_t size)
+{
+    f[0] = d.x;
+    row[0] = d.cx[0];
+    row[1] = d.cx[1];
+    row[column] = d.xx;
+    row[column + 1] = d.xy;
+    row += size;
+    f[1] = d.y;
+    row[0] = d.cy[0];
+    row[1] = d.cy[1];
+    row[column] = d.xy;
+    row[column + 1] = d.yy;
+    if (type == 4)
+        return;
+    // Симметричная фаза
+    std::fill(row, row + size, 0.0);
+    row[column + 1] = 1.0;
+    f[1] = y;
+    if (type == 1)
+    {
+        row -= size;
+        std::fill(row, row + size, 0.0);
+        row[column] = 1.0;
+        f[0] = x;
+    }
+}
+
+
+void potentialDifference(const PhaseDerivatives &first, std::size_t firstColumn,
+                         const PhaseDerivatives &second, std::size_t secondColumn, double &f, double *row)
+{
+    f = first.v - second.v;
+    for (unsigned k = 0; k < 2; ++k)
+        row[k] = first.cv[k] - second.cv[k];
+    row[firstColumn] = first.x;
+    row[firstColumn + 1] = first.y;
+    row[secondColumn] = -second.x;
+    row[secondColumn + 1] = -second.y;
+}
+
+
+bool solveLinear(std::vector<double> &a, std::vector<double> &b, std::size_t n)
+{
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        std::size_t pivot = k;
+        for (std::size_t i = k + 1; i < n; ++i)
+            if (std::abs(a[i * n + k]) > std::abs(a[pivot * n + k]))
+                pivot = i;
+        if (a[pivot * n + k] == 0.0)
+            return false;
+        if (pivot != k)
+        {
+            std::swap_ranges(a.begin() + k * n, a.begin() + (k + 1) * n, a.begin() + pivot * n);
+            std::swap(b[k], b[pivot]);
+        }
+        for (std::size_t i = k + 1; i < n; ++i)
+        {
+            double factor = a[i * n + k] / a[k * n + k];
+            for (std::size_t j = k; j < n; ++j)
+                a[i * n + j] -= factor * a[k * n + j];
+            b[i] -= factor * b[k];
+        }
+    }
+    for (std::size_t k = n; k-- > 0; )
+    {
+        for (std::size_t j = k + 1; j < n; ++j)
+            b[k] -= a[k * n + j] * b[j];
+        b[k] /= a[k * n + k];
+    }
+    return std::all_of(b.cbegin(), b.cbegin() + n, [](double value) {return std::isfinite(value);});
+}
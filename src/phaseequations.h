@@ -0,0 +1,51 @@
+#ifndef PHASEEQUATIONS_H
+#define PHASEEQUATIONS_H
+
+#include <cstddef>
+#include <vector>
+#include "diagrampoint.h"
+
+/* Уравнения сосуществования фаз для уточнения особенностей диаграммы методом Ньютона
+ * (MulticriticalLocator, TransitionTracer).
+ * Неизвестные системы - Альфа1 (столбец 0 якобиана), Бета1 (столбец 1) и переменные фаз.
+ * Переменные фазы 4 - N[0] и N[1]^2 (потенциал PotentialS), поэтому она не может вырождаться
+ * в симметричную фазу с N[1] = 0. Переменные симметричных фаз 1-3 - N[0] и N[1] (потенциал PotentialN),
+ * но уравнения состояния, выполняющиеся тождественно (dPhi/dN[1] при N[1] = 0 и dPhi/dN[0] при N = 0),
+ * заменяются условиями N[1] = 0 и N[0] = 0: иначе якобиан вырожден там, где фаза теряет устойчивость
+ * по отношению к понижению симметрии.
+ */
+
+// Значение и производные потенциала до третьего порядка, а также производные по Альфа1 и Бета1 (индекс k) значения, первых и вторых производных
+struct PhaseDerivatives
+{
+    double v, x, y, xx, xy, yy, xxx, xxy, xyy, yyy;
+    double cv[2], cx[2], cy[2], cxx[2], cxy[2], cyy[2];
+};
+
+// Производные потенциала фазы типа type по её переменным (x, y) при коэффициентах c
+PhaseDerivatives phaseDerivatives(const double *c, unsigned type, double x, double y);
+// Производные потенциала по N = (x, y) (для проверки условий минимума)
+PhaseDerivatives orderDerivatives(const double *c, double x, double y);
+
+// Переменные фазы по её параметру порядка
+void phaseVariables(const PhaseInfo &phase, double &x, double &y);
+/* Параметр порядка n фазы типа type по её переменным (знак N[1] фазы 4 - sign).
+ * Возвращает false, если переменные фазы 4 не соответствуют никакому N (N[1]^2 <= 0).
+ */
+bool orderParameter(unsigned type, double x, double y, double sign, double n[2]);
+
+/* Уравнения состояния фазы: невязки f[0], f[1] и строки якобиана row, row + size
+ * (size - число неизвестных, column - номер столбца первой переменной фазы)
+ */
+void stateEquations(unsigned type, const PhaseDerivatives &d, double x, double y, std::size_t column,
+                    double *f, double *row, std::size_t size);
+// Уравнение равенства потенциалов двух фаз: невязка f и строка якобиана row (заполняются только ненулевые элементы)
+void potentialDifference(const PhaseDerivatives &first, std::size_t firstColumn,
+                         const PhaseDerivatives &second, std::size_t secondColumn, double &f, double *row);
+
+/* Решает систему a * x = b порядка n (матрица a хранится по строкам) методом Гаусса с выбором
+ * главного элемента, решение помещается в b. Возвращает false, если матрица вырождена.
+ */
+bool solveLinear(std::vector<double> &a, std::vector<double> &b, std::size_t n);
+
+#endif // PHASEEQUATIONS_H
@@ -0,0 +1,270 @@
+#ifndef PHASEMODEL_H
+#define PHASEMODEL_H
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "landaupotential.h"
+#include "diagrampoint.h"
+
+/* Модель фазовой диаграммы: потенциал (списки мономов, см. LandauPotential), анзацы фаз и уравнения состояния.
+ * Модель - список анзацев PhaseModel<Ansatz...>, каждый анзац находит фазы своего вида по своим уравнениям
+ * состояния. Модель собирается шаблонами на этапе компиляции: уравнения состояния строятся из мономов
+ * потенциала constexpr-функциями, анзацы разворачиваются в линейный код, так что ядро новой модели
+ * не медленнее написанного вручную. Готовые модели - в phasemodels.h.
+ *
+ * Анзацы обращаются к поиску корней и проверке устойчивости через объект Solver
+ * (DiagramEngine::PhaseSolver), который учитывает показатели производительности и плохую обусловленность:
+ *   c                                     - коэффициенты потенциала;
+ *   eps                                   - порог отбрасывания вырожденных решений;
+ *   solve(equation)                       - корни полинома;
+ *   solveCubics(n, coeffs, roots, counts) - пакет кубических уравнений;
+ *   isStable<Potential>(x, y, phi)        - условия минимума Potential в точке (x, y) и потенциал phi.
+ */
+
+
+// Целая степень целого числа (для проекций мономов)
+constexpr int integerPower(int x, unsigned n)
+{
+    int res = 1;
+    for (unsigned i = 0; i < n; ++i)
+        res *= x;
+    return res;
+}
+
+
+// Число мономов, не обращающихся в ноль на прямой (x, y) = s * (cx, cy)
+template<std::size_t N>
+constexpr std::size_t lineSize(const std::array<Monomial, N> &terms, int cx, int cy)
+{
+    std::size_t size = 0;
+    for (const Monomial &term : terms)
+        if (term.factor * integerPower(cx, term.x) * integerPower(cy, term.y) != 0)
+            ++size;
+    return size;
+}
+
+
+// Мономы потенциала на прямой (x, y) = s * (cx, cy) как функции s (переменная x, степень y равна 0)
+template<std::size_t Size, std::size_t N>
+constexpr std::array<Monomial, Size> lineTerms(const std::array<Monomial, N> &terms, int cx, int cy)
+{
+    std::array<Monomial, Size> res {};
+    std::size_t size = 0;
+    for (const Monomial &term : terms)
+    {
+        int factor = term.factor * integerPower(cx, term.x) * integerPower(cy, term.y);
+        if (factor != 0)
+            res[size++] = {factor, term.coefficient, term.x + term.y, 0};
+    }
+    return res;
+}
+
+
+// Источник мономов потенциала Source на прямой (x, y) = s * (CX, CY)
+template<class Source, int CX, int CY>
+struct LineTerms
+{
+    static constexpr std::array<Monomial, lineSize(Source::terms, CX, CY)> terms =
+            lineTerms<lineSize(Source::terms, CX, CY)>(Source::terms, CX, CY);
+};
+
+
+// Наибольшая степень y среди мономов
+template<std::size_t N>
+constexpr unsigned maxDegreeY(const std::array<Monomial, N> &terms)
+{
+    unsigned res = 0;
+    for (const Monomial &term : terms)
+        if (term.y > res)
+            res = term.y;
+    return res;
+}
+
+
+// Типы фаз на прямой по знаку s: Negative при s < 0, Positive при s >= 0
+template<unsigned Negative, unsigned Positive>
+struct SignTypes
+{
+    static unsigned type(double s)
+    {
+        return s < 0 ? Negative : Positive;
+    }
+};
+
+// Фазы на прямой, эквивалентные при смене знака s (учитывается решение с s > 0, тип Type)
+template<unsigned Type>
+struct PositiveType
+{
+    static unsigned type(double s)
+    {
+        return s > 0 ? Type : 0;
+    }
+};
+
+
+// Начало координат с нулевым квадратичным членом не считается минимумом (см. OriginPhase)
+struct DegenerateOriginUnstable
+{
+    static bool stable(const double *)
+    {
+        return false;
+    }
+};
+
+
+/* Анзац: фаза Type с нулевым параметром порядка, устойчивая при положительном коэффициенте c[Coefficient] квадратичного члена.
+ * При нулевом коэффициенте (граница устойчивости фазы) условия второго порядка вырождены,
+ * и устойчивость по членам высших степеней определяет Degenerate::stable(c).
+ */
+template<unsigned Type, unsigned Coefficient, class Degenerate = DegenerateOriginUnstable>
+struct OriginPhase
+{
+    template<class Solver>
+    static void find(Solver &solver, std::vector<PhaseInfo> &info)
+    {
+        if (solver.c[Coefficient] > 0 || (solver.c[Coefficient] == 0 && Degenerate::stable(solver.c)))
+            info.push_back({.type = Type, .phi = 0.0, .n = {0.0, 0.0}});
+    }
+};
+
+
+/* Анзац: фазы с параметром порядка (x, y) = s * (CX, CY), Source - мономы потенциала от x и y.
+ * Уравнение состояния dPhi/ds = 0, делённое на s, - полином от s; устойчивость проверяется
+ * по потенциалу от x и y, т. е. в том числе по отношению к отклонениям параметра порядка с прямой.
+ * Types - тип фазы по s (SignTypes, PositiveType; 0 - решение не учитывается).
+ */
+template<class Source, int CX, int CY, class Types>
+struct LinePhases
+{
+    typedef LandauPotential<Source> Potential;
+    typedef LandauPotential<LineTerms<Source, CX, CY>> Restricted;
+
+    template<class Solver>
+    static void find(Solver &solver, std::vector<PhaseInfo> &info)
+    {
+        Polynomial equation = Restricted::template Derivative<1, 0>::template row<0, 1>(solver.c);
+        for (double s : solver.solve(equation))
+        {
+            const unsigned type = Types::type(s);
+            const double x = component<CX>(s), y = component<CY>(s);
+            double f;
+            if (type && solver.template isStable<Potential>(x, y, f))
+                info.push_back({.type = type, .phi = f, .n = {x, y}});
+        }
+    }
+private:
+    template<int C>
+    static double component(double s)
+    {
+        if constexpr (C == 0)
+            return 0.0;
+        else if constexpr (C == 1)
+            return s;
+        else
+            return C * s;
+    }
+};
+
+
+/* Анзац: фазы общего положения по инвариантам x = I[0], y = I[1]; Source - мономы потенциала от инвариантов,
+ * не выше второй степени по I[1]. Уравнения состояния
+ * dPhi/dI[0] = A * I[1]^2 + B * I[1] + C = 0, dPhi/dI[1] = E * I[1] + F = 0
+ * (A, B, C, E, F - полиномы от I[0]) сводятся к одному полиному от I[0].
+ * Recovery - переход от инвариантов к параметру порядка:
+ *   admissible(I)                     - инварианты соответствуют фазе общего положения;
+ *   recover(solver, inv, phi, info)   - добавляет в info фазы с инвариантами inv[k] и потенциалами phi[k].
+ */
+template<class Source, class Recovery>
+struct InvariantPhases
+{
+    typedef LandauPotential<Source> Potential;
+    static_assert(maxDegreeY(Source::terms) <= 2, "InvariantPhases requires a potential quadratic in I[1]");
+
+    template<class Solver>
+    static void find(Solver &solver, std::vector<PhaseInfo> &info)
+    {
+        const double *c = solver.c;
+        std::vector<std::array<double, 2>> inv;
+        Polynomial A = Potential::template Derivative<1, 0>::template row<2>(c);
+        Polynomial B = Potential::template Derivative<1, 0>::template row<1>(c);
+        Polynomial C = Potential::template Derivative<1, 0>::template row<0>(c);
+        Polynomial E = Potential::template Derivative<0, 1>::template row<1>(c);
+        Polynomial F = Potential::template Derivative<0, 1>::template row<0>(c);
+        Polynomial equation;
+        if (isZero(A))
+        {
+            if (isZero(E))
+            {
+                equation = F;
+                for (double value : solver.solve(equation))
+                {
+                    double BB = B(value);
+                    if (std::abs(BB) > Solver::eps)
+                        inv.push_back({value, -C(value) / BB});
+                }
+            }
+            else
+            {
+                equation = B * F - C * E;
+                for (double value : solver.solve(equation))
+                    inv.push_back({value, -F(value) / E(value)});
+            }
+        }
+        else
+        {
+            Polynomial D = B * B - 4 * A * C;
+            Polynomial G = B * E - 2 * A * F;
+            equation = E * E * D - G * G;
+            for (double value : solver.solve(equation))
+            {
+                double DD = D(value);
+                if (DD >= 0)
+                {
+                    double t;
+                    if (E(value) * G(value) >= 0)
+                        t = 0.5 * (-B(value) + sqrt(D(value))) / A(value);
+                    else
+                        t = 0.5 * (-B(value) - sqrt(D(value))) / A(value);
+                    inv.push_back({value, t});
+                }
+            }
+        }
+        // Устойчивые решения передаются Recovery одним пакетом
+        std::vector<std::array<double, 2>> stable;
+        std::vector<double> phi;
+        for (auto item : inv)
+        {
+            double f;
+            if (Recovery::admissible(item) && solver.template isStable<Potential>(item[0], item[1], f))
+            {
+                stable.push_back(item);
+                phi.push_back(f);
+            }
+        }
+        Recovery::recover(solver, stable, phi, info);
+    }
+private:
+    static bool isZero(const Polynomial &p)
+    {
+        for (std::size_t k = 0; k < p.size(); ++k)
+            if (p[k] != 0.0)
+                return false;
+        return true;
+    }
+};
+
+
+// Модель - последовательность анзацев; фазы добавляются в порядке анзацев
+template<class... Ansatz>
+struct PhaseModel
+{
+    template<class Solver>
+    static void phases(Solver &solver, std::vector<PhaseInfo> &info)
+    {
+        (Ansatz::find(solver, info), ...);
+    }
+};
+
+#endif // PHASEMODEL_H
@@ -0,0 +1,141 @@
+#ifndef PHASEMODELS_H
+#define PHASEMODELS_H
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include "phasemodel.h"
+
+/* Модели, доступные DiagramEngine::setModel() (см. PhaseModel).
+ * Коэффициенты всех моделей хранятся в Coefficients::c; осями диаграммы служат Альфа1 и Бета1.
+ */
+
+
+/* Переход от инвариантов к параметру порядка для модели 3m: I[0] = N[0]^2 + N[1]^2,
+ * I[1] = 4 * N[0]^3 - 3 * N[0] * I[0]; N[0] - корень кубического уравнения 4 * r^3 - 3 * I[0] * r - I[1] = 0
+ * (уравнения всех фаз решаются одним пакетом)
+ */
+template<unsigned Type>
+struct TrigonalRecovery
+{
+    static bool admissible(const std::array<double, 2> &I)
+    {
+        return I[0] > 0;
+    }
+
+    template<class Solver>
+    static void recover(Solver &solver, const std::vector<std::array<double, 2>> &inv, const std::vector<double> &phi,
+                        std::vector<PhaseInfo> &info)
+    {
+        std::vector<std::array<double, 4>> cubics;
+        for (const auto &item : inv)
+            cubics.push_back({-1 * item[1], -3 * item[0], 0.0, 4});
+        std::vector<std::array<double, 3>> r(cubics.size());
+        std::vector<unsigned> counts(cubics.size());
+        solver.solveCubics(cubics.size(), cubics.data(), r.data(), counts.data());
+        for (std::size_t k = 0; k < cubics.size(); ++k)
+        {
+            double sq = inv[k][0] - r[k][0] * r[k][0];
+            if (sq > Solver::eps)
+                info.push_back({.type = Type, .phi = phi[k], .n = {r[k][0], sqrt(sq)}});
+        }
+    }
+};
+
+
+// Начало координат модели 3m при Альфа1 = 0: минимум, если нет кубического члена (Бета1 = 0) и член I1^2 положителен
+struct TrigonalDegenerateOrigin
+{
+    static bool stable(const double *c)
+    {
+        return c[Beta1] == 0 && c[Alpha2] > 0;
+    }
+};
+
+
+/* Модель 3m (исходная модель программы): двухкомпонентный параметр порядка N, потенциал PotentialN до 8-й степени.
+ * Фаза 1 - N = 0, фазы 2 и 3 - N[1] = 0 (N[0] < 0 и N[0] > 0), фаза 4 - общего положения (по инвариантам PotentialI).
+ */
+typedef PhaseModel<OriginPhase<1, Alpha1, TrigonalDegenerateOrigin>,
+                   LinePhases<PotentialNTerms, 1, 0, SignTypes<2, 3>>,
+                   InvariantPhases<PotentialITerms, TrigonalRecovery<4>>> Model3m;
+
+
+/* Потенциал модели 4mm как функция компонент x = N[0], y = N[1] параметра порядка
+ * через инварианты I1 = x^2 + y^2 и I2 = x^2 * y^2:
+ * a[0]*I1 + a[1]*I1^2 + a[2]*I1^3 + a[3]*I1^4 + b[0]*I2 + b[1]*I2^2 + d[0]*I1*I2 + d[1]*I1^2*I2
+ * (d[2] не используется: других инвариантов до 8-й степени нет).
+ */
+struct Tetragonal4mmNTerms
+{
+    static constexpr std::array<Monomial, 21> terms {{
+        {1, Alpha4, 0, 8},
+        {1, Alpha3, 0, 6}, {4, Alpha4, 2, 6}, {1, Delta2, 2, 6},
+        {1, Alpha2, 0, 4}, {3, Alpha3, 2, 4}, {1, Delta1, 2, 4}, {6, Alpha4, 4, 4}, {1, Beta2, 4, 4}, {2, Delta2, 4, 4},
+        {1, Alpha1, 0, 2}, {2, Alpha2, 2, 2}, {1, Beta1, 2, 2}, {3, Alpha3, 4, 2}, {1, Delta1, 4, 2},
+        {4, Alpha4, 6, 2}, {1, Delta2, 6, 2},
+        {1, Alpha1, 2, 0}, {1, Alpha2, 4, 0}, {1, Alpha3, 6, 0}, {1, Alpha4, 8, 0}
+    }};
+};
+
+// Потенциал модели 4mm как функция инвариантов x = I1, y = I2
+struct Tetragonal4mmITerms
+{
+    static constexpr std::array<Monomial, 8> terms {{
+        {1, Beta2, 0, 2},
+        {1, Beta1, 0, 1}, {1, Delta1, 1, 1}, {1, Delta2, 2, 1},
+        {1, Alpha1, 1, 0}, {1, Alpha2, 2, 0}, {1, Alpha3, 3, 0}, {1, Alpha4, 4, 0}
+    }};
+};
+
+
+/* Переход от инвариантов к параметру порядка для модели 4mm: N[0]^2 и N[1]^2 - корни z^2 - I[0] * z + I[1] = 0.
+ * Фаза общего положения - при I[1] > 0 и различных корнях (иначе это фазы на осях или диагоналях).
+ */
+template<unsigned Type>
+struct TetragonalRecovery
+{
+    static bool admissible(const std::array<double, 2> &I)
+    {
+        return I[1] > 0 && I[0] * I[0] - 4 * I[1] > 0;
+    }
+
+    template<class Solver>
+    static void recover(Solver &, const std::vector<std::array<double, 2>> &inv, const std::vector<double> &phi,
+                        std::vector<PhaseInfo> &info)
+    {
+        for (std::size_t k = 0; k < inv.size(); ++k)
+        {
+            // Больший корень - без вычитания близких чисел, меньший - по теореме Виета
+            double first = 0.5 * (inv[k][0] + sqrt(inv[k][0] * inv[k][0] - 4 * inv[k][1]));
+            double second = inv[k][1] / first;
+            if (second > Solver::eps && first - second > Solver::eps)
+                info.push_back({.type = Type, .phi = phi[k], .n = {sqrt(first), sqrt(second)}});
+        }
+    }
+};
+
+
+/* Начало координат модели 4mm при Альфа1 = 0: минимум, если форма четвёртой степени a[1] * I1^2 + b[0] * I2
+ * положительно определена (0 <= I2 <= I1^2 / 4)
+ */
+struct TetragonalDegenerateOrigin
+{
+    static bool stable(const double *c)
+    {
+        return c[Alpha2] > 0 && 4 * c[Alpha2] + c[Beta1] > 0;
+    }
+};
+
+
+/* Модель 4mm: двухкомпонентный параметр порядка с тетрагональной анизотропией (потенциал Tetragonal4mmNTerms).
+ * Фаза 1 - N = 0, фаза 2 - на оси (N[1] = 0), фаза 3 - на диагонали (N[0] = N[1]),
+ * фаза 4 - общего положения (по инвариантам Tetragonal4mmITerms). Эквивалентные по симметрии решения
+ * (N[0] < 0 и т. п.) не различаются.
+ */
+typedef PhaseModel<OriginPhase<1, Alpha1, TetragonalDegenerateOrigin>,
+                   LinePhases<Tetragonal4mmNTerms, 1, 0, PositiveType<2>>,
+                   LinePhases<Tetragonal4mmNTerms, 1, 1, PositiveType<3>>,
+                   InvariantPhases<Tetragonal4mmITerms, TetragonalRecovery<4>>> Model4mm;
+
+#endif // PHASEMODELS_H
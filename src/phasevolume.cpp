@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include "phasevolume.h"
+
+
+namespace
+{
+    // DiagramEngine для расчёта слоя: прерывает расчёт слоя, когда прерван расчёт всего объёма
+    class SliceEngine : public DiagramEngine
+    {
+    private:
+        const std::atomic<bool> &stop;
+    protected:
+        void progress(int) override
+        {
+            if (stop)
+                cancel();
+        }
+    public:
+        SliceEngine(std::size_t w, std::size_t h, const std::atomic<bool> &flag)
+            : DiagramEngine(w, h), stop(flag)
+        {
+
+        }
+    };
+
+    // Тип наиболее устойчивой фазы в каждой точке слоя (по столбцам: индекс i * height + j)
+    void stablestTypes(const CompressedDiagram &slice, std::vector<std::uint8_t> &types)
+    {
+        const std::size_t width = slice.columnsCount(), height = slice.rowsCount();
+        std::vector<DiagramPoint> column;
+        types.resize(width * height);
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            slice.column(i, column);
+            for (std::size_t j = 0; j < height; ++j)
+                types[i * height + j] = column[j].stablest == -1 ? 0 : column[j].phases[column[j].stablest].type;
+        }
+    }
+}
+
+
+PhaseVolume::PhaseVolume()
+    : dX(0.0), dY(0.0), width(0), height(0), depth(0), axis(1), from(0.0), to(0.0), cancelled(false), complete(false)
+{
+
+}
+
+
+PhaseVolume::~PhaseVolume()
+{
+
+}
+
+
+void PhaseVolume::setParameters(const Coefficients coefficients, const double stepX, const double stepY, std::size_t w, std::size_t h,
+                                const unsigned coefficient, const double first, const double last, std::size_t count)
+{
+    coeffs = coefficients;
+    dX = stepX;
+    dY = stepY;
+    width = w;
+    height = h;
+    axis = coefficient;
+    from = first;
+    to = last;
+    depth = count;
+    complete = false;
+}
+
+
+void PhaseVolume::progress(int)
+{
+
+}
+
+
+void PhaseVolume::calculate()
+{
+    cancelled = false;
+    complete = false;
+    slices.assign(depth, CompressedDiagram());
+    statistics.assign(depth, DiagramStatistics());
+    const std::size_t threadsCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), depth));
+    // Полоса - несколько соседних слоёв; в среднем 4 полосы на поток, чтобы потоки заканчивали работу одновременно
+    const std::size_t slab = std::max<std::size_t>(1, depth / (4 * threadsCount));
+    std::atomic<std::size_t> next(0), done(0);
+    auto compute = [this, slab, &next, &done]()
+    {
+        SliceEngine engine(width, height, cancelled);
+        engine.setCompressedStorage(true);
+        Coefficients c = coeffs;
+        for (std::size_t first; !cancelled && (first = next.fetch_add(slab)) < depth; )
+            for (std::size_t k = first; k < std::min(first + slab, depth) && !cancelled; ++k)
+            {
+                c.c[axis] = getValue(k);
+                engine.setParameters(c, dX, dY);
+                engine.calculate();
+                if (engine.isCancelled())
+                    return;
+                // Слой забирается без копирования, объект engine получает пустые данные для следующего слоя
+                engine.swapCompressed(slices[k]);
+                statistics[k] = engine.getStatistics();
+                progress(static_cast<int>(100 * ++done / depth));
+            }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < threadsCount; ++t)
+        threads.emplace_back(compute);
+    compute();
+    for (auto &t : threads)
+        t.join();
+    complete = !cancelled;
+}
+
+
+void PhaseVolume::cancel()
+{
+    cancelled = true;
+}
+
+
+bool PhaseVolume::isComplete() const
+{
+    return complete;
+}
+
+
+std::size_t PhaseVolume::getWidth() const
+{
+    return width;
+}
+
+
+std::size_t PhaseVolume::getHeight() const
+{
+    return height;
+}
+
+
+std::size_t PhaseVolume::getDepth() const
+{
+    return depth;
+}
+
+
+unsigned PhaseVolume::getAxis() const
+{
+    return axis;
+}
+
+
+double PhaseVolume::getValue(std::size_t k) const
+{
+    return depth > 1 ? from + (to - from) * k / (depth - 1) : from;
+}
+
+
+Coefficients PhaseVolume::getCoefficients() const
+{
+    return coeffs;
+}
+
+
+double PhaseVolume::getStepX() const
+{
+    return dX;
+}
+
+
+double PhaseVolume::getStepY() const
+{
+    return dY;
+}
+
+
+const DiagramPoint &PhaseVolume::at(std::size_t i, std::size_t j, std::size_t k) const
+{
+    return slices[k].at(i, j);
+}
+
+
+DiagramStatistics PhaseVolume::getStatistics() const
+{
+    DiagramStatistics res;
+    res.reset(dX, dY);
+    for (const DiagramStatistics &s : statistics)
+        res += s;
+    return res;
+}
+
+
+const DiagramStatistics &PhaseVolume::getStatistics(std::size_t k) const
+{
+    return statistics[k];
+}
+
+
+std::size_t PhaseVolume::memoryUsage() const
+{
+    std::size_t res = 0;
+    for (const CompressedDiagram &slice : slices)
+        res += slice.memoryUsage();
+    return res;
+}
+
+
+bool PhaseVolume::exportBoundaries(const std::string &fileName) const
+{
+    if (!complete)
+        return false;
+    std::ofstream stream(fileName);
+    if (!stream)
+        return false;
+    stream.precision(17);
+    stream << "# phase boundaries: beta1 alpha1 coefficient " << axis << '\n';
+    // Полушаги по осям (центры граней - посередине между точками)
+    const double hx = dX / 2, hy = dY / 2, hz = depth > 1 ? (to - from) / (depth - 1) / 2 : 0.0;
+    std::pair<unsigned, unsigned> group(~0u, ~0u);
+    // Грань между точками с фазами a и b, corners - координаты её вершин
+    auto face = [&stream, &group](unsigned a, unsigned b, const double (&corners)[4][3])
+    {
+        std::pair<unsigned, unsigned> pair(std::min(a, b), std::max(a, b));
+        if (pair != group)
+        {
+            group = pair;
+            stream << "g phases_" << pair.first << '_' << pair.second << '\n';
+        }
+        for (const auto &v : corners)
+            stream << "v " << v[0] << ' ' << v[1] << ' ' << v[2] << '\n';
+        stream << "f -4 -3 -2 -1\n";
+    };
+    std::vector<std::uint8_t> current, following;
+    if (depth)
+        stablestTypes(slices[0], current);
+    for (std::size_t k = 0; k < depth && stream; ++k)
+    {
+        if (k + 1 < depth)
+            stablestTypes(slices[k + 1], following);
+        const double z = getValue(k);
+        for (std::size_t i = 0; i < width; ++i)
+            for (std::size_t j = 0; j < height; ++j)
+            {
+                const unsigned type = current[i * height + j];
+                const double x = coeffs.b[0] + i * dX, y = coeffs.a[0] + (height - 1 - j) * dY;
+                if (i + 1 < width && current[(i + 1) * height + j] != type)
+                    face(type, current[(i + 1) * height + j],
+                         {{x + hx, y - hy, z - hz}, {x + hx, y + hy, z - hz}, {x + hx, y + hy, z + hz}, {x + hx, y - hy, z + hz}});
+                if (j + 1 < height && current[i * height + j + 1] != type)
+                    face(type, current[i * height + j + 1],
+                         {{x - hx, y - hy, z - hz}, {x + hx, y - hy, z - hz}, {x + hx, y - hy, z + hz}, {x - hx, y - hy, z + hz}});
+                if (k + 1 < depth && following[i * height + j] != type)
+                    face(type, following[i * height + j],
+                         {{x - hx, y - hy, z + hz}, {x + hx, y - hy, z + hz}, {x + hx, y + hy, z + hz}, {x - hx, y + hy, z + hz}});
+            }
+        current.swap(following);
+    }
+    stream.close();
+    return !stream.fail();
+}
@@ -0,0 +1,75 @@
+#ifndef PHASEVOLUME_H
+#define PHASEVOLUME_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "diagramengine.h"
+
+/* Трёхмерная фазовая диаграмма по осям Бета1, Альфа1 и X, где X - любой другой коэффициент потенциала.
+ * Объём хранится по слоям X = const, каждый слой - двумерная диаграмма в сжатом виде (CompressedDiagram),
+ * поэтому память пропорциональна числу границ областей, а не числу точек.
+ * Слои рассчитываются параллельно: потоки по очереди берут полосы (slabs) из нескольких соседних слоёв.
+ * Каждый поток использует для всех своих слоёв один объект DiagramEngine: рабочая память поиска корней,
+ * буферы столбцов и ключей переходов выделяются один раз, а рассчитанный слой забирается без копирования.
+ */
+
+class PhaseVolume
+{
+private:
+    Coefficients coeffs;                        // Коэффициенты (Альфа1 и Бета1 - стартовые значения)
+    double dX, dY;                              // Шаги по Бета1 и Альфа1
+    std::size_t width, height, depth;           // Размеры: число точек по Бета1, Альфа1 и число слоёв по X
+    unsigned axis;                              // Номер коэффициента X в Coefficients::c
+    double from, to;                            // Диапазон X
+    std::vector<CompressedDiagram> slices;      // Слои
+    std::vector<DiagramStatistics> statistics;  // Статистика слоёв
+    std::atomic<bool> cancelled;
+    bool complete;                              // Все слои рассчитаны
+protected:
+    // Вызывается из потоков расчёта после каждого рассчитанного слоя (percent - процент выполнения)
+    virtual void progress(int percent);
+public:
+    PhaseVolume();
+    virtual ~PhaseVolume();
+    /* Установка параметров. coefficients, stepX и stepY - как при расчёте обычной диаграммы размером w x h;
+     * coefficient - номер коэффициента X в Coefficients::c (кроме Альфа1 и Бета1), меняющегося от first до last
+     * в count слоях. Функция должна быть вызвана перед вызовом calculate().
+     */
+    void setParameters(const Coefficients coefficients, const double stepX, const double stepY, std::size_t w, std::size_t h,
+                       const unsigned coefficient, const double first, const double last, std::size_t count);
+    // Расчёт всех слоёв (прерывается функцией cancel())
+    void calculate();
+    // Прерывает расчёт (может вызываться из любого потока)
+    void cancel();
+    // Возвращает true, если рассчитаны все слои
+    bool isComplete() const;
+    std::size_t getWidth() const;
+    std::size_t getHeight() const;
+    std::size_t getDepth() const;
+    // Номер коэффициента X в Coefficients::c и его значение в слое k
+    unsigned getAxis() const;
+    double getValue(std::size_t k) const;
+    // Возвращает коэффициенты и шаги по Бета1 (X) и Альфа1 (Y), как у слоёв
+    Coefficients getCoefficients() const;
+    double getStepX() const;
+    double getStepY() const;
+    /* Возвращает информацию о точке (i, j) слоя k (строка j = 0 - наибольшее Альфа1).
+     * Ссылка действительна до следующего вызова (см. CompressedDiagram::at()).
+     */
+    const DiagramPoint &at(std::size_t i, std::size_t j, std::size_t k) const;
+    // Статистика всего объёма (доли - объёмные) и слоя k
+    DiagramStatistics getStatistics() const;
+    const DiagramStatistics &getStatistics(std::size_t k) const;
+    // Объём памяти, занимаемый слоями (в байтах, приблизительно)
+    std::size_t memoryUsage() const;
+    /* Записывает поверхности границ областей наиболее устойчивых фаз в файл Wavefront OBJ:
+     * для каждой пары соседних точек с разными наиболее устойчивыми фазами - квадратная грань между ними,
+     * грани сгруппированы по парам фаз (группы phases_A_B, 0 - нет устойчивых фаз).
+     * Вершины задаются координатами (Бета1, Альфа1, X). Объём обрабатывается по два соседних слоя.
+     * Возвращает false в случае ошибки.
+     */
+    bool exportBoundaries(const std::string &fileName) const;
+};
+
+#endif // PHASEVOLUME_H
@@ -1,7 +1,10 @@
 #include "polynomial.h"
+#include "rootsolvers.h"
 #include <algorithm>
+#include <array>
 #include <functional>
 #include <cmath>
+#include <limits>
 
 #define _USE_MATH_DEFINES
 
@@ -10,6 +13,17 @@ using std::vector;
 using std::size_t;
 
 
+/* Методы по умолчанию выбраны калибровкой (rootsbenchmark --calibrate):
+ * уравнения до 4 степени решаются аналитически, более высоких степеней - методом Декарта.
+ * Диаграммы отличаются от рассчитанных методом Штурма на всём столбце Бета1 = 0: там у уравнения фаз 2/3
+ * нулевой линейный член (например, 19.8 + 4 s^2 + 5 s^3 + 12 s^4 + 3.5 s^5), и метод Штурма находил
+ * ложный корень s ~ -1e-5, дававший несуществующую фазу 2; метод Декарта этого корня не находит.
+ */
+RootSolver Polynomial::solvers[] = {RootSolver::Analytic, RootSolver::Analytic, RootSolver::Analytic,
+                                    RootSolver::Analytic, RootSolver::Analytic, RootSolver::Descartes,
+                                    RootSolver::Descartes, RootSolver::Descartes, RootSolver::Descartes};
+
+
 Polynomial::Polynomial(const std::initializer_list<double> &coefficients)
     : coeffs(coefficients)
 {
@@ -73,43 +87,163 @@ Polynomial &Polynomial::differentiate()
 }
 
 
+double Polynomial::rootCondition(double x) const
+{
+    return rootCondition(coeffs.data(), coeffs.size(), x);
+}
+
+
+double Polynomial::rootCondition(const double *coeffs, size_t size, double x)
+{
+    double ax = abs(x), sum = 0.0, f = 0.0, df = 0.0;
+    for (size_t i = size; i--; )
+    {
+        df = df * x + f;
+        f = f * x + coeffs[i];
+        sum = sum * ax + abs(coeffs[i]);
+    }
+    double denom = abs(df) * std::max(ax, 1.0);
+    return denom > 0.0 ? sum / denom : HUGE_VAL;
+}
+
+
+double Polynomial::polishRoot(double x) const
+{
+    return polishRoot(coeffs.data(), coeffs.size(), x);
+}
+
+
+double Polynomial::polishRoot(const double *coeffs, size_t size, double x)
+{
+    long double r = x;
+    for (unsigned n = 0; n < 50; ++n)
+    {
+        long double f = 0.0L, df = 0.0L;
+        for (size_t i = size; i--; )
+        {
+            df = df * r + f;
+            f = f * r + coeffs[i];
+        }
+        if (df == 0.0L)
+            break;
+        long double step = f / df;
+        r -= step;
+        if (std::abs(step) <= 4 * std::numeric_limits<long double>::epsilon() * std::max(std::abs(r), 1.0L))
+            break;
+    }
+    // Метод Ньютона ушёл к другому корню или разошёлся - корень остаётся прежним
+    if (!(std::abs(r - x) <= 1e-3 * std::max(abs(x), 1.0)))
+        return x;
+    return static_cast<double>(r);
+}
+
+
 vector<double> Polynomial::roots()
 {
     correctDegree();
-    switch (deg)
+    return roots(solver(deg));
+}
+
+
+vector<double> Polynomial::roots(RootSolver solver)
+{
+    // Рабочая память по умолчанию - своя для каждого потока
+    static thread_local SolverContext context;
+    return roots(solver, context);
+}
+
+
+const vector<double> &Polynomial::roots(SolverContext &context)
+{
+    correctDegree();
+    return roots(solver(deg), context);
+}
+
+
+const vector<double> &Polynomial::roots(RootSolver solver, SolverContext &context)
+{
+    correctDegree();
+    context.reset();
+    vector<double> &res = context.roots;
+    res.clear();
+    if (!deg)
     {
-        // Если степень меньше 5, решение аналитическое
-        case 0:
-            return vector<double>({0.0});
-            break;
-        case 1:
-            return getLinearEquationSolution();
+        res.push_back(0.0);
+        return res;
+    }
+    // Аналитическое решение возможно только для степеней меньше 5
+    if (solver == RootSolver::Analytic && deg > 4)
+        solver = RootSolver::Sturm;
+    switch (solver)
+    {
+        case RootSolver::Analytic:
+            switch (deg)
+            {
+                case 1:
+                    getLinearEquationSolution(res);
+                    break;
+                case 2:
+                    getQuadraticEquationSolution(res);
+                    break;
+                case 3:
+                    getCubicEquationSolution(res);
+                    break;
+                default:
+                    getQuarticEquationSolution(res);
+            }
             break;
-        case 2:
-            return getQuadraticEquationSolution();
+        case RootSolver::Descartes:
+            solveDescartes(*this, context, res);
             break;
-        case 3:
-            return getCubicEquationSolution();
+        case RootSolver::Aberth:
+            res = solveAberth(*this);
             break;
-        case 4:
-            return getQuarticEquationSolution();
+        case RootSolver::Companion:
+            res = solveCompanion(*this);
             break;
-        // Иначе решение численное
         default:
+        {
             double minX = getLowRootsLimit();
             double maxX = getHighRootsLimit();
-            createSturmSystem();
-            vector<double> res;
-            searchRoots(minX, maxX, res);
-            return res;
-            break;
+            SturmSystem system = createSturmSystem(context);
+            searchRoots(system, minX, maxX, res);
+        }
     }
+    return res;
+}
+
+
+const vector<double> &Polynomial::preciseRoots(SolverContext &context)
+{
+    correctDegree();
+    context.reset();
+    vector<double> &res = context.roots;
+    res.clear();
+    if (!deg)
+        res.push_back(0.0);
+    else
+        solveDescartesPrecise(*this, context, res);
+    return res;
+}
+
+
+void Polynomial::setSolver(size_t degree, RootSolver solver)
+{
+    if (degree <= maxSolverDegree)
+        solvers[degree] = solver;
+}
+
+
+RootSolver Polynomial::solver(size_t degree)
+{
+    return degree <= maxSolverDegree ? solvers[degree] : RootSolver::Sturm;
 }
 
 
 // Численно ищет корни на отрезке l..r
-void Polynomial::searchRoots(double l, double r, vector<double> &vec)
+void Polynomial::searchRoots(SturmSystem &system, double l, double r, vector<double> &vec)
 {
+    const Span *sturmSystem = system.members;
     double m = (l + r) / 2;
     // Тривиальный случай
     if ((r - l) < rootEps)
@@ -119,7 +253,7 @@ void Polynomial::searchRoots(double l, double r, vector<double> &vec)
     }
     // Число перемен знака в стандартной системе Штурма при x = l и x = r
     int leftChangesCount = 0, rightChangesCount = 0;
-    for (decltype(sturmSystem.size()) i = 1; i < sturmSystem.size(); ++i)
+    for (size_t i = 1; i < system.count; ++i)
     {
         if (sturmSystem[i - 1](l) * sturmSystem[i](l) < 0)
             ++leftChangesCount;
@@ -132,35 +266,41 @@ void Polynomial::searchRoots(double l, double r, vector<double> &vec)
     if (rootsCount > 1)
     {
         // Рекурсивные вызовы
-        searchRoots(l, m, vec);
-        searchRoots(m, r, vec);
+        searchRoots(system, l, m, vec);
+        searchRoots(system, m, r, vec);
     }
     else if (rootsCount == 1)
     {
         // Уточнение корня
-        double L = (*this)(l);
+        const Span &p = sturmSystem[0];
+        double L = p(l);
         double x;
-        // Вторая производная
-        Polynomial secondDerivative = (*this);
-        secondDerivative.differentiate().differentiate();
+        // Вторая производная (одна на все корни)
+        Span &secondDerivative = system.secondDerivative;
+        if (!secondDerivative.size)
+        {
+            secondDerivative = copy(p.c, p.size, system.context);
+            differentiate(secondDerivative);
+            differentiate(secondDerivative);
+        }
         // Выбор начального приближения для метода Ньтютона
         if (secondDerivative(m) > 0)
             x = L > 0 ? l : r;
         else
             x = L < 0 ? l : r;
-        if (findRootNewton(l, r, x, 20, sturmSystem[1]))
+        if (findRootNewton(p, l, r, x, 20, sturmSystem[1]))
             vec.push_back(x);
         else
             // Методом Ньютона найти не удалось, используем деление пополам
-            vec.push_back(findRootBisection(l, r));
+            vec.push_back(findRootBisection(p, l, r));
     }
 }
 
 
-double Polynomial::findRootBisection(double lX, double rX) const
+double Polynomial::findRootBisection(const Span &p, double lX, double rX)
 {
     // Поиск корня делением отрезка пополам
-    double lY = (*this)(lX), rY = (*this)(rX);
+    double lY = p(lX), rY = p(rX);
     while (abs(rX - lX) > rootEps)
     {
         if (abs(lY) < zeroEps)
@@ -170,7 +310,7 @@ double Polynomial::findRootBisection(double lX, double rX) const
         else
         {
             double mX = (lX + rX) / 2;
-            double mY = (*this)(mX);
+            double mY = p(mX);
             if (lY * mY <= 0.0)
             {
                 rX = mX;
@@ -187,7 +327,7 @@ double Polynomial::findRootBisection(double lX, double rX) const
 }
 
 
-bool Polynomial::findRootNewton(double l, double r, double &x, unsigned maxN, const Polynomial &dP) const
+bool Polynomial::findRootNewton(const Span &p, double l, double r, double &x, unsigned maxN, const Span &dP)
 {
     // Поиск корня методом Ньютона
     double val, f;
@@ -197,7 +337,7 @@ bool Polynomial::findRootNewton(double l, double r, double &x, unsigned maxN, co
         if (abs(val) < zeroEps || x < l || x > r || !(maxN--))
             // Вышли за границы отрезка (метод не сходится) или превысили максимально допустимое число итераций
             return false;
-        f = (*this)(x) / val;
+        f = p(x) / val;
         x -= f;
     }
     while (abs(f) > rootEps);
@@ -210,71 +350,153 @@ double Polynomial::getLowRootsLimit() const
     /* Нижняя граница корней полинома.
      * Для многочлена P(x) определяется как верхняя граница многочлена P(-x).
      */
-    Polynomial p = *this;
-    for (size_t i = 0; i <= p.degree(); ++i)
-        if (i % 2)
-            p.coeffs[i] *= -1;
-    return -1 * (p.getHighRootsLimit());
+    return -1 * (getHighRootsLimit(true));
 }
 
 
-double Polynomial::getHighRootsLimit() const
+double Polynomial::getHighRootsLimit(bool mirror) const
 {
     /* Верхняя граница корней полинома.
      * Для многочлена степени N с a[N] > 0 она равна 1 + (B/A[N])^(1/k),
      * где B - наибольшая из абсолютных величин отрицательных коэффициентов,
      * k определяется из условия: a[k] - старший из отрицательных коэффициентов.
+     * Коэффициенты не копируются: смена знака (для P(-x) - при нечётных степенях, для a[N] < 0 - всех)
+     * выполняется при обращении к ним.
      */
-    Polynomial p = *this;
-    if (p[p.degree()] < 0)
-        p = -p;
-    auto negativeRightPos = std::find_if(p.coeffs.crbegin(), p.coeffs.crend(), [](const double &val){return val < 0;});
-    if (negativeRightPos == p.coeffs.crend())
+    auto mirrored = [this, mirror](size_t i) {return mirror && i % 2 ? coeffs[i] * -1 : coeffs[i];};
+    bool negate = mirrored(deg) < 0;
+    auto p = [&mirrored, negate](size_t i) {return negate ? -mirrored(i) : mirrored(i);};
+    size_t index = 0;
+    double maxAbsNeg = 0.0;
+    for (size_t i = 0; i <= deg; ++i)
+    {
+        double value = p(i);
+        if (value < 0)
+            index = deg - i;
+        if (value < maxAbsNeg)
+            maxAbsNeg = value;
+    }
+    if (!(maxAbsNeg < 0))
         return 0;
+    return 1 + pow(-maxAbsNeg / p(deg), 1.0 / index);
+}
+
+
+double Polynomial::Span::operator()(double x) const
+{
+    auto index = size - 1;
+    double res = c[index];
+    while (index--)
+        res = res * x + c[index];
+    return res;
+}
+
+
+void Polynomial::correctDegree(Span &p)
+{
+    while (p.size > 1 && abs(p.c[p.size - 1]) < zeroEps)
+        --p.size;
+}
+
+
+void Polynomial::differentiate(Span &p)
+{
+    if (p.size > 1)
+    {
+        for (size_t i = 1; i < p.size; ++i)
+            p.c[i - 1] = i * p.c[i];
+        --p.size;
+        correctDegree(p);
+    }
     else
+        p.c[0] = 0.0;
+}
+
+
+Polynomial::Span Polynomial::copy(const double *coeffs, size_t count, SolverContext &context)
+{
+    Span res {context.allocate<double>(count), count};
+    std::copy(coeffs, coeffs + count, res.c);
+    return res;
+}
+
+
+Polynomial::Span Polynomial::remainder(const Span &p1, const Span &p2, SolverContext &context)
+{
+    // Остаток от деления на константу равен нулю
+    if (!p2.degree())
     {
-        auto index = p.coeffs.cend() - negativeRightPos.base();
-        auto maxAbsNegPos = std::min_element(p.coeffs.cbegin(), p.coeffs.cend());
-        return 1 + pow(-(*maxAbsNegPos) / p[p.degree()], 1.0 / index);
+        Span zero {context.allocate<double>(1), 1};
+        zero.c[0] = 0.0;
+        return zero;
     }
+    Span r = copy(p1.c, p1.size, context);
+    int d;
+    while ((d = r.degree() - p2.degree()) >= 0)
+    {
+        /* r -= p2 * t, t = q * x^d: коэффициенты произведения вычисляются как в PolynomialProduct
+         * (с нулевыми коэффициентами t), малые старшие отбрасываются, вычитание - как в operator-=
+         */
+        double q = r.c[r.degree()] / p2.c[p2.degree()];
+        size_t tSize = d + 1;
+        auto product = [&p2, q, d, tSize](size_t k)
+        {
+            double res = 0.0;
+            size_t last = std::min(k, p2.size - 1);
+            for (size_t i = k < tSize ? 0 : k - tSize + 1; i <= last; ++i)
+                res += p2.c[i] * (k - i == static_cast<size_t>(d) ? q : 0.0);
+            return res;
+        };
+        size_t count = p2.size + tSize - 1;
+        while (count > 1 && abs(product(count - 1)) < zeroEps)
+            --count;
+        for (size_t k = 0; k < count; ++k)
+            r.c[k] = -product(k) + r.c[k];
+        correctDegree(r);
+    }
+    return r;
 }
 
 
-void Polynomial::createSturmSystem()
+Polynomial::SturmSystem Polynomial::createSturmSystem(SolverContext &context) const
 {
     /* Построение стандартной системы Штурма
      * Первый член - исходный полином,
      * второй член - его производная,
      * третий и последующий члены - взятые с обратным знаком остатки от деления двух предыдущих друг на друга,
      * последний член - полином нулевой степени (константа).
+     * Степени членов, начиная со второго, убывают, поэтому их не больше deg + 2.
      */
-    sturmSystem.clear();
-    Polynomial p = *this;
-    sturmSystem.push_back(p);
-    sturmSystem.push_back(p.differentiate());
-    Polynomial r;
+    SturmSystem system {context.allocate<Span>(deg + 2), 0, {nullptr, 0}, context};
+    Span p = copy(coeffs.data(), coeffs.size(), context);
+    system.members[system.count++] = p;
+    p = copy(p.c, p.size, context);
+    differentiate(p);
+    system.members[system.count++] = p;
+    Span r;
     do
     {
-        r = sturmSystem[sturmSystem.size() - 2] % sturmSystem.back();
-        sturmSystem.push_back(-r);
+        r = remainder(system.members[system.count - 2], system.members[system.count - 1], context);
+        Span negated = copy(r.c, r.size, context);
+        std::transform(negated.c, negated.c + negated.size, negated.c, std::negate<double>());
+        correctDegree(negated);
+        system.members[system.count++] = negated;
     }
     while (r.degree());
+    return system;
 }
 
 
-vector<double> Polynomial::getLinearEquationSolution() const
+void Polynomial::getLinearEquationSolution(vector<double> &solution) const
 {
-    // Линейное уравнение (хотя корень один, результат объявлен как вектор, т.к. функция roots() возвращает вектор)
-    vector<double> solution;
+    // Линейное уравнение
     solution.push_back(-coeffs[0] / coeffs[1]);
-    return solution;
 }
 
 
-vector<double> Polynomial::getQuadraticEquationSolution() const
+void Polynomial::getQuadraticEquationSolution(vector<double> &solution) const
 {
     // Квадратное уравнение
-    vector<double> solution;
     const double &a = coeffs[2];
     const double &b = coeffs[1];
     const double &c = coeffs[0];
@@ -286,78 +508,114 @@ vector<double> Polynomial::getQuadraticEquationSolution() const
         solution.push_back(0.5 * (sqrt(d) - b) / a);
         solution.push_back(-0.5 * (sqrt(d) + b) / a);
     }
-    return solution;
 }
 
 
-vector<double> Polynomial::getCubicEquationSolution() const
+void Polynomial::getCubicEquationSolution(vector<double> &solution) const
 {
     // Кубическое уравнение (по формулам Кардано)
-    vector<double> solution;
-    const double &a = coeffs[3];
-    const double &b = coeffs[2];
-    const double &c = coeffs[1];
-    const double &d = coeffs[0];
-    double dd, q, p, t[2];
-    t[0] = b / (3 * a);
-    p = pow(t[0], 2) - c / (3 * a);
-    t[1] = pow(p, 3);
-    q = pow(t[0], 3) - (b * c / (3 * a) - d) / (2 * a);
-    dd = t[1] - pow(q, 2);
-    if (dd > 0)
-    {
-        double f = acos(-q / sqrt(t[1]));
-        for (size_t i = 0; i < 3; ++i)
-            solution.push_back(2 * sqrt(p) * cos((f + 2 * M_PI * i) / 3) - t[0]);
-    }
-    else
-        solution.push_back(cbrt(sqrt(-dd) - q) - cbrt(q + sqrt(-dd)) - t[0]);
-    return solution;
+    std::array<double, 4> c {coeffs[0], coeffs[1], coeffs[2], coeffs[3]};
+    std::array<double, 3> r;
+    unsigned count;
+    solveCubics(1, &c, &r, &count);
+    solution.assign(r.begin(), r.begin() + count);
 }
 
 
-vector<double> Polynomial::getQuarticEquationSolution() const
+void Polynomial::getQuarticEquationSolution(vector<double> &solution) const
 {
     // Уравнение четвёртой степени (метод Феррари)
-    vector<double> solution;
-    double b = coeffs[3] / coeffs[4];
-    double c = coeffs[2] / coeffs[4];
-    double d = coeffs[1] / coeffs[4];
-    double e = coeffs[0] / coeffs[4];
-    Polynomial resolvent({e * (4 * c - pow(b, 2)) - pow(d, 2),
-                          b * d - 4 * e,
-                          -c,
-                          1});
-    vector<double> temp = resolvent.getCubicEquationSolution();
-    double y = temp[0];
-    double t[2];
-    t[0] = pow(b / 2, 2) - c + y;
-    Polynomial quadratic(2);
-    quadratic[2] = 1.0;
-    if (abs(t[0]) < zeroEps)
+    std::array<double, 5> c {coeffs[0], coeffs[1], coeffs[2], coeffs[3], coeffs[4]};
+    std::array<double, 4> r;
+    unsigned count;
+    solveQuartics(1, &c, &r, &count);
+    solution.assign(r.begin(), r.begin() + count);
+}
+
+
+/* Ветви формул Кардано и Феррари вычисляются для каждого уравнения полностью, а результат выбирается
+ * по маске (условным выражением без переходов), поэтому все уравнения пакета обрабатываются одинаковой
+ * последовательностью операций и результат не зависит от положения уравнения в пакете.
+ * Это скалярный пакетный интерфейс: цикл по уравнениям компилятор не векторизует (GCC -O3 -fopt-info-vec:
+ * "control flow in loop" из-за вызовов acos, cbrt, cos), выигрыш - только в отсутствии выделений памяти.
+ * Целые степени вычисляются умножением: для квадратов это совпадает с pow() побитово, кубы могут
+ * отличаться в последнем разряде, поэтому корни отличаются от вычисленных через pow() на единицы ulp.
+ */
+
+namespace
+{
+    // Решение одного кубического уравнения; возвращает число корней (1 или 3)
+    inline unsigned cubicKernel(const double a, const double b, const double c, const double d, double *root)
     {
-        quadratic[1] = b / 2;
-        quadratic[0] = y / 2 - sqrt(pow(y / 2, 2) - e);
-        temp = quadratic.getQuadraticEquationSolution();
-        solution.insert(solution.end(), temp.begin(), temp.end());
-        quadratic[0] = y / 2 + sqrt(pow(y / 2, 2) - e);
-        temp = quadratic.getQuadraticEquationSolution();
-        solution.insert(solution.end(), temp.begin(), temp.end());
+        double t0 = b / (3 * a);
+        double p = t0 * t0 - c / (3 * a);
+        double t1 = p * p * p;
+        double q = t0 * t0 * t0 - (b * c / (3 * a) - d) / (2 * a);
+        double dd = t1 - q * q;
+        bool three = dd > 0;
+        // Три вещественных корня (тригонометрическая формула)
+        double cosine = three ? -q / sqrt(t1) : 0.0;
+        double f = acos(std::min(std::max(cosine, -1.0), 1.0));
+        double r = 2 * sqrt(three ? p : 0.0);
+        // Один вещественный корень (формула Кардано)
+        double s = sqrt(three ? 0.0 : -dd);
+        double single = cbrt(s - q) - cbrt(q + s) - t0;
+        root[0] = three ? r * cos(f / 3) - t0 : single;
+        root[1] = r * cos((f + 2 * M_PI) / 3) - t0;
+        root[2] = r * cos((f + 4 * M_PI) / 3) - t0;
+        return three ? 3 : 1;
     }
-    else if (t[0] > 0)
+
+    /* Корни квадратного уравнения x^2 + b*x + c = 0 (при valid) дописываются в root начиная с позиции count.
+     * Массив root должен вмещать count + 2 элемента.
+     */
+    inline void quadraticKernel(const double b, const double c, const bool valid, const double zeroEps,
+                                double *root, unsigned &count)
     {
-        t[0] = sqrt(t[0]);
-        t[1] = b * y / 2 - d;
-        quadratic[1] = b / 2 - t[0];
-        quadratic[0] = 0.5 * (y - t[1] / t[0]);
-        temp = quadratic.getQuadraticEquationSolution();
-        solution.insert(solution.end(), temp.begin(), temp.end());
-        quadratic[1] = b / 2 + t[0];
-        quadratic[0] = 0.5 * (y + t[1] / t[0]);;
-        temp = quadratic.getQuadraticEquationSolution();
-        solution.insert(solution.end(), temp.begin(), temp.end());
+        double d = b * b - 4 * c;
+        bool one = valid && std::abs(d) < zeroEps;
+        bool two = valid && !one && d > 0;
+        double s = sqrt(two ? d : 0.0);
+        root[count] = one ? -0.5 * b : 0.5 * (s - b);
+        root[count + 1] = -0.5 * (s + b);
+        count += one + 2 * two;
+    }
+}
+
+
+void Polynomial::solveCubics(size_t n, const std::array<double, 4> *coeffs, std::array<double, 3> *roots, unsigned *counts)
+{
+    for (size_t k = 0; k < n; ++k)
+        counts[k] = cubicKernel(coeffs[k][3], coeffs[k][2], coeffs[k][1], coeffs[k][0], roots[k].data());
+}
+
+
+void Polynomial::solveQuartics(size_t n, const std::array<double, 5> *coeffs, std::array<double, 4> *roots, unsigned *counts)
+{
+    for (size_t k = 0; k < n; ++k)
+    {
+        double b = coeffs[k][3] / coeffs[k][4];
+        double c = coeffs[k][2] / coeffs[k][4];
+        double d = coeffs[k][1] / coeffs[k][4];
+        double e = coeffs[k][0] / coeffs[k][4];
+        // Наибольший корень кубической резольвенты
+        double resolvent[3];
+        cubicKernel(1, -c, b * d - 4 * e, e * (4 * c - b * b) - d * d, resolvent);
+        double y = resolvent[0];
+        double t0 = (b / 2) * (b / 2) - c + y;
+        // Разложение на два квадратных трёхчлена: при t0 = 0 и при t0 > 0 (при t0 < 0 вещественных корней нет)
+        bool zero = std::abs(t0) < zeroEps;
+        bool positive = !zero && t0 > 0;
+        double w = sqrt((y / 2) * (y / 2) - e);
+        double s = sqrt(positive ? t0 : 1.0);
+        double t1 = b * y / 2 - d;
+        double root[6];
+        unsigned count = 0;
+        quadraticKernel(zero ? b / 2 : b / 2 - s, zero ? y / 2 - w : 0.5 * (y - t1 / s), zero || positive, zeroEps, root, count);
+        quadraticKernel(zero ? b / 2 : b / 2 + s, zero ? y / 2 + w : 0.5 * (y + t1 / s), zero || positive, zeroEps, root, count);
+        std::copy(root, root + 4, roots[k].begin());
+        counts[k] = count;
     }
-    return solution;
 }
 
 
@@ -394,49 +652,6 @@ Polynomial &Polynomial::operator%=(const Polynomial &polynomial)
 }
 
 
-Polynomial operator+(const Polynomial &p1, const Polynomial &p2)
-{
-    Polynomial p(std::max(p1.coeffs.size(), p2.coeffs.size()) - 1);
-    std::copy(p1.coeffs.cbegin(), p1.coeffs.cend(), p.coeffs.begin());
-    std::transform(p2.coeffs.cbegin(), p2.coeffs.cend(), p.coeffs.cbegin(), p.coeffs.begin(), std::plus<double>());
-    p.correctDegree();
-    return p;
-}
-
-
-Polynomial operator-(const Polynomial &p1, const Polynomial &p2)
-{
-    return (-p2) + p1;
-}
-
-
-Polynomial operator*(const Polynomial &p1, const Polynomial &p2)
-{
-    Polynomial p(p1.coeffs.size() + p2.coeffs.size() - 2);
-    for (decltype(p1.coeffs.size()) i = 0; i < p1.coeffs.size(); ++i)
-        for (decltype(p2.coeffs.size()) j = 0; j < p2.coeffs.size(); ++j)
-            p[i + j] += p1[i] * p2[j];
-    p.correctDegree();
-    return p;
-}
-
-
-Polynomial operator*(const Polynomial &polynomial, const double &value)
-{
-    Polynomial p(polynomial.deg);
-    std::transform(polynomial.coeffs.cbegin(), polynomial.coeffs.cend(),
-                   p.coeffs.begin(), std::bind(std::multiplies<double>(), std::placeholders::_1, value));
-    p.correctDegree();
-    return p;
-}
-
-
-Polynomial operator*(const double &value, const Polynomial &polynomial)
-{
-    return polynomial * value;
-}
-
-
 Polynomial Polynomial::operator-() const
 {
     Polynomial p(deg);
@@ -448,6 +663,9 @@ Polynomial Polynomial::operator-() const
 
 Polynomial operator%(const Polynomial &p1, const Polynomial &p2)
 {
+    // Остаток от деления на константу равен нулю (иначе цикл ниже не завершится)
+    if (!p2.degree())
+        return Polynomial();
     Polynomial r = p1;
     int d;
     while ((d = r.degree() - p2.degree()) >= 0)
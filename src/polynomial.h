@@ -1,49 +1,114 @@
 #ifndef POLYNOMIAL_H
 #define POLYNOMIAL_H
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <initializer_list>
+#include <type_traits>
 #include <vector>
+#include "solvercontext.h"
+
+/* Методы поиска вещественных корней:
+ * Analytic - формулы Кардано и Феррари (только для степеней до 4),
+ * Sturm - изоляция корней по теореме Штурма с уточнением методом Ньютона,
+ * Descartes, Aberth, Companion - см. rootsolvers.h.
+ */
+enum class RootSolver {Analytic, Sturm, Descartes, Aberth, Companion};
+
+/* Шаблоны выражений над полиномами.
+ * Операторы +, -, * над полиномами и выражениями возвращают не полином, а узел выражения.
+ * Суммы, разности, изменение знака и умножение на число хранят операнды (полиномы - по ссылке,
+ * вложенные выражения - по значению) и вычисляют коэффициенты по требованию; произведение вычисляет
+ * свои коэффициенты сразу в буфер на стеке (см. PolynomialProduct). Поэтому цепочка операций вида
+ * B * B - 4 * A * C не создаёт промежуточных полиномов в куче: память выделяется один раз - под результат.
+ * Каждый узел вычисляет коэффициенты теми же операциями и в том же порядке, что и соответствующий
+ * оператор над полиномами, и так же отбрасывает малые старшие коэффициенты, поэтому результат
+ * совпадает побитово с последовательным вычислением через промежуточные полиномы.
+ * Выражение должно быть преобразовано в Polynomial до окончания времени жизни полиномов-операндов.
+ */
+
+template<class E>
+class PolynomialExpression
+{
+public:
+    const E &self() const { return static_cast<const E &>(*this); }
+protected:
+    // Число коэффициентов выражения expression без малых по модулю старших (из count первых)
+    template<class T>
+    static std::size_t trimmed(const T &expression, std::size_t count);
+};
+
 
 /* Класс, реализующий основные операции с полиномами одной переменной */
 
-class Polynomial
+class Polynomial : public PolynomialExpression<Polynomial>
 {
+    template<class E> friend class PolynomialExpression;
 private:
     // Если коэффициент полинома по модулю меньше zeroEps, он считается равным нулю
     static constexpr double zeroEps = 1e-10;
     // Погрешность нахождения корней
     static constexpr double rootEps = 1e-5;
+    // Наибольшая степень, для которой метод поиска корней выбирается отдельно
+    static constexpr std::size_t maxSolverDegree = 8;
+    // Методы поиска корней для степеней 0..maxSolverDegree (для больших степеней используется метод Штурма)
+    static RootSolver solvers[maxSolverDegree + 1];
     // Вектор коэффициентов
     std::vector<double> coeffs;
     // Степень
     std::size_t deg;
-    // Вектор полиномов, образующих стандартную систему Штурма
-    std::vector<Polynomial> sturmSystem;
+    /* Полином в рабочей памяти SolverContext (для метода Штурма): size коэффициентов по возрастанию степени.
+     * Операции над ним выполняются теми же действиями и в том же порядке, что и над Polynomial,
+     * поэтому результат совпадает побитово.
+     */
+    struct Span
+    {
+        double *c;
+        std::size_t size;
+        std::size_t degree() const { return size - 1; }
+        double operator()(double x) const;
+    };
+    // Стандартная система Штурма и вторая производная исследуемого полинома (первый член системы)
+    struct SturmSystem
+    {
+        Span *members;
+        std::size_t count;
+        Span secondDerivative;  // Вычисляется при первой надобности (size = 0 - ещё не вычислена)
+        SolverContext &context;
+    };
     // Метод сравнивает модули коэффициентов с величиной zeroEps и корректирует степень полинома
     void correctDegree();
-    // Возвращает корень полинома на отрезке lX..rX, найденный бинарным поиском
-    double findRootBisection(double lX, double rX) const;
-    /* Функция поиска корня полинома на отрезке l..r методом Ньютона.
+    // То же для полинома в рабочей памяти, а также дифференцирование (как differentiate())
+    static void correctDegree(Span &p);
+    static void differentiate(Span &p);
+    // Копия count коэффициентов в памяти context
+    static Span copy(const double *coeffs, std::size_t count, SolverContext &context);
+    // Остаток от деления p1 на p2 в памяти context (как operator%)
+    static Span remainder(const Span &p1, const Span &p2, SolverContext &context);
+    // Возвращает корень полинома p на отрезке lX..rX, найденный бинарным поиском
+    static double findRootBisection(const Span &p, double lX, double rX);
+    /* Функция поиска корня полинома p на отрезке l..r методом Ньютона.
      * В параметре х передаётся начальное приближение и возвращается корень.
      * maxN - максимально допустимое количество итераций.
      * dP - производная исследуемого полинома.
      * Функция возвращает true, если метод Ньютона сходится
      * и удалось найти корень, не превысив максимальное число итераций.
      */
-    bool findRootNewton(double l, double r, double &x, unsigned maxN, const Polynomial &dP) const;
+    static bool findRootNewton(const Span &p, double l, double r, double &x, unsigned maxN, const Span &dP);
     // Возвращает нижнюю границу корней полинома
     double getLowRootsLimit() const;
-    // Возвращает верхнюю границу корней полинома
-    double getHighRootsLimit() const;
-    // Создаёт стандартную систему Штурма
-    void createSturmSystem();
-    // Находит все вещественные корни полинома на отрезке l..r и заносит их в вектор vec
-    void searchRoots(double l, double r, std::vector<double> &vec);
-    // 4 функции аналитически решают уравнения степеней от 1 до 4 и возвращают вектор корней
-    std::vector<double> getLinearEquationSolution() const;
-    std::vector<double> getQuadraticEquationSolution() const;
-    std::vector<double> getCubicEquationSolution() const;
-    std::vector<double> getQuarticEquationSolution() const;
+    // Возвращает верхнюю границу корней полинома (mirror = true - полинома P(-x))
+    double getHighRootsLimit(bool mirror = false) const;
+    // Создаёт стандартную систему Штурма в памяти context
+    SturmSystem createSturmSystem(SolverContext &context) const;
+    // Находит все вещественные корни полинома (первого члена системы) на отрезке l..r и заносит их в вектор vec
+    static void searchRoots(SturmSystem &system, double l, double r, std::vector<double> &vec);
+    // 4 функции аналитически решают уравнения степеней от 1 до 4 и записывают корни в solution
+    void getLinearEquationSolution(std::vector<double> &solution) const;
+    void getQuadraticEquationSolution(std::vector<double> &solution) const;
+    void getCubicEquationSolution(std::vector<double> &solution) const;
+    void getQuarticEquationSolution(std::vector<double> &solution) const;
 public:
     // Конструктор, создаёт полином по списку его коэффициентов
     Polynomial(const std::initializer_list<double> &coefficients);
@@ -51,14 +116,54 @@ public:
     Polynomial(const std::size_t degree);
     // Конструктор, создаёт полином первой степени
     Polynomial();
+    // Конструктор, создаёт полином по выражению (вычисляет его коэффициенты)
+    template<class E>
+    Polynomial(const PolynomialExpression<E> &expression);
     // Пустой деструктор
     virtual ~Polynomial();
     // Возвращает текущую степень полинома
     std::size_t degree() const;
+    // Число коэффициентов и коэффициент при x^index (интерфейс выражения)
+    std::size_t size() const { return coeffs.size(); }
+    double coefficient(std::size_t index) const { return coeffs[index]; }
     // Дифференцирует полином и возвращает ссылку на него
     Polynomial& differentiate();
-    // Возвращает вектор всех вещественных корней полинома
+    /* Оценка обусловленности корня x: отношение суммы модулей слагаемых P(x) к |P'(x)| * max(|x|, 1).
+     * Во столько раз погрешность корня превышает погрешность вычисления полинома
+     * (велика для кратных и близких корней).
+     */
+    double rootCondition(double x) const;
+    // Уточняет корень x методом Ньютона в расширенной точности (long double)
+    double polishRoot(double x) const;
+    // То же для полинома, заданного массивом из size коэффициентов по возрастанию степени
+    static double rootCondition(const double *coeffs, std::size_t size, double x);
+    static double polishRoot(const double *coeffs, std::size_t size, double x);
+    // Возвращает вектор всех вещественных корней полинома, найденных методом, выбранным для его степени
     std::vector<double> roots();
+    // Возвращает вектор всех вещественных корней полинома, найденных заданным методом
+    std::vector<double> roots(RootSolver solver);
+    /* То же с рабочей памятью из context (система Штурма, производные, буферы методов):
+     * корни записываются в context.roots, на него и возвращается ссылка (действительна до следующего решения).
+     * При повторных решениях с тем же контекстом память в куче не выделяется.
+     */
+    const std::vector<double> &roots(SolverContext &context);
+    const std::vector<double> &roots(RootSolver solver, SolverContext &context);
+    /* Повторный поиск корней плохо обусловленного уравнения независимо от выбранного метода:
+     * изоляция в long double с уменьшенной погрешностью (см. solveDescartesPrecise())
+     */
+    const std::vector<double> &preciseRoots(SolverContext &context);
+    /* Выбор метода поиска корней для полиномов заданной степени.
+     * Не является потокобезопасным: выбор следует делать до начала расчёта.
+     */
+    static void setSolver(std::size_t degree, RootSolver solver);
+    static RootSolver solver(std::size_t degree);
+    /* Пакетное аналитическое решение n кубических уравнений и уравнений 4 степени
+     * (coeffs[k] - коэффициенты k-го уравнения по возрастанию степени, старший не равен нулю).
+     * Вещественные корни k-го уравнения записываются в roots[k][0..counts[k] - 1]
+     * в том же порядке, что и в roots(); память не выделяется. Уравнения решаются по одному (без SIMD).
+     */
+    static void solveCubics(std::size_t n, const std::array<double, 4> *coeffs, std::array<double, 3> *roots, unsigned *counts);
+    static void solveQuartics(std::size_t n, const std::array<double, 5> *coeffs, std::array<double, 4> *roots, unsigned *counts);
     // Составные операторы присваивания
     Polynomial& operator+=(const Polynomial &polynomial);
     Polynomial& operator-=(const Polynomial &polynomial);
@@ -71,16 +176,266 @@ public:
     // Операторы индексирования (возвращают нужный коэффициент полинома)
     double &operator[](std::vector<double>::size_type index);
     const double &operator[](std::vector<double>::size_type index) const;
-    /* Операторы:
-     * сложение, вычитание, умножение, вычисление остатка от деления двух полиномов;
-     * умножение полинома на число.
-     */
-    friend Polynomial operator+(const Polynomial &p1, const Polynomial &p2);
-    friend Polynomial operator-(const Polynomial &p1, const Polynomial &p2);
-    friend Polynomial operator*(const Polynomial &p1, const Polynomial &p2);
-    friend Polynomial operator*(const Polynomial &polynomial, const double &value);
-    friend Polynomial operator*(const double &value, const Polynomial &polynomial);
+    // Оператор вычисления остатка от деления двух полиномов
     friend Polynomial operator%(const Polynomial &p1, const Polynomial &p2);
 };
 
+
+template<class E>
+template<class T>
+std::size_t PolynomialExpression<E>::trimmed(const T &expression, std::size_t count)
+{
+    while (count > 1 && std::abs(expression.coefficient(count - 1)) < Polynomial::zeroEps)
+        --count;
+    return count;
+}
+
+
+// Полиномы хранятся в узлах выражений по ссылке, вложенные выражения - по значению
+template<class E>
+struct PolynomialOperand
+{
+    typedef const E type;
+};
+
+template<>
+struct PolynomialOperand<Polynomial>
+{
+    typedef const Polynomial &type;
+};
+
+
+// Сумма (как operator+ над полиномами: p2[i] + p1[i])
+template<class L, class R>
+class PolynomialSum : public PolynomialExpression<PolynomialSum<L, R>>
+{
+private:
+    typename PolynomialOperand<L>::type l;
+    typename PolynomialOperand<R>::type r;
+    std::size_t count;
+public:
+    PolynomialSum(const L &left, const R &right)
+        : l(left), r(right), count(std::max(l.size(), r.size()))
+    {
+        count = this->trimmed(*this, count);
+    }
+    std::size_t size() const { return count; }
+    double coefficient(std::size_t i) const
+    {
+        return (i < r.size() ? r.coefficient(i) : 0.0) + (i < l.size() ? l.coefficient(i) : 0.0);
+    }
+};
+
+
+// Разность (как operator- над полиномами, т.е. (-p2) + p1 с отбрасыванием малых старших коэффициентов -p2)
+template<class L, class R>
+class PolynomialDifference : public PolynomialExpression<PolynomialDifference<L, R>>
+{
+private:
+    typename PolynomialOperand<L>::type l;
+    typename PolynomialOperand<R>::type r;
+    std::size_t rightCount, count;
+public:
+    PolynomialDifference(const L &left, const R &right)
+        : l(left), r(right), rightCount(this->trimmed(r, r.size()))
+    {
+        count = this->trimmed(*this, std::max(l.size(), rightCount));
+    }
+    std::size_t size() const { return count; }
+    double coefficient(std::size_t i) const
+    {
+        double negated = i < rightCount ? -r.coefficient(i) : 0.0;
+        return i < l.size() ? l.coefficient(i) + negated : negated;
+    }
+};
+
+
+/* Коэффициенты, вычисленные один раз: до inlineSize - в самом объекте (на стеке вместе с узлом выражения),
+ * больше - в куче. При копировании узла копируются только count коэффициентов.
+ */
+class PolynomialCoefficients
+{
+public:
+    static constexpr std::size_t inlineSize = 24;
+private:
+    std::size_t count;
+    double *values;
+    double local[inlineSize];
+public:
+    explicit PolynomialCoefficients(std::size_t size)
+        : count(size), values(size > inlineSize ? new double[size] : local)
+    {
+
+    }
+    PolynomialCoefficients(const PolynomialCoefficients &other)
+        : PolynomialCoefficients(other.count)
+    {
+        std::copy(other.values, other.values + count, values);
+    }
+    ~PolynomialCoefficients()
+    {
+        if (values != local)
+            delete[] values;
+    }
+    PolynomialCoefficients &operator=(const PolynomialCoefficients &) = delete;
+    double *data() { return values; }
+    double operator[](std::size_t i) const { return values[i]; }
+};
+
+
+template<class L, class R>
+class PolynomialProduct;
+
+// Коэффициенты полиномов и произведений хранятся в памяти, остальных выражений - вычисляются при обращении
+template<class E>
+struct PolynomialStored : std::false_type {};
+
+template<>
+struct PolynomialStored<Polynomial> : std::true_type {};
+
+template<class L, class R>
+struct PolynomialStored<PolynomialProduct<L, R>> : std::true_type {};
+
+
+/* Произведение (как operator* над полиномами: слагаемые суммируются по возрастанию индекса левого множителя).
+ * Коэффициенты вычисляются сразу при создании узла, а коэффициенты множителей, вычисляемые при обращении,
+ * предварительно запрашиваются по одному разу. Поэтому вложенные произведения (E * E * D) не пересчитываются
+ * для каждого слагаемого свёртки, а отбрасывание малых старших коэффициентов и обращения к узлу
+ * из внешних выражений не вычисляют поддерево заново.
+ */
+template<class L, class R>
+class PolynomialProduct : public PolynomialExpression<PolynomialProduct<L, R>>
+{
+private:
+    PolynomialCoefficients values;
+    std::size_t count;
+    // Коэффициенты множителя: хранимые - по ссылке, остальные - в буфере buffer
+    template<class E>
+    static const E &operand(const E &e, PolynomialCoefficients &, std::true_type)
+    {
+        return e;
+    }
+    template<class E>
+    static const PolynomialCoefficients &operand(const E &e, PolynomialCoefficients &buffer, std::false_type)
+    {
+        double *c = buffer.data();
+        for (std::size_t i = 0; i < e.size(); ++i)
+            c[i] = e.coefficient(i);
+        return buffer;
+    }
+    template<class E>
+    static double at(const E &e, std::size_t i) { return e.coefficient(i); }
+    static double at(const PolynomialCoefficients &e, std::size_t i) { return e[i]; }
+public:
+    PolynomialProduct(const L &left, const R &right)
+        : values(left.size() + right.size() - 1), count(left.size() + right.size() - 1)
+    {
+        const std::size_t leftCount = left.size(), rightCount = right.size();
+        PolynomialCoefficients leftBuffer(PolynomialStored<L>::value ? 0 : leftCount);
+        PolynomialCoefficients rightBuffer(PolynomialStored<R>::value ? 0 : rightCount);
+        const auto &a = operand(left, leftBuffer, PolynomialStored<L>());
+        const auto &b = operand(right, rightBuffer, PolynomialStored<R>());
+        double *res = values.data();
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            double sum = 0.0;
+            std::size_t last = std::min(k, leftCount - 1);
+            for (std::size_t i = k < rightCount ? 0 : k - rightCount + 1; i <= last; ++i)
+                sum += at(a, i) * at(b, k - i);
+            res[k] = sum;
+        }
+        count = this->trimmed(*this, count);
+    }
+    std::size_t size() const { return count; }
+    double coefficient(std::size_t k) const { return values[k]; }
+};
+
+
+// Произведение на число
+template<class E>
+class PolynomialScaled : public PolynomialExpression<PolynomialScaled<E>>
+{
+private:
+    typename PolynomialOperand<E>::type e;
+    double value;
+    std::size_t count;
+public:
+    PolynomialScaled(const E &expression, double scale)
+        : e(expression), value(scale), count(e.size())
+    {
+        count = this->trimmed(*this, count);
+    }
+    std::size_t size() const { return count; }
+    double coefficient(std::size_t i) const { return e.coefficient(i) * value; }
+};
+
+
+// Изменение знака
+template<class E>
+class PolynomialNegation : public PolynomialExpression<PolynomialNegation<E>>
+{
+private:
+    typename PolynomialOperand<E>::type e;
+    std::size_t count;
+public:
+    explicit PolynomialNegation(const E &expression)
+        : e(expression), count(e.size())
+    {
+        count = this->trimmed(*this, count);
+    }
+    std::size_t size() const { return count; }
+    double coefficient(std::size_t i) const { return -e.coefficient(i); }
+};
+
+
+template<class E>
+Polynomial::Polynomial(const PolynomialExpression<E> &expression)
+    : coeffs(expression.self().size()), deg(coeffs.size() - 1)
+{
+    const E &e = expression.self();
+    for (std::size_t i = 0; i < coeffs.size(); ++i)
+        coeffs[i] = e.coefficient(i);
+}
+
+
+/* Операторы над полиномами и выражениями:
+ * сложение, вычитание, умножение, изменение знака; умножение на число.
+ */
+
+template<class L, class R>
+PolynomialSum<L, R> operator+(const PolynomialExpression<L> &p1, const PolynomialExpression<R> &p2)
+{
+    return PolynomialSum<L, R>(p1.self(), p2.self());
+}
+
+template<class L, class R>
+PolynomialDifference<L, R> operator-(const PolynomialExpression<L> &p1, const PolynomialExpression<R> &p2)
+{
+    return PolynomialDifference<L, R>(p1.self(), p2.self());
+}
+
+template<class L, class R>
+PolynomialProduct<L, R> operator*(const PolynomialExpression<L> &p1, const PolynomialExpression<R> &p2)
+{
+    return PolynomialProduct<L, R>(p1.self(), p2.self());
+}
+
+template<class E>
+PolynomialScaled<E> operator*(const PolynomialExpression<E> &polynomial, const double &value)
+{
+    return PolynomialScaled<E>(polynomial.self(), value);
+}
+
+template<class E>
+PolynomialScaled<E> operator*(const double &value, const PolynomialExpression<E> &polynomial)
+{
+    return PolynomialScaled<E>(polynomial.self(), value);
+}
+
+template<class E>
+PolynomialNegation<E> operator-(const PolynomialExpression<E> &polynomial)
+{
+    return PolynomialNegation<E>(polynomial.self());
+}
+
 #endif // POLYNOMIAL_H
@@ -0,0 +1,554 @@
+#include "rootsolvers.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+using std::abs;
+using std::vector;
+using std::size_t;
+
+namespace
+{
+    // Погрешность нахождения корней (как в Polynomial)
+    constexpr double rootEps = 1e-5;
+    // Допустимая мнимая часть (относительно модуля) комплексного корня, считающегося вещественным
+    constexpr double imagEps = 1e-7;
+    // Максимальное число итераций итерационных методов
+    constexpr unsigned maxIterations = 100;
+
+    typedef std::complex<double> Complex;
+
+    vector<double> coefficients(const Polynomial &p)
+    {
+        vector<double> c(p.degree() + 1);
+        for (size_t i = 0; i < c.size(); ++i)
+            c[i] = p[i];
+        return c;
+    }
+
+    /* Коэффициенты полинома по возрастанию степени без копирования
+     * (в векторе или в рабочей памяти SolverContext)
+     */
+    struct Coefficients
+    {
+        const double *data;
+        size_t n;
+        Coefficients(const vector<double> &c) : data(c.data()), n(c.size()) {}
+        Coefficients(const double *c, size_t size) : data(c), n(size) {}
+        size_t size() const { return n; }
+        double back() const { return data[n - 1]; }
+        const double &operator[](size_t i) const { return data[i]; }
+    };
+
+    // Значение полинома (схема Горнера)
+    template<class T>
+    T value(const Coefficients &c, const T &x)
+    {
+        T res = c.back();
+        for (size_t i = c.size() - 1; i--; )
+            res = res * x + c[i];
+        return res;
+    }
+
+    // Значение полинома и его производной
+    template<class T>
+    void value(const Coefficients &c, const T &x, T &f, T &df)
+    {
+        f = c.back();
+        df = 0;
+        for (size_t i = c.size() - 1; i--; )
+        {
+            df = df * x + f;
+            f = f * x + c[i];
+        }
+    }
+
+    // Уточняет вещественный корень несколькими шагами метода Ньютона (шаг принимается, только если невязка уменьшается)
+    double polish(const vector<double> &c, double x)
+    {
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            double f, df;
+            value(c, x, f, df);
+            if (f == 0.0 || df == 0.0)
+                break;
+            double next = x - f / df;
+            if (!(abs(value(c, next)) < abs(f)))
+                break;
+            x = next;
+        }
+        return x;
+    }
+
+    // Сортирует корни и объединяет совпадающие в пределах погрешности
+    void merge(vector<double> &roots)
+    {
+        std::sort(roots.begin(), roots.end());
+        roots.erase(std::unique(roots.begin(), roots.end(), [](double a, double b){return b - a < rootEps;}), roots.end());
+    }
+
+    // Отбирает вещественные корни из найденных комплексных
+    vector<double> realRoots(const vector<double> &c, const vector<Complex> &z)
+    {
+        vector<double> res;
+        for (const Complex &item : z)
+            if (abs(item.imag()) <= imagEps * std::max(1.0, abs(item)))
+                res.push_back(polish(c, item.real()));
+        merge(res);
+        return res;
+    }
+
+    // Граница модулей корней (оценка Фудзивары)
+    double rootsBound(const Coefficients &c)
+    {
+        size_t n = c.size() - 1;
+        double bound = 0.0;
+        for (size_t i = 0; i < n; ++i)
+            bound = std::max(bound, std::pow(abs(c[i] / c[n]), 1.0 / (n - i)));
+        return 2 * bound + rootEps;
+    }
+
+
+    /* М Е Т О Д   В И Н С Е Н Т А  -  К О Л Л И Н З А  -  А К Р И Т А С А */
+
+
+    /* Вычисления выполняются в типе T; eps - ширина интервала, при которой изоляция прекращается
+     * (корень уточняется до eps * 1e-3)
+     */
+    template<class T>
+    class DescartesIsolator
+    {
+    private:
+        const Coefficients c;
+        vector<double> &roots;
+        T *t;                   // Рабочий массив преобразованных коэффициентов (c.size() элементов)
+        const T eps;
+        // Сдвиг Тейлора: t(x) -> t(x + a)
+        void shift(T a)
+        {
+            for (size_t i = 0; i + 1 < c.size(); ++i)
+                for (size_t j = c.size() - 1; j-- > i; )
+                    t[j] += a * t[j + 1];
+        }
+        /* Число перемен знака в коэффициентах (1 + s)^n P(l + (r - l) / (1 + s)).
+         * По правилу знаков Декарта это верхняя оценка числа корней на интервале (l, r),
+         * совпадающая с ним, если она равна 0 или 1.
+         */
+        unsigned variations(T l, T r)
+        {
+            std::copy(c.data, c.data + c.size(), t);
+            shift(l);
+            T scale = 1.0;
+            for (size_t i = 0; i < c.size(); ++i)
+            {
+                t[i] *= scale;
+                scale *= r - l;
+            }
+            std::reverse(t, t + c.size());
+            shift(1.0);
+            unsigned count = 0;
+            int sign = 0;
+            for (size_t i = 0; i < c.size(); ++i)
+            {
+                T item = t[i];
+                if (item == 0.0)
+                    continue;
+                int s = item > 0 ? 1 : -1;
+                if (sign && s != sign)
+                    ++count;
+                sign = s;
+            }
+            return count;
+        }
+        // Уточняет единственный корень на интервале l..r (метод Ньютона с защитой делением пополам)
+        T refine(T l, T r, T fl)
+        {
+            T x = 0.5 * (l + r);
+            for (unsigned i = 0; i < maxIterations && r - l > eps * 1e-3; ++i)
+            {
+                T f, df;
+                value(c, x, f, df);
+                if (f == 0.0)
+                    return x;
+                if ((f < 0) == (fl < 0))
+                {
+                    l = x;
+                    fl = f;
+                }
+                else
+                    r = x;
+                T next = df != 0.0 ? x - f / df : l - 1.0;
+                if (next <= l || next >= r)
+                    next = 0.5 * (l + r);
+                else if (abs(next - x) < eps * 1e-3)
+                    return next;
+                x = next;
+            }
+            return x;
+        }
+    public:
+        DescartesIsolator(const Coefficients &coeffs, T *work, vector<double> &res, T tolerance = rootEps)
+            : c(coeffs), roots(res), t(work), eps(tolerance) {}
+        // Находит корни на интервале (l, r)
+        void isolate(T l, T r)
+        {
+            unsigned count = variations(l, r);
+            T m = 0.5 * (l + r);
+            /* Из-за ошибок округления в преобразованных коэффициентах оценка может не совпадать
+             * с переменой знака полинома на концах интервала (вычисленной непосредственно), поэтому учитываются обе
+             */
+            T fl = value(c, l), fr = value(c, r);
+            bool signChange = (fl < 0) != (fr < 0);
+            if (!count && !signChange)
+                return;
+            if (count <= 1 && signChange)
+                roots.push_back(static_cast<double>(refine(l, r, fl)));
+            else if (r - l < eps)
+            {
+                // Кратный корень или пара близких комплексных корней: различаются по величине невязки
+                T f = value(c, m), scale = 0.0;
+                for (size_t i = c.size(); i--; )
+                    scale = scale * abs(m) + abs(c[i]);
+                if (count % 2 || abs(f) <= 1e-8 * scale)
+                    roots.push_back(static_cast<double>(m));
+            }
+            else
+            {
+                isolate(l, m);
+                if (value(c, m) == 0.0)
+                    roots.push_back(static_cast<double>(m));
+                isolate(m, r);
+            }
+        }
+    };
+
+
+    /* Q R - А Л Г О Р И Т М */
+
+
+    // Уравновешивание матрицы (уменьшает погрешность собственных значений)
+    void balance(vector<vector<double>> &a)
+    {
+        const double radix = 2.0;
+        size_t n = a.size();
+        bool done = false;
+        while (!done)
+        {
+            done = true;
+            for (size_t i = 0; i < n; ++i)
+            {
+                double r = 0.0, c = 0.0;
+                for (size_t j = 0; j < n; ++j)
+                    if (j != i)
+                    {
+                        c += abs(a[j][i]);
+                        r += abs(a[i][j]);
+                    }
+                if (c == 0.0 || r == 0.0)
+                    continue;
+                double g = r / radix, f = 1.0, s = c + r;
+                while (c < g)
+                {
+                    f *= radix;
+                    c *= radix * radix;
+                }
+                g = r * radix;
+                while (c > g)
+                {
+                    f /= radix;
+                    c /= radix * radix;
+                }
+                if ((c + r) / f < 0.95 * s)
+                {
+                    done = false;
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        a[i][j] /= f;
+                        a[j][i] *= f;
+                    }
+                }
+            }
+        }
+    }
+
+    /* Собственные значения верхней матрицы Хессенберга (QR-алгоритм с двойным сдвигом Фрэнсиса).
+     * Возвращает false, если алгоритм не сошёлся.
+     */
+    bool eigenvalues(vector<vector<double>> &a, vector<Complex> &w)
+    {
+        int n = a.size();
+        w.assign(n, 0.0);
+        double norm = 0.0;
+        for (int i = 0; i < n; ++i)
+            for (int j = std::max(i - 1, 0); j < n; ++j)
+                norm += abs(a[i][j]);
+        // Общее ограничение числа итераций (как в EISPACK): кратные собственные значения сходятся медленно
+        int nn = n - 1, l, budget = 30 * n;
+        double t = 0.0, p = 0.0, q = 0.0, r = 0.0, s, x, y, z, ww;
+        while (nn >= 0)
+        {
+            int its = 0;
+            do
+            {
+                // Поиск малого поддиагонального элемента
+                for (l = nn; l >= 1; --l)
+                {
+                    s = abs(a[l - 1][l - 1]) + abs(a[l][l]);
+                    if (s == 0.0)
+                        s = norm;
+                    if (abs(a[l][l - 1]) + s == s)
+                    {
+                        a[l][l - 1] = 0.0;
+                        break;
+                    }
+                }
+                x = a[nn][nn];
+                if (l == nn)
+                {
+                    // Найден один корень
+                    w[nn--] = x + t;
+                }
+                else
+                {
+                    y = a[nn - 1][nn - 1];
+                    ww = a[nn][nn - 1] * a[nn - 1][nn];
+                    if (l == nn - 1)
+                    {
+                        // Найдены два корня
+                        p = 0.5 * (y - x);
+                        q = p * p + ww;
+                        z = std::sqrt(abs(q));
+                        x += t;
+                        if (q >= 0.0)
+                        {
+                            z = p + std::copysign(z, p);
+                            w[nn - 1] = w[nn] = x + z;
+                            if (z != 0.0)
+                                w[nn] = x - ww / z;
+                        }
+                        else
+                        {
+                            w[nn - 1] = Complex(x + p, z);
+                            w[nn] = Complex(x + p, -z);
+                        }
+                        nn -= 2;
+                    }
+                    else
+                    {
+                        if (!budget--)
+                            return false;
+                        if (its == 10 || its == 20)
+                        {
+                            // Исключительный сдвиг
+                            t += x;
+                            for (int i = 0; i <= nn; ++i)
+                                a[i][i] -= x;
+                            s = abs(a[nn][nn - 1]) + abs(a[nn - 1][nn - 2]);
+                            y = x = 0.75 * s;
+                            ww = -0.4375 * s * s;
+                        }
+                        ++its;
+                        int m;
+                        for (m = nn - 2; m >= l; --m)
+                        {
+                            z = a[m][m];
+                            r = x - z;
+                            s = y - z;
+                            p = (r * s - ww) / a[m + 1][m] + a[m][m + 1];
+                            q = a[m + 1][m + 1] - z - r - s;
+                            r = a[m + 2][m + 1];
+                            s = abs(p) + abs(q) + abs(r);
+                            p /= s;
+                            q /= s;
+                            r /= s;
+                            if (m == l)
+                                break;
+                            double u = abs(a[m][m - 1]) * (abs(q) + abs(r));
+                            double v = abs(p) * (abs(a[m - 1][m - 1]) + abs(z) + abs(a[m + 1][m + 1]));
+                            if (u + v == v)
+                                break;
+                        }
+                        for (int i = m + 2; i <= nn; ++i)
+                        {
+                            a[i][i - 2] = 0.0;
+                            if (i != m + 2)
+                                a[i][i - 3] = 0.0;
+                        }
+                        // Шаг QR с двойным сдвигом
+                        for (int k = m; k <= nn - 1; ++k)
+                        {
+                            if (k != m)
+                            {
+                                p = a[k][k - 1];
+                                q = a[k + 1][k - 1];
+                                r = k != nn - 1 ? a[k + 2][k - 1] : 0.0;
+                                if ((x = abs(p) + abs(q) + abs(r)) != 0.0)
+                                {
+                                    p /= x;
+                                    q /= x;
+                                    r /= x;
+                                }
+                            }
+                            if ((s = std::copysign(std::sqrt(p * p + q * q + r * r), p)) != 0.0)
+                            {
+                                if (k == m)
+                                {
+                                    if (l != m)
+                                        a[k][k - 1] = -a[k][k - 1];
+                                }
+                                else
+                                    a[k][k - 1] = -s * x;
+                                p += s;
+                                x = p / s;
+                                y = q / s;
+                                z = r / s;
+                                q /= p;
+                                r /= p;
+                                for (int j = k; j <= nn; ++j)
+                                {
+                                    p = a[k][j] + q * a[k + 1][j];
+                                    if (k != nn - 1)
+                                    {
+                                        p += r * a[k + 2][j];
+                                        a[k + 2][j] -= p * z;
+                                    }
+                                    a[k + 1][j] -= p * y;
+                                    a[k][j] -= p * x;
+                                }
+                                int last = std::min(nn, k + 3);
+                                for (int i = l; i <= last; ++i)
+                                {
+                                    p = x * a[i][k] + y * a[i][k + 1];
+                                    if (k != nn - 1)
+                                    {
+                                        p += z * a[i][k + 2];
+                                        a[i][k + 2] -= p * r;
+                                    }
+                                    a[i][k + 1] -= p * q;
+                                    a[i][k] -= p;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            while (l < nn - 1);
+        }
+        return true;
+    }
+}
+
+
+vector<double> solveDescartes(const Polynomial &p)
+{
+    SolverContext context;
+    vector<double> res;
+    solveDescartes(p, context, res);
+    return res;
+}
+
+
+void solveDescartes(const Polynomial &p, SolverContext &context, vector<double> &res)
+{
+    // Коэффициенты полинома не копируются, в рабочей памяти - только массив преобразованных коэффициентов
+    Coefficients c(&p[0], p.degree() + 1);
+    double bound = rootsBound(c);
+    res.clear();
+    DescartesIsolator<double>(c, context.allocate<double>(c.size()), res).isolate(-bound, bound);
+    merge(res);
+}
+
+
+void solveDescartesPrecise(const Polynomial &p, SolverContext &context, vector<double> &res)
+{
+    Coefficients c(&p[0], p.degree() + 1);
+    long double bound = rootsBound(c);
+    res.clear();
+    DescartesIsolator<long double>(c, context.allocate<long double>(c.size()), res, rootEps * 1e-3).isolate(-bound, bound);
+    // Совпадающие корни объединяются с обычной погрешностью: иначе кратный корень дал бы две одинаковые фазы
+    merge(res);
+}
+
+
+vector<double> solveAberth(const Polynomial &p)
+{
+    vector<double> c = coefficients(p);
+    size_t n = c.size() - 1;
+    // Начальные приближения на окружности, содержащей все корни (со сдвигом, исключающим симметрию)
+    double radius = 0.5 * rootsBound(c);
+    vector<Complex> z(n);
+    for (size_t k = 0; k < n; ++k)
+        z[k] = std::polar(radius, (2 * M_PI * k + 0.4) / n);
+    vector<bool> converged(n, false);
+    for (unsigned iteration = 0; iteration < maxIterations; ++iteration)
+    {
+        bool done = true;
+        for (size_t k = 0; k < n; ++k)
+        {
+            if (converged[k])
+                continue;
+            Complex f, df;
+            value(c, z[k], f, df);
+            if (f == 0.0)
+            {
+                converged[k] = true;
+                continue;
+            }
+            Complex ratio = f / df, sum = 0.0;
+            for (size_t j = 0; j < n; ++j)
+                if (j != k)
+                    sum += 1.0 / (z[k] - z[j]);
+            Complex correction = ratio / (1.0 - ratio * sum);
+            z[k] -= correction;
+            if (abs(correction) <= 1e-14 * std::max(1.0, abs(z[k])))
+                converged[k] = true;
+            else
+                done = false;
+        }
+        if (done)
+            break;
+    }
+    return realRoots(c, z);
+}
+
+
+vector<double> solveCompanion(const Polynomial &p)
+{
+    vector<double> c = coefficients(p);
+    size_t n = c.size() - 1;
+    // Сопровождающая матрица уже имеет форму Хессенберга
+    vector<vector<double>> a(n, vector<double>(n, 0.0));
+    for (size_t j = 0; j < n; ++j)
+        a[0][j] = -c[n - 1 - j] / c[n];
+    for (size_t i = 1; i < n; ++i)
+        a[i][i - 1] = 1.0;
+    balance(a);
+    vector<Complex> w;
+    if (!eigenvalues(a, w))
+    {
+        // QR-алгоритм не сошёлся (отдельный контекст: вызов может быть вложен в roots() с контекстом по умолчанию)
+        Polynomial copy = p;
+        SolverContext context;
+        return copy.roots(RootSolver::Sturm, context);
+    }
+    return realRoots(c, w);
+}
+
+
+const char *rootSolverName(RootSolver solver)
+{
+    switch (solver)
+    {
+        case RootSolver::Analytic:
+            return "analytic";
+        case RootSolver::Sturm:
+            return "sturm";
+        case RootSolver::Descartes:
+            return "descartes";
+        case RootSolver::Aberth:
+            return "aberth";
+        case RootSolver::Companion:
+            return "companion";
+    }
+    return "";
+}
@@ -0,0 +1,30 @@
+#ifndef ROOTSOLVERS_H
+#define ROOTSOLVERS_H
+
+#include "polynomial.h"
+
+/* Альтернативные методы поиска вещественных корней полинома.
+ * Выбор метода для каждой степени выполняется в Polynomial::roots() (см. Polynomial::setSolver()).
+ * Все функции возвращают различные вещественные корни по возрастанию:
+ * кратный корень, как и в методе Штурма, возвращается один раз.
+ */
+
+// Изоляция корней по правилу знаков Декарта (метод Винсента - Коллинза - Акритаса) с уточнением методом Ньютона
+std::vector<double> solveDescartes(const Polynomial &p);
+// То же с рабочей памятью из context, корни записываются в res
+void solveDescartes(const Polynomial &p, SolverContext &context, std::vector<double> &res);
+/* Повторная изоляция для плохо обусловленных уравнений: тот же метод в long double,
+ * интервалы дробятся до ширины 1e-8 (в 1000 раз меньше обычной), корни уточняются до 1e-11.
+ * Метод не зависит от выбранного для степени (в т.ч. аналитического), поэтому корни, потерянные
+ * из-за округления дискриминанта, находятся заново.
+ */
+void solveDescartesPrecise(const Polynomial &p, SolverContext &context, std::vector<double> &res);
+// Одновременное нахождение всех (в т.ч. комплексных) корней методом Аберта - Эрлиха
+std::vector<double> solveAberth(const Polynomial &p);
+// Собственные значения сопровождающей матрицы (QR-алгоритм для матрицы Хессенберга)
+std::vector<double> solveCompanion(const Polynomial &p);
+
+// Название метода (для бенчмарков и журналов)
+const char *rootSolverName(RootSolver solver);
+
+#endif // ROOTSOLVERS_H
@@ -0,0 +1,68 @@
+#ifndef RUNMETRICS_H
+#define RUNMETRICS_H
+
+#include <chrono>
+#include <cstdint>
+
+// Показатели производительности расчёта диаграммы
+
+struct RunMetrics
+{
+    std::uint64_t points;       // Количество обработанных точек
+    std::uint64_t totalPoints;  // Общее количество точек диаграммы
+    std::uint64_t solverCalls;  // Количество решённых уравнений (вызовов Polynomial::roots())
+    std::uint64_t refinedPoints;// Количество плохо обусловленных точек, рассчитанных повторно с повышенной точностью
+    double elapsed;             // Время расчёта, с
+    double rootTime;            // Время, затраченное на поиск корней уравнений состояния, с (оценка по выборке точек)
+    double stabilityTime;       // Время, затраченное на проверку устойчивости фаз, с (оценка по выборке точек)
+    double transitionTime;      // Время, затраченное на определение фазовых переходов первого рода, с
+
+    RunMetrics()
+        : points(0), totalPoints(0), solverCalls(0), refinedPoints(0), elapsed(0.0), rootTime(0.0), stabilityTime(0.0), transitionTime(0.0)
+    {
+
+    }
+    // Точек в секунду
+    double pointsPerSecond() const
+    {
+        return elapsed > 0.0 ? points / elapsed : 0.0;
+    }
+    // Решённых уравнений в секунду
+    double solverCallsPerSecond() const
+    {
+        return elapsed > 0.0 ? solverCalls / elapsed : 0.0;
+    }
+    // Оценка оставшегося времени, с
+    double eta() const
+    {
+        return points && points < totalPoints ? elapsed * (totalPoints - points) / points : 0.0;
+    }
+};
+
+
+/* Накапливает в переменной accumulator время, прошедшее с момента создания объекта до его уничтожения,
+ * умноженное на weight. Используется для замера времени выполнения отдельных этапов расчёта;
+ * при выборочном замере weight - число представляемых замером вызовов (0 - время не замеряется,
+ * часы не опрашиваются).
+ */
+
+class MetricsTimer
+{
+private:
+    double &accumulator;
+    double weight;
+    std::chrono::steady_clock::time_point start;
+public:
+    MetricsTimer(double &acc, double w = 1.0)
+        : accumulator(acc), weight(w), start(w ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+    {
+
+    }
+    ~MetricsTimer()
+    {
+        if (weight)
+            accumulator += weight * std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+#endif // RUNMETRICS_H
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include "solvercontext.h"
+
+
+SolverContext::SolverContext()
+    : used(0), overflowSize(0)
+{
+
+}
+
+
+void *SolverContext::allocateBytes(std::size_t bytes)
+{
+    std::size_t count = (bytes + sizeof(Unit) - 1) / sizeof(Unit);
+    if (used + count <= block.size())
+    {
+        Unit *res = block.data() + used;
+        used += count;
+        return res;
+    }
+    overflow.emplace_back(new Unit[count]);
+    overflowSize += count;
+    return overflow.back().get();
+}
+
+
+void SolverContext::reset()
+{
+    // Основной блок увеличивается так, чтобы вместить всю память предыдущего решения
+    if (!overflow.empty())
+    {
+        block.resize(std::max(2 * block.size(), used + overflowSize));
+        overflow.clear();
+        overflowSize = 0;
+    }
+    used = 0;
+}
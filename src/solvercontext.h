@@ -0,0 +1,54 @@
+#ifndef SOLVERCONTEXT_H
+#define SOLVERCONTEXT_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/* Рабочая память поиска корней (см. Polynomial::roots(SolverContext &)).
+ * Память выделяется из одного непрерывного блока последовательно (bump allocator) и освобождается
+ * вся сразу вызовом reset() перед каждым решением. Если блока не хватило, недостающая память берётся
+ * из дополнительных блоков, а при следующем reset() основной блок увеличивается до нужного размера,
+ * поэтому после нескольких первых решений выделений памяти в куче нет.
+ * Контекст не является потокобезопасным: у каждого потока (DiagramEngine) свой контекст.
+ */
+
+class SolverContext
+{
+public:
+    SolverContext();
+    /* Выделяет память под count объектов типа T (действительна до reset()).
+     * Деструкторы не вызываются, поэтому допускаются только тривиально уничтожаемые типы.
+     */
+    template<class T>
+    T *allocate(std::size_t count);
+    // Освобождает всю выделенную память
+    void reset();
+    // Найденные корни последнего решения (ёмкость сохраняется между решениями)
+    std::vector<double> roots;
+private:
+    // Единица выделения (с наибольшим выравниванием)
+    typedef std::max_align_t Unit;
+    std::vector<Unit> block;                            // Основной блок
+    std::size_t used;                                   // Занято в основном блоке (в единицах)
+    std::vector<std::unique_ptr<Unit[]>> overflow;      // Дополнительные блоки текущего решения
+    std::size_t overflowSize;                           // Их суммарный размер (в единицах)
+    // Выделяет память размером bytes байт
+    void *allocateBytes(std::size_t bytes);
+};
+
+
+template<class T>
+T *SolverContext::allocate(std::size_t count)
+{
+    static_assert(std::is_trivially_destructible<T>::value && alignof(T) <= alignof(Unit),
+                  "SolverContext: unsupported type");
+    T *res = static_cast<T*>(allocateBytes(count * sizeof(T)));
+    for (std::size_t i = 0; i < count; ++i)
+        new (res + i) T;
+    return res;
+}
+
+#endif // SOLVERCONTEXT_H
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cmath>
+#include "spinodaltracer.h"
+#include "phaseequations.h"
+
+
+namespace
+{
+    // Число устойчивых фаз типа type в точке
+    unsigned phaseCount(const DiagramPoint &point, unsigned type)
+    {
+        return std::count_if(point.phases.cbegin(), point.phases.cend(), [type](const PhaseInfo &item) {return item.type == type;});
+    }
+}
+
+
+SpinodalTracer::SpinodalTracer(const Worker &diagram, double tolerance)
+    : CurveTracer(diagram, tolerance)
+{
+
+}
+
+
+void SpinodalTracer::evaluate(const State &z, std::vector<double> &f, std::vector<double> &jacobian) const
+{
+    Coefficients c = coeffs;
+    c.a[0] = z[0];
+    c.b[0] = z[1];
+    std::fill(jacobian.begin(), jacobian.end(), 0.0);
+    PhaseDerivatives d = phaseDerivatives(c.c, types[0], z[2], z[3]);
+    stateEquations(types[0], d, z[2], z[3], 2, &f[0], &jacobian[0], 4);
+    double *row = &jacobian[8];
+    if (types[0] == 1)
+    {
+        // N = 0 зафиксировано уравнениями состояния
+        f[2] = d.xx;
+        row[0] = d.cxx[0];
+        row[1] = d.cxx[1];
+        return;
+    }
+    // Определитель xx * yy - xy^2 (для фазы 4 в переменных N[0], N[1]^2 он обращается в ноль одновременно с определителем по N)
+    f[2] = d.xx * d.yy - d.xy * d.xy;
+    for (unsigned k = 0; k < 2; ++k)
+        row[k] = d.cxx[k] * d.yy + d.xx * d.cyy[k] - 2 * d.xy * d.cxy[k];
+    row[2] = d.xxx * d.yy + d.xx * d.xyy - 2 * d.xy * d.xxy;
+    row[3] = d.xxy * d.yy + d.xx * d.yyy - 2 * d.xy * d.xyy;
+}
+
+
+bool SpinodalTracer::isValid(const State &z, TracedLine::End &reason)
+{
+    reason = TracedLine::Degenerate;
+    Coefficients c = coeffs;
+    c.a[0] = z[0];
+    c.b[0] = z[1];
+    double n[2];
+    if (!orderParameter(types[0], z[2], z[3], signs[0], n))
+        return false;
+    /* Второе собственное значение матрицы вторых производных (равное её следу) должно быть положительным
+     * (у фазы 1 оба собственных значения обращаются в ноль одновременно)
+     */
+    PhaseDerivatives d = orderDerivatives(c.c, n[0], n[1]);
+    return types[0] == 1 || d.xx + d.yy > 0;
+}
+
+
+std::vector<SpinodalLine> SpinodalTracer::trace()
+{
+    std::vector<SpinodalLine> res;
+    forEachEdge([this, &res](int i, int j, bool vertical, const DiagramPoint &first, const DiagramPoint &second)
+    {
+        for (unsigned type = 1; type <= 4; ++type)
+        {
+            unsigned a = phaseCount(first, type), b = phaseCount(second, type);
+            const unsigned char mask = 1 << (type - 1);
+            if (a == b || isCovered(i, j, mask))
+                continue;
+            // Фаза, теряющая устойчивость: на конце с большим числом фаз данного типа - с наименьшим определителем
+            const DiagramPoint &point = a > b ? first : second;
+            int pi = i, pj = j;
+            if (a < b)
+                ++(vertical ? pj : pi);
+            Coefficients c = coeffs;
+            c.a[0] = coeffs.a[0] + (size.height() - 1 - pj) * dY;
+            c.b[0] = coeffs.b[0] + pi * dX;
+            const PhaseInfo *phase = nullptr;
+            double det = 0.0;
+            for (const PhaseInfo &item : point.phases)
+                if (item.type == type)
+                {
+                    PhaseDerivatives d = orderDerivatives(c.c, item.n[0], item.n[1]);
+                    double value = d.xx * d.yy - d.xy * d.xy;
+                    if (!phase || value < det)
+                        phase = &item, det = value;
+                }
+            SpinodalLine line;
+            line.type = type;
+            if (!traceLine(vertical, initial(i, j, vertical, {*phase}), line))
+                continue;
+            cover(line.points, mask);
+            res.push_back(line);
+        }
+    });
+    return res;
+}
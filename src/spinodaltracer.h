@@ -0,0 +1,41 @@
+#ifndef SPINODALTRACER_H
+#define SPINODALTRACER_H
+
+#include "curvetracer.h"
+
+
+// Спинодаль - граница области существования фазы как локального минимума потенциала
+struct SpinodalLine : TracedLine
+{
+    unsigned type;  // Тип фазы в начальной точке линии
+};
+
+
+/* ---------------------------------------------------------------------------- *
+ * SpinodalTracer - построение спинодалей (границ метастабильности) фаз         *
+ * ---------------------------------------------------------------------------- *
+ *
+ * Спинодаль фазы - линия, на которой определитель матрицы вторых производных потенциала в её минимуме
+ * обращается в ноль: за ней фаза перестаёт быть локальным минимумом, что определяет границы гистерезиса.
+ * Уравнения: уравнения состояния фазы (см. phaseequations.h) и det(d2Phi/dN2) = 0 (для фазы 1 при N = 0
+ * матрица изотропна, и вместо определителя, имеющего двукратный ноль, используется d2Phi/dN[0]^2 = 0).
+ * Для фаз 2 и 3 (N[1] = 0) определитель равен произведению d2Phi/dN[0]^2 и d2Phi/dN[1]^2, так что спинодаль
+ * включает и исчезновение фазы, и потерю устойчивости по отношению к понижению симметрии (к фазе 4).
+ * Начальные точки - отрезки сетки, на концах которых различается число устойчивых фаз данного типа;
+ * из двух концов берётся тот, где фаз больше, а из его фаз данного типа - ближайшая к границе устойчивости
+ * (с наименьшим определителем). Линия продолжается в обе стороны (см. CurveTracer), пока вторая производная
+ * по направлению, в котором фаза остаётся устойчивой, положительна (иначе линия вырождается).
+ */
+
+class SpinodalTracer : public CurveTracer
+{
+public:
+    explicit SpinodalTracer(const Worker &diagram, double tolerance = 0.05);
+    // Строит спинодали всех типов фаз
+    std::vector<SpinodalLine> trace();
+protected:
+    void evaluate(const State &z, std::vector<double> &f, std::vector<double> &jacobian) const override;
+    bool isValid(const State &z, TracedLine::End &reason) override;
+};
+
+#endif // SPINODALTRACER_H
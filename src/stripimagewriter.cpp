@@ -0,0 +1,254 @@
+#include <algorithm>
+#include "stripimagewriter.h"
+
+using std::uint8_t;
+using std::uint16_t;
+using std::uint32_t;
+
+
+namespace
+{
+
+// Таблица для вычисления CRC-32 (полином 0xEDB88320)
+struct CrcTable
+{
+    uint32_t values[256];
+    CrcTable()
+    {
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            values[n] = c;
+        }
+    }
+};
+
+uint32_t crc32(uint32_t crc, const unsigned char *data, std::size_t size)
+{
+    static const CrcTable table;
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i)
+        crc = table.values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Запись чисел с заданным порядком байтов
+void putBE32(std::vector<unsigned char> &vec, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+        vec.push_back(static_cast<unsigned char>(value >> shift));
+}
+
+void putLE16(std::ostream &stream, uint16_t value)
+{
+    char bytes[2] {static_cast<char>(value), static_cast<char>(value >> 8)};
+    stream.write(bytes, 2);
+}
+
+void putLE32(std::ostream &stream, uint32_t value)
+{
+    char bytes[4] {static_cast<char>(value), static_cast<char>(value >> 8), static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+    stream.write(bytes, 4);
+}
+
+// Запись элемента каталога TIFF
+void putTiffEntry(std::ostream &stream, uint16_t tag, uint16_t type, uint32_t count, uint32_t value)
+{
+    putLE16(stream, tag);
+    putLE16(stream, type);
+    putLE32(stream, count);
+    if (type == 3 && count == 1)
+    {
+        // Значение типа SHORT выравнивается по левому краю поля
+        putLE16(stream, static_cast<uint16_t>(value));
+        putLE16(stream, 0);
+    }
+    else
+        putLE32(stream, value);
+}
+
+}
+
+
+StripImageWriter::StripImageWriter()
+    : format(Png), width(0), height(0), written(0), adler{1, 0}
+{
+
+}
+
+
+bool StripImageWriter::open(const std::string &fileName, Format imageFormat, uint32_t imageWidth, uint32_t imageHeight)
+{
+    format = imageFormat;
+    width = imageWidth;
+    height = imageHeight;
+    written = 0;
+    adler[0] = 1;
+    adler[1] = 0;
+    // Смещения в TIFF 32-разрядные
+    if (format == Tiff && static_cast<std::uint64_t>(width) * height * 3 > 0xfff00000u)
+        return false;
+    stream.open(fileName, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        return false;
+    if (format == Png)
+        writePngHeader();
+    else
+        writeTiffHeader();
+    return static_cast<bool>(stream);
+}
+
+
+void StripImageWriter::writeChunk(const char type[4], const unsigned char *data, std::size_t size)
+{
+    std::vector<unsigned char> head;
+    putBE32(head, size);
+    stream.write(reinterpret_cast<const char*>(head.data()), 4);
+    stream.write(type, 4);
+    stream.write(reinterpret_cast<const char*>(data), size);
+    uint32_t crc = crc32(0, reinterpret_cast<const unsigned char*>(type), 4);
+    crc = crc32(crc, data, size);
+    head.clear();
+    putBE32(head, crc);
+    stream.write(reinterpret_cast<const char*>(head.data()), 4);
+}
+
+
+void StripImageWriter::writePngHeader()
+{
+    const unsigned char signature[8] {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    stream.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+    // IHDR: размеры, 8 бит на канал, RGB, без чересстрочности
+    std::vector<unsigned char> ihdr;
+    putBE32(ihdr, width);
+    putBE32(ihdr, height);
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});
+    writeChunk("IHDR", ihdr.data(), ihdr.size());
+}
+
+
+void StripImageWriter::writeTiffHeader()
+{
+    // Смещение каталога заполняется в writeTiffDirectory()
+    stream.write("II*\0", 4);
+    putLE32(stream, 0);
+}
+
+
+bool StripImageWriter::writeRows(const uint32_t *pixels, uint32_t rows)
+{
+    rows = std::min(rows, height - written);
+    if (format == Png)
+    {
+        // Строки PNG: байт фильтра (0) и RGB-тройки
+        std::vector<unsigned char> raw;
+        raw.reserve(rows * (1 + 3 * static_cast<std::size_t>(width)));
+        for (uint32_t r = 0; r < rows; ++r)
+        {
+            raw.push_back(0);
+            for (uint32_t c = 0; c < width; ++c)
+            {
+                uint32_t p = pixels[static_cast<std::size_t>(r) * width + c];
+                raw.insert(raw.end(), {static_cast<unsigned char>(p >> 16), static_cast<unsigned char>(p >> 8), static_cast<unsigned char>(p)});
+            }
+        }
+        // Контрольная сумма Adler-32 несжатых данных
+        for (unsigned char byte : raw)
+        {
+            adler[0] = (adler[0] + byte) % 65521;
+            adler[1] = (adler[1] + adler[0]) % 65521;
+        }
+        // Упаковка в несжатые блоки deflate (не более 65535 байт), перед первым - заголовок потока zlib
+        buffer.clear();
+        if (!written)
+            buffer.insert(buffer.end(), {0x78, 0x01});
+        for (std::size_t pos = 0; pos < raw.size(); pos += 65535)
+        {
+            uint16_t len = static_cast<uint16_t>(std::min<std::size_t>(65535, raw.size() - pos));
+            uint16_t nlen = ~len;
+            buffer.insert(buffer.end(), {0, static_cast<unsigned char>(len), static_cast<unsigned char>(len >> 8),
+                                         static_cast<unsigned char>(nlen), static_cast<unsigned char>(nlen >> 8)});
+            buffer.insert(buffer.end(), raw.begin() + pos, raw.begin() + pos + len);
+        }
+        writeChunk("IDAT", buffer.data(), buffer.size());
+    }
+    else
+    {
+        buffer.resize(static_cast<std::size_t>(rows) * width * 3);
+        for (std::size_t i = 0; i < static_cast<std::size_t>(rows) * width; ++i)
+        {
+            buffer[3 * i] = static_cast<unsigned char>(pixels[i] >> 16);
+            buffer[3 * i + 1] = static_cast<unsigned char>(pixels[i] >> 8);
+            buffer[3 * i + 2] = static_cast<unsigned char>(pixels[i]);
+        }
+        stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+    written += rows;
+    return static_cast<bool>(stream);
+}
+
+
+void StripImageWriter::writeTiffDirectory()
+{
+    const uint32_t stripBytes = tiffRowsPerStrip * width * 3;
+    const uint32_t strips = (height + tiffRowsPerStrip - 1) / tiffRowsPerStrip;
+    uint32_t offset = static_cast<uint32_t>(stream.tellp());
+    // Выравнивание по границе слова
+    if (offset % 2)
+    {
+        stream.put(0);
+        ++offset;
+    }
+    // Вспомогательные массивы: BitsPerSample, StripOffsets, StripByteCounts
+    const uint32_t bitsOffset = offset;
+    const uint32_t offsetsOffset = bitsOffset + 8;
+    const uint32_t countsOffset = offsetsOffset + 4 * strips;
+    const uint32_t directoryOffset = countsOffset + 4 * strips;
+    for (int i = 0; i < 4; ++i)
+        putLE16(stream, i < 3 ? 8 : 0);
+    for (uint32_t i = 0; i < strips; ++i)
+        putLE32(stream, 8 + i * stripBytes);
+    for (uint32_t i = 0; i < strips; ++i)
+        putLE32(stream, i + 1 < strips ? stripBytes : (height - i * tiffRowsPerStrip) * width * 3);
+
+    // Каталог (теги по возрастанию)
+    putLE16(stream, 10);
+    putTiffEntry(stream, 256, 4, 1, width);                         // ImageWidth
+    putTiffEntry(stream, 257, 4, 1, height);                        // ImageLength
+    putTiffEntry(stream, 258, 3, 3, bitsOffset);                    // BitsPerSample
+    putTiffEntry(stream, 259, 3, 1, 1);                             // Compression: нет
+    putTiffEntry(stream, 262, 3, 1, 2);                             // PhotometricInterpretation: RGB
+    putTiffEntry(stream, 273, 4, strips, strips > 1 ? offsetsOffset : 8);    // StripOffsets
+    putTiffEntry(stream, 277, 3, 1, 3);                             // SamplesPerPixel
+    putTiffEntry(stream, 278, 4, 1, tiffRowsPerStrip);              // RowsPerStrip
+    putTiffEntry(stream, 279, 4, strips, strips > 1 ? countsOffset : height * width * 3);   // StripByteCounts
+    putTiffEntry(stream, 284, 3, 1, 1);                             // PlanarConfiguration
+    putLE32(stream, 0);
+
+    // Ссылка на каталог в заголовке
+    stream.seekp(4);
+    putLE32(stream, directoryOffset);
+}
+
+
+bool StripImageWriter::close()
+{
+    if (!stream.is_open())
+        return false;
+    bool complete = written == height;
+    if (format == Png)
+    {
+        // Последний пустой блок deflate, контрольная сумма zlib и завершающий блок IEND
+        std::vector<unsigned char> tail {1, 0, 0, 0xff, 0xff};
+        putBE32(tail, (adler[1] << 16) | adler[0]);
+        writeChunk("IDAT", tail.data(), tail.size());
+        writeChunk("IEND", nullptr, 0);
+    }
+    else
+        writeTiffDirectory();
+    bool ok = static_cast<bool>(stream);
+    stream.close();
+    return ok && complete;
+}
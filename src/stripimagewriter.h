@@ -0,0 +1,44 @@
+#ifndef STRIPIMAGEWRITER_H
+#define STRIPIMAGEWRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* Потоковая запись изображения по полосам строк.
+ * Изображение не хранится в памяти целиком, поэтому его размер ограничен только диском.
+ * PNG записывается без сжатия (несжатые блоки deflate), TIFF - без сжатия, по 16 строк в полосе.
+ * Пикселы передаются в формате 0xAARRGGBB (как QRgb), альфа-канал не сохраняется.
+ */
+
+class StripImageWriter
+{
+public:
+    enum Format {Png, Tiff};
+private:
+    static constexpr std::uint32_t tiffRowsPerStrip = 16;
+    std::ofstream stream;
+    Format format;
+    std::uint32_t width, height;    // Размеры изображения
+    std::uint32_t written;          // Количество записанных строк
+    std::uint32_t adler[2];         // Контрольная сумма Adler-32 данных PNG
+    std::vector<unsigned char> buffer;
+    // Запись блока PNG (chunk) с вычислением CRC
+    void writeChunk(const char type[4], const unsigned char *data, std::size_t size);
+    // Запись заголовков
+    void writePngHeader();
+    void writeTiffHeader();
+    // Запись каталога TIFF (IFD) в конец файла
+    void writeTiffDirectory();
+public:
+    StripImageWriter();
+    // Создаёт файл и записывает заголовок. Возвращает false в случае ошибки (в т.ч. если TIFF превысит 4 ГБ).
+    bool open(const std::string &fileName, Format imageFormat, std::uint32_t imageWidth, std::uint32_t imageHeight);
+    // Записывает rows очередных строк (width * rows пикселов). Возвращает false в случае ошибки.
+    bool writeRows(const std::uint32_t *pixels, std::uint32_t rows);
+    // Завершает запись (должны быть записаны все строки). Возвращает false в случае ошибки.
+    bool close();
+};
+
+#endif // STRIPIMAGEWRITER_H
@@ -0,0 +1,99 @@
+#include <QtWidgets>
+#include "sweepdialog.h"
+
+
+// Номера коэффициентов Альфа2..Альфа4, Бета2, Дельта1..Дельта3 в Coefficients::c (Альфа1 и Бета1 - оси диаграммы)
+static const unsigned sweepIndexes[7] {1, 2, 3, 5, 6, 7, 8};
+
+
+SweepDialog::SweepDialog(QWidget *parent, bool volume)
+    : QDialog(parent)
+{
+    QStringList lst;
+    lst << "\u03B12" << "\u03B13" << "\u03B14" << "\u03B22" << "\u03B41" << "\u03B42" << "\u03B43";
+
+    cmbCoefficient = new QComboBox;
+    cmbCoefficient->addItems(lst);
+
+    spbFrom = new QDoubleSpinBox;
+    spbTo = new QDoubleSpinBox;
+    for (QDoubleSpinBox *spb : {spbFrom, spbTo})
+    {
+        spb->setRange(-1000, 1000);
+        spb->setDecimals(4);
+    }
+    spbFrom->setValue(-1);
+    spbTo->setValue(1);
+
+    spbFrames = new QSpinBox;
+    spbFrames->setRange(2, 10000);
+    spbFrames->setValue(volume ? 20 : 50);
+
+    // Выбор каталога
+    edtDirectory = new QLineEdit;
+    QPushButton *btnBrowse = new QPushButton("...");
+    connect(btnBrowse, &QPushButton::clicked, [this]()
+    {
+        QString path = QFileDialog::getExistingDirectory(this, "Каталог для записи кадров", edtDirectory->text());
+        if (!path.isEmpty())
+            edtDirectory->setText(path);
+    });
+    QHBoxLayout *lytDirectory = new QHBoxLayout;
+    lytDirectory->addWidget(edtDirectory);
+    lytDirectory->addWidget(btnBrowse);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttons, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+
+    QFormLayout *lytForm = new QFormLayout;
+    lytForm->addRow("Изменяемый коэффициент", cmbCoefficient);
+    lytForm->addRow("Начальное значение", spbFrom);
+    lytForm->addRow("Конечное значение", spbTo);
+    lytForm->addRow(volume ? "Число слоёв" : "Число кадров", spbFrames);
+    lytForm->addRow("Каталог", lytDirectory);
+    // Трёхмерная диаграмма не записывается в файлы: строка каталога скрыта
+    if (volume)
+    {
+        lytForm->labelForField(lytDirectory)->hide();
+        edtDirectory->hide();
+        btnBrowse->hide();
+    }
+
+    QVBoxLayout *lytVBox = new QVBoxLayout;
+    lytVBox->addLayout(lytForm);
+    lytVBox->addWidget(buttons);
+    setLayout(lytVBox);
+
+    setWindowTitle(volume ? "Трёхмерная диаграмма" : "Экспорт анимации");
+}
+
+
+unsigned SweepDialog::coefficient() const
+{
+    return sweepIndexes[cmbCoefficient->currentIndex()];
+}
+
+
+double SweepDialog::from() const
+{
+    return spbFrom->value();
+}
+
+
+double SweepDialog::to() const
+{
+    return spbTo->value();
+}
+
+
+unsigned SweepDialog::frames() const
+{
+    return spbFrames->value();
+}
+
+
+QString SweepDialog::directory() const
+{
+    return edtDirectory->text();
+}
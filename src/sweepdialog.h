@@ -0,0 +1,35 @@
+#ifndef SWEEPDIALOG_H
+#define SWEEPDIALOG_H
+
+#include <QDialog>
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QDoubleSpinBox;
+class QLineEdit;
+class QSpinBox;
+QT_END_NAMESPACE
+
+/* Диалог задания параметров экспорта анимации (изменяемый коэффициент, диапазон, число кадров, каталог).
+ * В режиме volume = true - параметры трёхмерной диаграммы (каталог не задаётся, кадры - слои по третьей оси).
+ */
+
+class SweepDialog : public QDialog
+{
+private:
+    QComboBox *cmbCoefficient;      // Изменяемый коэффициент
+    QDoubleSpinBox *spbFrom;        // Начальное значение
+    QDoubleSpinBox *spbTo;          // Конечное значение
+    QSpinBox *spbFrames;            // Число кадров
+    QLineEdit *edtDirectory;        // Каталог для записи кадров
+public:
+    SweepDialog(QWidget *parent = 0, bool volume = false);
+    // Номер выбранного коэффициента в Coefficients::c
+    unsigned coefficient() const;
+    double from() const;
+    double to() const;
+    unsigned frames() const;
+    QString directory() const;
+};
+
+#endif // SWEEPDIALOG_H
@@ -0,0 +1,232 @@
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "sweepexporter.h"
+
+
+namespace
+{
+    // Worker для расчёта кадра: прерывает расчёт кадра, когда прерван экспорт (проверка после каждого столбца)
+    class FrameWorker : public Worker
+    {
+    private:
+        const std::atomic<bool> &stop;
+    protected:
+        void progress(int percent) override
+        {
+            if (stop)
+                cancel();
+            Worker::progress(percent);
+        }
+    public:
+        FrameWorker(QSize size, const std::atomic<bool> &flag)
+            : Worker(size), stop(flag)
+        {
+
+        }
+    };
+}
+
+
+SweepExporter::SweepExporter(QObject *parent)
+    : QObject(parent), cancelled(false)
+{
+
+}
+
+
+void SweepExporter::setParameters(const Coefficients coefficients, const double stepX, const double stepY, const QSize frameSize,
+                                  const unsigned coefficient, const double first, const double last, const unsigned count,
+                                  const QString &path, const DiagramPainter &diagramPainter)
+{
+    coeffs = coefficients;
+    dX = stepX;
+    dY = stepY;
+    size = frameSize;
+    index = coefficient;
+    from = first;
+    to = last;
+    frames = count;
+    directory = path;
+    painter = diagramPainter;
+}
+
+
+void SweepExporter::cancel()
+{
+    cancelled = true;
+}
+
+
+QString SweepExporter::getFileName(unsigned frame) const
+{
+    return QDir(directory).filePath(QString("frame_%1.png").arg(frame, 4, 10, QChar('0')));
+}
+
+
+double SweepExporter::getValue(unsigned frame) const
+{
+    return frames > 1 ? from + (to - from) * frame / (frames - 1) : from;
+}
+
+
+QString SweepExporter::getStatisticsFileName() const
+{
+    return QDir(directory).filePath("statistics.csv");
+}
+
+
+/* Строка статистики кадра: номер кадра, значение изменяемого коэффициента, число точек и площадь диаграммы,
+ * доли по типу наиболее устойчивой фазы, по наборам устойчивых фаз и по областям сосуществования
+ * изосимметрийных модификаций фаз 2..4, число точек и длина линий переходов первого рода.
+ * При frame < 0 возвращается заголовок.
+ */
+static QString statisticsRow(int frame, double value, const DiagramStatistics &st)
+{
+    QStringList items;
+    if (frame < 0)
+    {
+        items << "frame" << "value" << "points" << "area";
+        for (unsigned k = 0; k <= 4; ++k)
+            items << QString("stablest_%1").arg(k);
+        for (unsigned set = 0; set < 16; ++set)
+        {
+            QString name = "phases_";
+            for (unsigned k = 0; k < 4; ++k)
+                if (set & (1u << k))
+                    name += QString::number(k + 1);
+            items << (set ? name : "phases_none");
+        }
+        for (unsigned k = 2; k <= 4; ++k)
+            items << QString("isosymmetric_%1").arg(k);
+        for (unsigned k = 0; k <= DiagramStatistics::maxMinima; ++k)
+            items << QString("minima_%1").arg(k);
+        items << "transition_points" << "transition_length";
+    }
+    else
+    {
+        items << QString::number(frame) << QString::number(value, 'g', 10) << QString::number(st.points)
+              << QString::number(st.area(st.points), 'g', 10);
+        for (unsigned k = 0; k <= 4; ++k)
+            items << QString::number(st.fraction(st.stablest[k]), 'g', 6);
+        for (unsigned set = 0; set < 16; ++set)
+            items << QString::number(st.fraction(st.combinations[set]), 'g', 6);
+        for (unsigned k = 2; k <= 4; ++k)
+            items << QString::number(st.fraction(st.isosymmetric[k]), 'g', 6);
+        for (unsigned k = 0; k <= DiagramStatistics::maxMinima; ++k)
+            items << QString::number(st.fraction(st.minima[k]), 'g', 6);
+        items << QString::number(st.transitions) << QString::number(st.transitionLength(), 'g', 6);
+    }
+    return items.join(',') + '\n';
+}
+
+
+void SweepExporter::run()
+{
+    cancelled = false;
+    // Одновременно в памяти находится не более maxInFlight рассчитанных, но не записанных кадров
+    const unsigned threadsCount = std::max(1, QThread::idealThreadCount());
+    const unsigned maxInFlight = 2 * threadsCount;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Рассчитанные кадры (изображение и статистика), ожидающие записи
+    std::map<unsigned, std::pair<QImage, DiagramStatistics>> ready;
+    unsigned next = 0;                  // Номер следующего кадра для расчёта
+    unsigned written = 0;               // Число записанных кадров
+    bool failed = false;
+
+    /* Расчёт кадров. Каждый поток использует один Worker для всех своих кадров: буферы диаграммы
+     * и рабочая память поиска корней (SolverContext) не выделяются заново. Прерывание экспорта
+     * прерывает и рассчитываемые кадры.
+     */
+    auto compute = [&]()
+    {
+        FrameWorker worker(size, cancelled);
+        Coefficients c = coeffs;
+        for (;;)
+        {
+            unsigned frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]{return next >= frames || next < written + maxInFlight || cancelled || failed;});
+                if (next >= frames || cancelled || failed)
+                    return;
+                frame = next++;
+            }
+            c.c[index] = getValue(frame);
+            worker.setParameters(c, dX, dY);
+            worker.calculate();
+            if (worker.isCancelled())
+            {
+                // Поток записи ждёт кадра и должен узнать о прерывании
+                std::lock_guard<std::mutex> lock(mutex);
+                cv.notify_all();
+                return;
+            }
+            DiagramCurves curves;
+            painter.prepare(worker, curves);
+            QImage image(size, QImage::Format_RGB32);
+            painter.paint(worker, curves, image);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[frame] = std::make_pair(image, worker.getStatistics());
+            }
+            cv.notify_all();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < std::min(threadsCount, frames); ++i)
+        threads.emplace_back(compute);
+
+    // Запись кадров и их статистики по порядку
+    QFile statisticsFile(getStatisticsFileName());
+    QTextStream statistics(&statisticsFile);
+    if (statisticsFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        statistics << statisticsRow(-1, 0.0, DiagramStatistics());
+    else
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed = true;
+    }
+    while (written < frames && !failed)
+    {
+        std::pair<QImage, DiagramStatistics> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&]{return ready.count(written) || cancelled;});
+            if (cancelled)
+                break;
+            frame = ready[written];
+            ready.erase(written);
+        }
+        statistics << statisticsRow(written, getValue(written), frame.second);
+        statistics.flush();
+        if (!frame.first.save(getFileName(written), "PNG") || statistics.status() != QTextStream::Ok)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            failed = true;
+            break;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++written;
+        }
+        cv.notify_all();
+        emit processed(100 * written / frames);
+    }
+    cv.notify_all();
+
+    for (auto &t : threads)
+        t.join();
+
+    emit finished(!failed && !cancelled);
+}
@@ -0,0 +1,58 @@
+#ifndef SWEEPEXPORTER_H
+#define SWEEPEXPORTER_H
+
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <atomic>
+#include "worker.h"
+#include "diagrampainter.h"
+
+/* Экспорт анимации: серия диаграмм при изменении одного из коэффициентов потенциала.
+ * Кадры рассчитываются параллельно (по одному объекту Worker на каждое ядро, объекты используются повторно
+ * для всех обрабатываемых ими кадров; cancel() прерывает и кадры, расчёт которых уже начат) и записываются в каталог в виде пронумерованных файлов PNG
+ * строго по порядку. Число одновременно находящихся в памяти кадров ограничено.
+ * Статистика каждого кадра (см. DiagramStatistics) записывается строкой в файл statistics.csv того же каталога.
+ */
+
+class SweepExporter : public QObject
+{
+    Q_OBJECT
+private:
+    Coefficients coeffs;        // Коэффициенты (Альфа1 и Бета1 - стартовые значения)
+    double dX, dY;              // Шаги по Бета1 и Альфа1
+    QSize size;                 // Размер кадра
+    unsigned index;             // Номер изменяемого коэффициента в Coefficients::c
+    double from, to;            // Диапазон изменения коэффициента
+    unsigned frames;            // Число кадров
+    QString directory;          // Каталог для записи файлов
+    DiagramPainter painter;     // Параметры отображения
+    std::atomic<bool> cancelled;
+public:
+    SweepExporter(QObject *parent = 0);
+    /* Установка параметров. Функция должна быть вызвана перед вызовом run().
+     * coefficients, stepX, stepY и frameSize - как при расчёте обычной диаграммы;
+     * coefficient - номер изменяемого коэффициента в Coefficients::c, меняющегося от first до last за count кадров.
+     */
+    void setParameters(const Coefficients coefficients, const double stepX, const double stepY, const QSize frameSize,
+                       const unsigned coefficient, const double first, const double last, const unsigned count,
+                       const QString &path, const DiagramPainter &diagramPainter);
+    // Прерывает экспорт (может вызываться из любого потока)
+    void cancel();
+    // Возвращает имя файла кадра с номером frame
+    QString getFileName(unsigned frame) const;
+    // Возвращает значение изменяемого коэффициента в кадре с номером frame
+    double getValue(unsigned frame) const;
+    // Возвращает имя файла статистики кадров
+    QString getStatisticsFileName() const;
+public slots:
+    // Запуск экспорта
+    void run();
+signals:
+    // Сигнал о записи percent % кадров
+    void processed(int percent);
+    // Сигнал о завершении работы (success = false, если экспорт прерван или не удалось записать файл)
+    void finished(bool success);
+};
+
+#endif // SWEEPEXPORTER_H
@@ -0,0 +1,315 @@
+#include <QDataStream>
+#include <QFile>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "tilefarm.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+
+namespace
+{
+    // Дописывает в out сообщение: длину и данные
+    void appendMessage(QByteArray &out, const QByteArray &payload)
+    {
+        QDataStream stream(&out, QIODevice::WriteOnly | QIODevice::Append);
+        stream << static_cast<quint32>(payload.size());
+        out.append(payload);
+    }
+
+    // Читает из device ровно size байт (false при закрытии или ошибке)
+    bool readFully(QIODevice &device, char *data, qint64 size)
+    {
+        while (size > 0)
+        {
+            qint64 n = device.read(data, size);
+            if (n <= 0)
+                return false;
+            data += n;
+            size -= n;
+        }
+        return true;
+    }
+}
+
+
+TileFarm::TileFarm(const QString &program, const QStringList &arguments, unsigned processes)
+    : program(program), arguments(arguments), processes(processes)
+{
+    for (Process &p : this->processes)
+    {
+        p.busy = false;
+        p.restarts = 0;
+        start(p);
+    }
+}
+
+
+TileFarm::~TileFarm()
+{
+    /* Закрытие стандартного ввода завершает вычислительные процессы. Процессы завершаются одновременно,
+     * поэтому общее ожидание ограничено одной секундой, а не секундой на каждый процесс
+     */
+    for (Process &p : processes)
+        if (p.process)
+            p.process->closeWriteChannel();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    for (Process &p : processes)
+        if (p.process)
+        {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            p.process->waitForFinished(left > 0 ? static_cast<int>(left) : 0);
+        }
+    // Не завершившиеся процессы прерываются все сразу
+    for (Process &p : processes)
+        if (p.process && p.process->state() != QProcess::NotRunning)
+            p.process->kill();
+    for (Process &p : processes)
+        if (p.process && p.process->state() != QProcess::NotRunning)
+            p.process->waitForFinished(1000);
+}
+
+
+void TileFarm::setParameters(const Coefficients &coefficients, double stepX, double stepY, std::size_t rows)
+{
+    parameters.clear();
+    QDataStream stream(&parameters, QIODevice::WriteOnly);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    stream << static_cast<quint64>(rows);
+    for (double c : coefficients.c)
+        stream << c;
+    stream << stepX << stepY;
+}
+
+
+void TileFarm::submit(std::size_t first, std::size_t count)
+{
+    queue.push_back({first, count, 0});
+}
+
+
+bool TileFarm::start(Process &p)
+{
+    p.process.reset(new QProcess);
+    p.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    p.process->start(program, arguments);
+    p.buffer.clear();
+    if (!p.process->waitForStarted())
+    {
+        p.process.reset();
+        return false;
+    }
+    return true;
+}
+
+
+void TileFarm::dispatch()
+{
+    for (Process &p : processes)
+        if (p.process && !p.busy && !queue.empty())
+        {
+            p.tile = queue.front();
+            queue.pop_front();
+            p.busy = true;
+            QByteArray payload;
+            QDataStream stream(&payload, QIODevice::WriteOnly);
+            stream << static_cast<quint64>(p.tile.first) << static_cast<quint64>(p.tile.count);
+            payload.append(parameters);
+            QByteArray message;
+            appendMessage(message, payload);
+            if (p.process->write(message) != message.size())
+                recover(p);
+        }
+    // Процессов не осталось - оставшиеся задания рассчитываются координатором
+    bool alive = false;
+    for (const Process &p : processes)
+        alive = alive || p.process;
+    if (!alive)
+    {
+        failed.insert(failed.end(), queue.begin(), queue.end());
+        queue.clear();
+    }
+}
+
+
+void TileFarm::recover(Process &p)
+{
+    Tile tile = p.tile;
+    p.busy = false;
+    if (++tile.attempts < maxAttempts)
+        queue.push_front(tile);
+    else
+        failed.push_back(tile);
+    if (p.process)
+        p.process->kill();
+    if (p.restarts++ < maxRestarts)
+        start(p);
+    else
+        p.process.reset();
+}
+
+
+bool TileFarm::readResult(Process &p, Result &result)
+{
+    p.buffer.append(p.process->readAllStandardOutput());
+    if (p.buffer.size() < 4)
+        return false;
+    QDataStream header(p.buffer);
+    quint32 size;
+    header >> size;
+    if (static_cast<quint32>(p.buffer.size()) - 4 < size)
+        return false;
+
+    QDataStream stream(p.buffer.mid(4, size));
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    p.buffer.remove(0, 4 + size);
+    p.busy = false;
+    quint64 first, count;
+    quint64 solverCalls, refinedPoints;
+    stream >> first >> count >> solverCalls >> refinedPoints >> result.metrics.rootTime >> result.metrics.stabilityTime;
+    result.first = first;
+    result.failed = false;
+    result.metrics.solverCalls = solverCalls;
+    result.metrics.refinedPoints = refinedPoints;
+    result.columns.resize(count);
+    for (auto &column : result.columns)
+    {
+        quint64 rows;
+        stream >> rows;
+        column.resize(rows);
+        for (DiagramPoint &dp : column)
+        {
+            qint64 stablest;
+            quint32 phases;
+            stream >> dp.x >> dp.y >> stablest >> phases;
+            dp.stablest = stablest;
+            dp.transition = false;
+            dp.phases.resize(phases);
+            for (PhaseInfo &phase : dp.phases)
+            {
+                quint32 type;
+                stream >> type >> phase.phi >> phase.n[0] >> phase.n[1];
+                phase.type = type;
+            }
+        }
+    }
+    // Повреждённый ответ считается аварийным завершением процесса
+    if (stream.status() != QDataStream::Ok || first != p.tile.first || count != p.tile.count)
+    {
+        p.busy = true;
+        recover(p);
+        return false;
+    }
+    return true;
+}
+
+
+bool TileFarm::wait(Result &result, int timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    for (;;)
+    {
+        // Аварийно завершившиеся процессы
+        for (Process &p : processes)
+            if (p.busy && p.process->state() == QProcess::NotRunning && !p.process->bytesAvailable())
+                recover(p);
+        dispatch();
+        for (Process &p : processes)
+            if (p.busy && readResult(p, result))
+                return true;
+        if (!failed.empty())
+        {
+            result.first = failed.front().first;
+            result.failed = true;
+            result.columns.assign(failed.front().count, std::vector<DiagramPoint>());
+            result.metrics = RunMetrics();
+            failed.pop_front();
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        bool busy = false;
+        for (Process &p : processes)
+            if (p.busy)
+            {
+                busy = true;
+                p.process->waitForReadyRead(10);
+            }
+        if (!busy)
+            return false;
+    }
+}
+
+
+int TileFarm::serve(const QStringList &arguments)
+{
+    int crashAfter = -1;
+    int index = arguments.indexOf("--crash-after");
+    if (index >= 0 && index + 1 < arguments.size())
+        crashAfter = arguments[index + 1].toInt();
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    QFile input, output;
+    if (!input.open(stdin, QIODevice::ReadOnly | QIODevice::Unbuffered) ||
+        !output.open(stdout, QIODevice::WriteOnly | QIODevice::Unbuffered))
+        return 1;
+
+    for (int done = 0; ; ++done)
+    {
+        quint32 size;
+        QByteArray header(4, 0);
+        if (!readFully(input, header.data(), 4))
+            return 0;
+        QDataStream(header) >> size;
+        QByteArray payload(size, 0);
+        if (!readFully(input, payload.data(), size))
+            return 1;
+        if (done == crashAfter)
+            std::abort();
+
+        QDataStream stream(payload);
+        stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        quint64 first, count, rows;
+        Coefficients coefficients;
+        double stepX, stepY;
+        stream >> first >> count >> rows;
+        for (double &c : coefficients.c)
+            stream >> c;
+        stream >> stepX >> stepY;
+        if (stream.status() != QDataStream::Ok)
+            return 1;
+
+        DiagramEngine engine(0, rows);
+        engine.setParameters(coefficients, stepX, stepY);
+        std::vector<std::vector<DiagramPoint>> columns;
+        engine.calculateColumns(first, count, columns);
+        RunMetrics metrics = engine.getMetrics();
+
+        QByteArray reply;
+        QDataStream out(&reply, QIODevice::WriteOnly);
+        out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        out << first << count << static_cast<quint64>(metrics.solverCalls) << static_cast<quint64>(metrics.refinedPoints)
+            << metrics.rootTime << metrics.stabilityTime;
+        for (const auto &column : columns)
+        {
+            out << static_cast<quint64>(column.size());
+            for (const DiagramPoint &dp : column)
+            {
+                out << dp.x << dp.y << static_cast<qint64>(dp.stablest) << static_cast<quint32>(dp.phases.size());
+                for (const PhaseInfo &phase : dp.phases)
+                    out << static_cast<quint32>(phase.type) << phase.phi << phase.n[0] << phase.n[1];
+            }
+        }
+        QByteArray message;
+        appendMessage(message, reply);
+        if (output.write(message) != message.size() || !output.flush())
+            return 1;
+    }
+}
@@ -0,0 +1,92 @@
+#ifndef TILEFARM_H
+#define TILEFARM_H
+
+#include <QByteArray>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "diagramengine.h"
+
+
+/* ---------------------------------------------------------------------------- *
+ * TileFarm - координатор распределённого расчёта диаграммы в нескольких        *
+ * процессах                                                                    *
+ * ---------------------------------------------------------------------------- *
+ *
+ * Диаграмма разбивается на полосы из нескольких столбцов (задания), которые раздаются
+ * вычислительным процессам. Процесс запускается заданной командой (обычно - сама программа
+ * с ключом --tile-worker, см. serve()) и обменивается с координатором сообщениями
+ * через стандартные потоки ввода и вывода. Сообщение - длина (quint32) и данные в формате QDataStream:
+ * задание - номер первого столбца, число столбцов, число строк, коэффициенты потенциала
+ * со стартовыми значениями Альфа1 и Бета1 и шаги; ответ - номер первого столбца, число столбцов,
+ * показатели производительности и точки диаграммы (без признака перехода первого рода).
+ * Если процесс завершился аварийно, его задание выдаётся повторно, а процесс перезапускается.
+ * Задание, не рассчитанное за maxAttempts попыток (или оставшееся без процессов), возвращается
+ * как неудавшееся и рассчитывается координатором.
+ * Все функции, кроме serve(), вызываются из одного потока (цикл обработки событий не требуется).
+ */
+
+class TileFarm
+{
+public:
+    // Результат задания
+    struct Result
+    {
+        std::size_t first;                                  // Номер первого столбца
+        bool failed;                                        // Задание не удалось рассчитать в процессах
+        std::vector<std::vector<DiagramPoint>> columns;     // Столбцы (при failed - пустые, нужного количества)
+        RunMetrics metrics;                                 // Показатели производительности процесса
+    };
+    TileFarm(const QString &program, const QStringList &arguments, unsigned processes);
+    ~TileFarm();
+    // Параметры диаграммы: коэффициенты со стартовыми значениями Альфа1 и Бета1, шаги и число строк
+    void setParameters(const Coefficients &coefficients, double stepX, double stepY, std::size_t rows);
+    // Добавляет в очередь задание - столбцы first..first + count - 1
+    void submit(std::size_t first, std::size_t count);
+    /* Ожидает завершения какого-либо задания не дольше timeout мс.
+     * Возвращает false, если за это время ни одно задание не завершилось.
+     */
+    bool wait(Result &result, int timeout);
+    /* Цикл вычислительного процесса: читает задания из стандартного ввода и пишет результаты
+     * в стандартный вывод до закрытия ввода. Ключ --crash-after N в arguments аварийно завершает
+     * процесс при получении задания после N выполненных (для проверки восстановления).
+     */
+    static int serve(const QStringList &arguments);
+private:
+    // Число попыток расчёта задания в процессах и число перезапусков каждого процесса
+    static constexpr unsigned maxAttempts = 3;
+    static constexpr unsigned maxRestarts = 3;
+    struct Tile
+    {
+        std::size_t first, count;
+        unsigned attempts;
+    };
+    struct Process
+    {
+        std::unique_ptr<QProcess> process;  // Пустой, если процесс не удалось (пере)запустить
+        bool busy;                          // Процессу выдано задание tile
+        Tile tile;
+        unsigned restarts;
+        QByteArray buffer;                  // Принятая часть ответа
+    };
+    QString program;
+    QStringList arguments;
+    std::vector<Process> processes;
+    // Очередь заданий и задания, которые не удалось рассчитать в процессах
+    std::deque<Tile> queue, failed;
+    // Общая часть сообщения-задания (число строк, коэффициенты и шаги)
+    QByteArray parameters;
+    bool start(Process &p);
+    // Выдаёт задания свободным процессам
+    void dispatch();
+    // Возвращает задание аварийно завершившегося процесса в очередь и перезапускает процесс
+    void recover(Process &p);
+    // Извлекает из принятых данных ответ, если он получен полностью
+    bool readResult(Process &p, Result &result);
+};
+
+#endif // TILEFARM_H
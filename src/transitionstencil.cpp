@@ -0,0 +1,39 @@
+#include "transitionstencil.h"
+
+
+TransitionStencil::TransitionStencil()
+    : width(0), height(0)
+{
+
+}
+
+
+void TransitionStencil::reset(std::size_t w, std::size_t h)
+{
+    width = w;
+    height = h;
+    keys.clear();
+    keys.reserve(width * height);
+}
+
+
+void TransitionStencil::appendColumn(const std::vector<DiagramPoint> &column)
+{
+    for (const DiagramPoint &point : column)
+        keys.push_back(key(point));
+}
+
+
+std::size_t TransitionStencil::columnsCount() const
+{
+    return height ? keys.size() / height : 0;
+}
+
+
+TransitionStencil::Key TransitionStencil::key(const DiagramPoint &point)
+{
+    Key res = 0;
+    for (const PhaseInfo &item : point.phases)
+        res |= 1u << (item.type - 1);
+    return res | std::min<std::ptrdiff_t>(point.stablest + 1, 15) << 4;
+}
@@ -0,0 +1,88 @@
+#ifndef TRANSITIONSTENCIL_H
+#define TRANSITIONSTENCIL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "diagrampoint.h"
+
+/* Определение фазовых переходов первого рода отдельным проходом по сетке.
+ * Для каждой точки хранится ключ - один байт: биты 0..3 - набор типов устойчивых фаз (бит k - фаза k + 1),
+ * биты 4..7 - индекс наиболее устойчивой фазы в векторе phases, увеличенный на 1 (0 - устойчивых фаз нет).
+ * Признак перехода в точке зависит только от ключей самой точки и её соседей слева (i - 1, j) и сверху (i, j - 1),
+ * поэтому проход не связан с расчётом точек: он выполняется после расчёта диаграммы, параллельно по полосам
+ * столбцов, и может быть повторён с другим критерием без пересчёта. Внутренний цикл по строкам обрабатывает
+ * массивы байтов без ветвлений и векторизуется компилятором.
+ */
+
+class TransitionStencil
+{
+public:
+    typedef std::uint8_t Key;
+    // Критерий Worker: одинаковые наборы из нескольких фаз, но разные наиболее устойчивые фазы
+    struct FirstOrder
+    {
+        Key operator()(Key point, Key neighbour) const
+        {
+            // Без ветвлений (& вместо &&), чтобы цикл по строкам векторизовался
+            Key set = point & 0x0f, diff = point ^ neighbour;
+            return Key((set & (set - 1)) != 0) & Key((diff & 0x0f) == 0) & Key(diff != 0);
+        }
+    };
+
+    TransitionStencil();
+    // Подготовка к заполнению ключей диаграммы размером w x h
+    void reset(std::size_t w, std::size_t h);
+    // Запоминает ключи точек очередного столбца (столбцы добавляются по порядку)
+    void appendColumn(const std::vector<DiagramPoint> &column);
+    // Возвращает количество добавленных столбцов
+    std::size_t columnsCount() const;
+    /* Ключ точки. Индексы наиболее устойчивой фазы больше 14 не различаются
+     * (столько локальных минимумов у потенциала не бывает).
+     */
+    static Key key(const DiagramPoint &point);
+    /* Определяет переходы во всех добавленных столбцах по критерию criterion(ключ точки, ключ соседа).
+     * Для каждого столбца i вызывается visit(i, flags), где flags[j] - признак перехода в точке (i, j);
+     * visit вызывается из нескольких потоков одновременно (для разных столбцов).
+     */
+    template<class Criterion, class Visit>
+    void run(Criterion criterion, Visit visit) const;
+private:
+    // Не менее minColumns столбцов на поток, иначе накладные расходы на запуск потоков не окупаются
+    static constexpr std::size_t minColumns = 64;
+    std::size_t width, height;
+    std::vector<Key> keys;  // Ключи точек по столбцам
+};
+
+
+template<class Criterion, class Visit>
+void TransitionStencil::run(Criterion criterion, Visit visit) const
+{
+    const std::size_t columns = columnsCount();
+    std::size_t threadsCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), columns / minColumns));
+    auto strip = [this, criterion, &visit, columns, threadsCount](std::size_t k)
+    {
+        std::vector<Key> flags(height, 0);
+        for (std::size_t i = columns * k / threadsCount; i < columns * (k + 1) / threadsCount; ++i)
+        {
+            // В первом столбце и в первой строке переходы не отмечаются (нет соседей слева и сверху)
+            if (i)
+            {
+                const Key *point = &keys[i * height], *left = point - height;
+                Key *res = flags.data();
+                for (std::size_t j = 1; j < height; ++j)
+                    res[j] = criterion(point[j], left[j]) | criterion(point[j], point[j - 1]);
+            }
+            visit(i, static_cast<const Key*>(flags.data()));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t k = 1; k < threadsCount; ++k)
+        threads.emplace_back(strip, k);
+    strip(0);
+    for (auto &t : threads)
+        t.join();
+}
+
+#endif // TRANSITIONSTENCIL_H
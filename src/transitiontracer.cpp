@@ -0,0 +1,99 @@
+#include <cmath>
+#include "transitiontracer.h"
+#include "phaseequations.h"
+
+
+namespace
+{
+    // Набор типов устойчивых фаз в точке
+    unsigned phaseSet(const DiagramPoint &point)
+    {
+        unsigned set = 0;
+        for (const PhaseInfo &item : point.phases)
+            set |= 1u << item.type;
+        return set;
+    }
+
+    // Признак перехода первого рода между соседними точками - тот же, что и TransitionStencil::FirstOrder
+    bool isCrossing(const DiagramPoint &first, const DiagramPoint &second)
+    {
+        unsigned set = phaseSet(first);
+        return (set & (set - 1)) != 0 && set == phaseSet(second) && first.stablest != second.stablest;
+    }
+}
+
+
+TransitionTracer::TransitionTracer(const Worker &diagram, double tolerance)
+    : CurveTracer(diagram, tolerance), probe(QSize(1, 1))
+{
+
+}
+
+
+void TransitionTracer::evaluate(const State &z, std::vector<double> &f, std::vector<double> &jacobian) const
+{
+    Coefficients c = coeffs;
+    c.a[0] = z[0];
+    c.b[0] = z[1];
+    std::fill(jacobian.begin(), jacobian.end(), 0.0);
+    PhaseDerivatives d[2];
+    for (unsigned p = 0; p < 2; ++p)
+    {
+        d[p] = phaseDerivatives(c.c, types[p], z[2 + 2 * p], z[3 + 2 * p]);
+        stateEquations(types[p], d[p], z[2 + 2 * p], z[3 + 2 * p], 2 + 2 * p, &f[2 * p], &jacobian[12 * p], 6);
+    }
+    potentialDifference(d[0], 2, d[1], 4, f[4], &jacobian[24]);
+}
+
+
+bool TransitionTracer::isValid(const State &z, TracedLine::End &reason)
+{
+    reason = TracedLine::StabilityLimit;
+    Coefficients c = coeffs;
+    c.a[0] = z[0];
+    c.b[0] = z[1];
+    double n[2][2], phi = 0.0;
+    for (unsigned p = 0; p < 2; ++p)
+    {
+        if (!orderParameter(types[p], z[2 + 2 * p], z[3 + 2 * p], signs[p], n[p]))
+            return false;
+        // Условия минимума
+        PhaseDerivatives d = orderDerivatives(c.c, n[p][0], n[p][1]);
+        if (d.xx <= 0 || d.xx * d.yy - d.xy * d.xy <= 0)
+            return false;
+        phi = d.v;
+    }
+    // Фазы должны быть различны
+    double distance = std::hypot(n[0][0] - n[1][0], n[0][1] - n[1][1]);
+    if (distance <= 1e-6 * std::max(std::hypot(n[0][0], n[0][1]), std::hypot(n[1][0], n[1][1])))
+        return false;
+    // Никакая другая фаза не должна быть устойчивее сосуществующих
+    reason = TracedLine::TriplePoint;
+    probe.setParameters(c, dX, dY);
+    std::vector<std::vector<DiagramPoint>> columns;
+    probe.calculateColumns(0, 1, columns);
+    for (const PhaseInfo &item : columns[0][0].phases)
+        if (item.phi < phi - 1e-7 * std::abs(phi) - 1e-14)
+            return false;
+    return true;
+}
+
+
+std::vector<TransitionLine> TransitionTracer::trace()
+{
+    std::vector<TransitionLine> res;
+    forEachEdge([this, &res](int i, int j, bool vertical, const DiagramPoint &first, const DiagramPoint &second)
+    {
+        if (!isCrossing(first, second) || isCovered(i, j, 1))
+            return;
+        TransitionLine line;
+        State z = initial(i, j, vertical, {first.phases[first.stablest], second.phases[second.stablest]});
+        line.types[0] = types[0];
+        line.types[1] = types[1];
+        if (!traceLine(vertical, z, line))
+            return;
+        cover(line.points, 1);
+        res.push_back(line);
+    });
+    return res;
+}
@@ -0,0 +1,44 @@
+#ifndef TRANSITIONTRACER_H
+#define TRANSITIONTRACER_H
+
+#include "curvetracer.h"
+
+
+// Уточнённая линия фазового перехода первого рода
+struct TransitionLine : TracedLine
+{
+    /* Типы сосуществующих фаз в начальной точке линии (фаза 4 может непрерывно переходить
+     * в повёрнутую на 60 градусов фазу 2 или 3, линия при этом продолжается)
+     */
+    unsigned types[2];
+};
+
+
+/* ---------------------------------------------------------------------------- *
+ * TransitionTracer - построение линий фазовых переходов первого рода с точностью *
+ * выше разрешения сетки                                                        *
+ * ---------------------------------------------------------------------------- *
+ *
+ * Линия перехода между фазами A и B - кривая Phi_A(Альфа1, Бета1) = Phi_B(Альфа1, Бета1) на плоскости диаграммы,
+ * где параметры порядка обеих фаз удовлетворяют уравнениям состояния (см. phaseequations.h).
+ * Начальные точки - середины отрезков между соседними точками сетки, на которых Worker отмечает переход
+ * (тот же набор устойчивых фаз, но другая наиболее устойчивая). Линия продолжается из них в обе стороны
+ * (см. CurveTracer). В каждой вершине проверяется, что фазы различны, устойчивы и никакая другая фаза
+ * не имеет меньшего потенциала (расчётом одной точки Worker::calculateColumns()), поэтому линия
+ * заканчивается в конце линии перехода или в тройной точке с погрешностью не больше допуска.
+ */
+
+class TransitionTracer : public CurveTracer
+{
+public:
+    explicit TransitionTracer(const Worker &diagram, double tolerance = 0.05);
+    // Строит все линии переходов первого рода диаграммы
+    std::vector<TransitionLine> trace();
+protected:
+    void evaluate(const State &z, std::vector<double> &f, std::vector<double> &jacobian) const override;
+    bool isValid(const State &z, TracedLine::End &reason) override;
+private:
+    Worker probe;   // Расчёт одной точки для проверки вершин
+};
+
+#endif // TRANSITIONTRACER_H
@@ -0,0 +1,120 @@
+#include <QtWidgets>
+#include "volumeviewer.h"
+
+
+// Обозначения коэффициентов Coefficients::c
+static const char *coefficientNames[9] {"\u03B11", "\u03B12", "\u03B13", "\u03B14", "\u03B21", "\u03B22",
+                                        "\u03B41", "\u03B42", "\u03B43"};
+
+
+VolumeViewer::VolumeViewer(const PhaseVolume &phaseVolume, const DiagramPainter &diagramPainter, QWidget *parent)
+    : QDialog(parent), volume(phaseVolume), painter(diagramPainter)
+{
+    // Сечения рисуются без линий переходов: признаки переходов определены только внутри слоёв X = const
+    painter.showLines = false;
+
+    cmbAxis = new QComboBox;
+    cmbAxis->addItem(QString("%1 = const").arg(coefficientNames[4]));
+    cmbAxis->addItem(QString("%1 = const").arg(coefficientNames[0]));
+    cmbAxis->addItem(QString("%1 = const").arg(coefficientNames[volume.getAxis()]));
+    cmbAxis->setCurrentIndex(2);
+
+    sldSlice = new QSlider(Qt::Horizontal);
+    lblValue = new QLabel;
+    lblImage = new QLabel;
+    lblImage->setFixedSize(viewSize, viewSize);
+
+    // Объёмные доли областей наиболее устойчивых фаз
+    DiagramStatistics st = volume.getStatistics();
+    QStringList fractions;
+    for (unsigned k = 0; k <= 4; ++k)
+        fractions << QString("%1: %2%").arg(k ? QString("фаза %1").arg(k) : QString("нет фаз"))
+                                        .arg(100 * st.fraction(st.stablest[k]), 0, 'f', 1);
+    QLabel *lblStatistics = new QLabel(QString("Доли объёма: %1\nСлоёв: %2, память: %3 МБ")
+                                       .arg(fractions.join(", ")).arg(volume.getDepth())
+                                       .arg(volume.memoryUsage() / 1048576.0, 0, 'f', 1));
+
+    QPushButton *btnBoundaries = new QPushButton("Сохранить &границы фаз (OBJ)...");
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+    buttons->addButton(btnBoundaries, QDialogButtonBox::ActionRole);
+    connect(buttons, SIGNAL(rejected()), this, SLOT(reject()));
+    connect(btnBoundaries, &QPushButton::clicked, [this]() {saveBoundaries();});
+
+    // При смене оси ползунок получает новый диапазон и устанавливается в середину
+    connect(cmbAxis, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), [this](int axis)
+    {
+        std::size_t sizes[3] {volume.getWidth(), volume.getHeight(), volume.getDepth()};
+        sldSlice->blockSignals(true);
+        sldSlice->setRange(0, static_cast<int>(sizes[axis]) - 1);
+        sldSlice->setValue(static_cast<int>(sizes[axis] / 2));
+        sldSlice->blockSignals(false);
+        showSlice();
+    });
+    connect(sldSlice, &QSlider::valueChanged, [this]() {showSlice();});
+
+    QFormLayout *lytForm = new QFormLayout;
+    lytForm->addRow("Сечение", cmbAxis);
+    lytForm->addRow("Положение", sldSlice);
+
+    QVBoxLayout *lytVBox = new QVBoxLayout;
+    lytVBox->addLayout(lytForm);
+    lytVBox->addWidget(lblValue);
+    lytVBox->addWidget(lblImage);
+    lytVBox->addWidget(lblStatistics);
+    lytVBox->addWidget(buttons);
+    setLayout(lytVBox);
+
+    setWindowTitle("Трёхмерная диаграмма");
+    sldSlice->setRange(0, static_cast<int>(volume.getDepth()) - 1);
+    sldSlice->setValue(static_cast<int>(volume.getDepth() / 2));
+    showSlice();
+}
+
+
+void VolumeViewer::showSlice()
+{
+    const std::size_t width = volume.getWidth(), height = volume.getHeight(), depth = volume.getDepth();
+    const std::size_t s = sldSlice->value();
+    const Coefficients c = volume.getCoefficients();
+    const QString x = coefficientNames[volume.getAxis()], alpha = coefficientNames[0], beta = coefficientNames[4];
+    QImage image;
+    QString text;
+    switch (cmbAxis->currentIndex())
+    {
+    case 0:
+        // Бета1 = const: по горизонтали X, по вертикали Альфа1
+        image = QImage(depth, height, QImage::Format_RGB32);
+        for (std::size_t k = 0; k < depth; ++k)
+            for (std::size_t j = 0; j < height; ++j)
+                image.setPixel(k, j, painter.color(volume.at(s, j, k)));
+        text = QString("%1 = %2 (по горизонтали %3, по вертикали %4)")
+                .arg(beta).arg(c.b[0] + s * volume.getStepX()).arg(x, alpha);
+        break;
+    case 1:
+        // Альфа1 = const (ползунок вправо - Альфа1 больше): по горизонтали Бета1, по вертикали X
+        image = QImage(width, depth, QImage::Format_RGB32);
+        for (std::size_t i = 0; i < width; ++i)
+            for (std::size_t k = 0; k < depth; ++k)
+                image.setPixel(i, depth - 1 - k, painter.color(volume.at(i, height - 1 - s, k)));
+        text = QString("%1 = %2 (по горизонтали %3, по вертикали %4)")
+                .arg(alpha).arg(c.a[0] + s * volume.getStepY()).arg(beta, x);
+        break;
+    default:
+        // X = const: обычная диаграмма
+        image = QImage(width, height, QImage::Format_RGB32);
+        for (std::size_t i = 0; i < width; ++i)
+            for (std::size_t j = 0; j < height; ++j)
+                image.setPixel(i, j, painter.color(volume.at(i, j, s)));
+        text = QString("%1 = %2 (по горизонтали %3, по вертикали %4)").arg(x).arg(volume.getValue(s)).arg(beta, alpha);
+    }
+    lblValue->setText(text);
+    lblImage->setPixmap(QPixmap::fromImage(image.scaled(viewSize, viewSize)));
+}
+
+
+void VolumeViewer::saveBoundaries()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Сохранение границ фаз", "", "*.obj");
+    if (!path.isEmpty() && !volume.exportBoundaries(QDir::toNativeSeparators(path).toLocal8Bit().constData()))
+        QMessageBox::warning(this, "Ошибка", "Не удалось записать файл.");
+}
@@ -0,0 +1,37 @@
+#ifndef VOLUMEVIEWER_H
+#define VOLUMEVIEWER_H
+
+#include <QDialog>
+#include "phasevolume.h"
+#include "diagrampainter.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QSlider;
+QT_END_NAMESPACE
+
+/* Просмотр трёхмерной диаграммы (PhaseVolume) по сечениям плоскостями Бета1 = const, Альфа1 = const или X = const.
+ * Сечение выбирается ползунком и рисуется в цветах главного окна (см. DiagramPainter::color()).
+ */
+
+class VolumeViewer : public QDialog
+{
+private:
+    // Размер изображения сечения на экране
+    static constexpr int viewSize = 500;
+    const PhaseVolume &volume;
+    DiagramPainter painter;
+    QComboBox *cmbAxis;         // Ось, перпендикулярная сечению
+    QSlider *sldSlice;          // Положение сечения
+    QLabel *lblValue;           // Значение коэффициента в сечении и направления осей изображения
+    QLabel *lblImage;           // Изображение сечения
+    // Рисует выбранное сечение
+    void showSlice();
+    // Сохраняет поверхности границ фаз в файл OBJ (см. PhaseVolume::exportBoundaries())
+    void saveBoundaries();
+public:
+    VolumeViewer(const PhaseVolume &phaseVolume, const DiagramPainter &diagramPainter, QWidget *parent = 0);
+};
+
+#endif // VOLUMEVIEWER_H
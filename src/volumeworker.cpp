@@ -0,0 +1,21 @@
+#include "volumeworker.h"
+
+
+VolumeWorker::VolumeWorker(QObject *parent)
+    : QObject(parent)
+{
+
+}
+
+
+void VolumeWorker::progress(int percent)
+{
+    emit processed(percent);
+}
+
+
+void VolumeWorker::calculate()
+{
+    PhaseVolume::calculate();
+    emit finished();
+}
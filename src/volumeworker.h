@@ -0,0 +1,27 @@
+#ifndef VOLUMEWORKER_H
+#define VOLUMEWORKER_H
+
+#include <QObject>
+#include "phasevolume.h"
+
+// Расчёт трёхмерной диаграммы (PhaseVolume) в отдельном потоке с сигналами о ходе расчёта
+
+class VolumeWorker : public QObject, public PhaseVolume
+{
+    Q_OBJECT
+protected:
+    // Посылает сигнал processed()
+    void progress(int percent) override;
+public:
+    VolumeWorker(QObject *parent = 0);
+public slots:
+    // Запуск расчёта; по завершении (в том числе после cancel()) посылается сигнал finished()
+    void calculate();
+signals:
+    // Сигнал о завершении работы
+    void finished();
+    // Сигнал о расчёте percent % слоёв
+    void processed(int percent);
+};
+
+#endif // VOLUMEWORKER_H
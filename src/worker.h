@@ -2,76 +2,42 @@
 #define WORKER_H
 
 #include <QObject>
-#include <vector>
-#include <twovarspolynomial.h>
+#include <QPoint>
+#include <QPointF>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include "diagramengine.h"
 
 
 /* -------------------------------------------------------------------  *
  * Worker - класс, выполняющий всю работу по расчёту фазовой диаграммы  *
  * -------------------------------------------------------------------  *
+ * Расчёт выполняет DiagramEngine, Worker добавляет интерфейс Qt        *
+ * (сигналы, координаты QPoint) и распределённый расчёт (TileFarm).     *
  *                                                                      */
 
 
-// Коэффициенты модельного потенциала
-struct Coefficients
-{
-    union
-    {
-        struct
-        {
-            double a[4];
-            double b[2];
-            double d[3];
-        };
-        double c[9];
-    };
-};
-
-// Информация о фазе
-struct PhaseInfo
-{
-    unsigned type;  // Тип (от 1 до 4)
-    double phi;     // Потенциал
-    double n[2];    // Параметр порядка
-};
-
-// Точка фазовой диаграммы
-struct DiagramPoint
-{
-    double x, y;                    // Коэффициенты Альфа1 (у) и Бета1 (х)
-    bool transition;                // Признак первородного фазового перехода
-    std::ptrdiff_t stablest;        // Индекс наиболее устойчивой фазы в векторе phases
-    std::vector<PhaseInfo> phases;  // Все устойчивые фазы
-};
-
-
-class Worker : public QObject
+class Worker : public QObject, public DiagramEngine
 {
     Q_OBJECT
 private:
-    static constexpr double eps = 1e-10;
-    // Шаг изменения Альфа1 (dY) и Бета1 (dX)
-    double dX, dY;
-    // Коэффициенты модельного потенциала
-    // (задаются перед началом расчётов и меняются в процессе)
-    Coefficients coeffs;
-    // Двумерный массив, хранящий информацию для каждой точки диаграммы
-    std::vector<std::vector<DiagramPoint>> data;
-    // Возвращает набор стабильных фаз для текущих значений коэффициентов потенциала
-    std::vector<PhaseInfo> getPhases();
-    // Определяет устойчивость фазы по компонентам её параметра порядка
-    bool isPhaseStableN(const std::array<double, 2> &N, double &phi);
-    // Определяет устойчивость фазы по инвариантам
-    bool isPhaseStableI(const std::array<double, 2> &I, double &phi);
+    /* Число вычислительных процессов распределённого расчёта (0 - расчёт в данном процессе)
+     * и команда их запуска (по умолчанию - данная программа с ключом --tile-worker)
+     */
+    unsigned processes;
+    QString tileProgram;
+    QStringList tileArguments;
+    // Распределённый расчёт диаграммы (см. TileFarm)
+    void calculateDistributed();
+protected:
+    // Расчёт в данном процессе или распределённый (если задано число процессов)
+    void computeColumns(double startX, double startY) override;
+    // Посылает сигнал processed()
+    void progress(int percent) override;
 public:
     Worker(QSize size, QObject *parent = 0);
     virtual ~Worker();
-    /* Установка параметров - коэффициентов потенциала Coefficients
-     * (для Coefficients.alpha[0] и Coefficients.beta[0] должны быть установлены стартовые значения)
-     * и величин "шагов" по Бета1 (stepX) и Альфа1 (stepY).
-     * Функция должна быть вызывана перед вызовом calculate().
-     */
-    void setParameters(const Coefficients coefficients, const double stepX, const double stepY);
     // Возвращает номер (1..4) наиболее устойчивой фазы в данной точке диаграммы или 0, если стабильных фаз нет
     unsigned getStablestPhaseType(const QPoint &point) const;
     // Возвращает потенциал наиболее устойчивой фазы
@@ -91,12 +57,24 @@ public:
     unsigned getIsosymmetricCount(const QPoint &point, unsigned phase) const;
     // Возвращает Бета1 (Х) и Альфа1 (Y) по целочисленным индексам массива данных
     QPointF getXY(const QPoint &point) const;
-    // Возвращает копию вектора коэффициентов
-    Coefficients getCoefficients() const;
+    // Возвращает шаги по Бета1 (X) и Альфа1 (Y)
+    QPointF getSteps() const;
+    // Возвращает размер диаграммы (число столбцов и строк)
+    QSize getSize() const;
     // Возвращает константную ссылку на информацию о фазах в точке point
     const DiagramPoint &getDiagramPoint(const QPoint &point) const;
-private slots:
-    // Запуск вычислений
+    using DiagramEngine::getDiagramPoint;
+    /* Распределённый расчёт в count вычислительных процессах на данной машине (0 - расчёт в данном процессе).
+     * Процессы запускаются командой program arguments (по умолчанию - данная программа с ключом --tile-worker);
+     * команда может запускать вычислительный процесс и на другом узле, если передаёт ему стандартные потоки.
+     */
+    void setProcessCount(unsigned count);
+    unsigned processCount() const;
+    void setTileWorkerCommand(const QString &program, const QStringList &arguments);
+public slots:
+    /* Запуск вычислений (может вызываться и напрямую, без потока с циклом обработки событий).
+     * По завершении (в том числе после cancel()) посылается сигнал finished().
+     */
     void calculate();
 signals:
     // Сигнал о завершении работы